@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+
+namespace llvm {
+class raw_ostream;
+}
+
+namespace numba {
+
+/// Collects wall time of compilation phases (pipeline stages, passes, python
+/// callbacks, LLVM optimization and codegen) from all threads participating
+/// in the compilation.
+///
+/// Profiler must be activated via `ActivationGuard` to receive events from
+/// `Scope` objects. Activation is per thread, so concurrent compilations
+/// record into their own profilers. Code, dispatching compilation work to
+/// other threads, must activate the profiler on these threads as well. Nested
+/// activation temporarily replaces the outer profiler.
+class CompileProfiler {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  struct Event {
+    std::string category;
+    std::string name;
+    Clock::time_point begin;
+    Clock::time_point end;
+    uint64_t threadId;
+  };
+
+  CompileProfiler();
+
+  /// Returns profiler, active on the current thread, or null.
+  static CompileProfiler *getActive();
+
+  /// Sets profiler, active on the current thread, returns the previous one.
+  static CompileProfiler *setActive(CompileProfiler *profiler);
+
+  void addEvent(llvm::StringRef category, llvm::StringRef name,
+                Clock::time_point begin, Clock::time_point end);
+
+  /// Write collected events in Chrome trace event format, suitable for
+  /// `chrome://tracing` or Perfetto.
+  void writeChromeTrace(llvm::raw_ostream &os) const;
+
+  /// Write Chrome trace to the file, returns false on failure.
+  bool writeChromeTrace(llvm::StringRef path) const;
+
+  class ActivationGuard {
+  public:
+    ActivationGuard(CompileProfiler *profiler);
+    ~ActivationGuard();
+
+    ActivationGuard(const ActivationGuard &) = delete;
+
+  private:
+    CompileProfiler *prev;
+  };
+
+  /// Records time between construction and destruction into the active
+  /// profiler. Does nothing if there is no active profiler.
+  class Scope {
+  public:
+    Scope(llvm::StringRef category, llvm::StringRef name);
+    ~Scope();
+
+    Scope(const Scope &) = delete;
+
+  private:
+    CompileProfiler *profiler;
+    llvm::StringRef category;
+    std::string name;
+    Clock::time_point begin;
+  };
+
+private:
+  mutable std::mutex mutex;
+  std::vector<Event> events;
+  Clock::time_point start;
+};
+} // namespace numba
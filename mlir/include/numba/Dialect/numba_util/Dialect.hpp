@@ -34,7 +34,15 @@ llvm::StringRef getJumpMarkersName();
 llvm::StringRef getMaxConcurrencyName();
 llvm::StringRef getForceInlineName();
 llvm::StringRef getOptLevelName();
+llvm::StringRef getParallelScheduleName();
+llvm::StringRef getParallelGrainSizeName();
+llvm::StringRef getParallelScanName();
+llvm::StringRef getPoolAllocName();
 llvm::StringRef getShapeRangeName();
+llvm::StringRef getTileSizesName();
+llvm::StringRef getL1CacheSizeName();
+llvm::StringRef getL2CacheSizeName();
+llvm::StringRef getVectorWidthName();
 } // namespace attributes
 } // namespace util
 } // namespace numba
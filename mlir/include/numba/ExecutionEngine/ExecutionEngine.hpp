@@ -4,13 +4,18 @@
 
 #pragma once
 
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ExecutionEngine/Orc/Core.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
 
 namespace mlir {
 class ModuleOp;
@@ -19,6 +24,7 @@ class ModuleOp;
 namespace llvm {
 template <typename T> class Expected;
 class JITEventListener;
+class ThreadPool;
 
 namespace orc {
 class LLJIT;
@@ -27,6 +33,8 @@ class MangleAndInterner;
 } // namespace llvm
 
 namespace numba {
+class CompileProfiler;
+
 struct ExecutionEngineOptions {
   /// `jitCodeGenOptLevel`, when provided, is used as the optimization level for
   /// target code generation.
@@ -37,6 +45,45 @@ struct ExecutionEngineOptions {
   /// be dumped to a file via the `dumpToObjectfile` method.
   bool enableObjectCache = false;
 
+  /// If `objectCacheDir` is not empty, compiled objects are persisted to this
+  /// directory and reused across processes. Entries are keyed by the content
+  /// hash of the LLVM module, target CPU/features and codegen opt level.
+  /// Modules referencing absolute addresses are never cached, as their objects
+  /// are only valid in the current process.
+  std::string objectCacheDir;
+
+  /// Maximum total size of the `objectCacheDir` entries in bytes, least
+  /// recently used entries are removed when it is exceeded. 0 means no limit.
+  uint64_t objectCacheMaxSize = 0;
+
+  /// Minimum interval between `objectCacheDir` pruning scans in seconds.
+  /// Pruning is checked after every stored object, but the scan timestamp is
+  /// kept in the cache directory, so the whole directory is only walked once
+  /// per interval across all processes sharing it.
+  uint64_t objectCachePruneInterval = 60;
+
+  /// Entries of `objectCacheDir` not accessed for this number of seconds are
+  /// removed on pruning. 0 means entries never expire.
+  uint64_t objectCacheExpiration = 0;
+
+  /// If `lazyCompilation` is set, functions are compiled on the first call
+  /// through lazy reexports instead of compiling the whole module on load.
+  bool lazyCompilation = false;
+
+  /// If `tieredCompilation` is set, modules are first compiled with cheap
+  /// pipeline and without IR verification. Exported functions are called
+  /// through indirection stubs and, when any of them is called
+  /// `tierUpThreshold` times, the module is recompiled with
+  /// `jitCodeGenOptLevel` on the background thread and stubs are switched to
+  /// the optimized code. Ignored if `lazyCompilation` is set.
+  bool tieredCompilation = false;
+  unsigned tierUpThreshold = 100;
+
+  /// If `numCompileThreads` is non-zero, compilation is dispatched to the pool
+  /// of this size. Transformer and printer callbacks can be invoked from the
+  /// pool threads in this case.
+  unsigned numCompileThreads = 0;
+
   /// If enable `enableGDBNotificationListener` is set, the JIT compiler will
   /// notify the llvm's global GDB notification listener.
   bool enableGDBNotificationListener = true;
@@ -64,16 +111,34 @@ struct ExecutionEngineOptions {
 
 class ExecutionEngine {
   class SimpleObjectCache;
+  struct TieredModule;
 
 public:
+  class PersistentObjectCache;
   using ModuleHandle = void *;
 
+  struct Statistics {
+    /// Persistent object cache lookups.
+    uint64_t objectCacheHits = 0;
+    uint64_t objectCacheMisses = 0;
+
+    /// Modules, which weren't looked up in persistent cache, because they
+    /// reference absolute addresses.
+    uint64_t objectCacheSkipped = 0;
+
+    /// Modules, switched to the optimized tier.
+    uint64_t tierUps = 0;
+  };
+
   ExecutionEngine(ExecutionEngineOptions options);
   ~ExecutionEngine();
 
   /// Compiles given module, adds it to execution engine and run its contructors
-  /// if any.
-  llvm::Expected<ModuleHandle> loadModule(mlir::ModuleOp m);
+  /// if any. If `profiler` is provided, module translation and LLVM compilation
+  /// are recorded into it, including compilation on the JIT compile threads.
+  llvm::Expected<ModuleHandle>
+  loadModule(mlir::ModuleOp m,
+             std::shared_ptr<CompileProfiler> profiler = nullptr);
 
   /// Runs module desctructors and removes it from execution engine.
   void releaseModule(ModuleHandle handle);
@@ -86,7 +151,20 @@ public:
   /// Dump object code to output file `filename`.
   void dumpToObjectFile(llvm::StringRef filename);
 
+  /// Returns engine counters, collected since its creation.
+  Statistics getStatistics() const;
+
 private:
+  /// Called from the tier-0 code when module becomes hot.
+  static void tierUpCallback(void *state);
+
+  /// Recompiles module with full optimizations and switches stubs to the
+  /// new code. Runs on the `tierUpPool`.
+  llvm::Error tierUp(TieredModule &mod);
+
+  /// Returns profiler, registered for the module by `loadModule`.
+  std::shared_ptr<CompileProfiler> getProfiler(llvm::StringRef moduleId);
+
   /// Ordering of llvmContext and jit is important for destruction purposes: the
   /// jit must be destroyed before the context.
   llvm::LLVMContext llvmContext;
@@ -97,6 +175,9 @@ private:
   /// Underlying cache.
   std::unique_ptr<SimpleObjectCache> cache;
 
+  /// Underlying on-disk cache.
+  std::unique_ptr<PersistentObjectCache> persistentCache;
+
   /// GDB notification listener.
   llvm::JITEventListener *gdbListener;
 
@@ -110,7 +191,33 @@ private:
   /// JIT-compilation and can be used, e.g., for reporting or optimization.
   std::function<llvm::Error(llvm::Module &)> transformer;
 
+  /// Compile module functions lazily on first call.
+  bool lazyCompilation = false;
+
   /// Id for unique module name generation.
   int uniqueNameCounter = 0;
+
+  /// Profilers of the loaded modules, keyed by module name. Modules can be
+  /// compiled from the JIT threads and after `loadModule` returned, so
+  /// profilers are shared.
+  std::mutex profilersMutex;
+  llvm::StringMap<std::shared_ptr<CompileProfiler>> profilers;
+
+  /// Calls count before module recompilation, 0 if tiered compilation is
+  /// disabled.
+  unsigned tierUpThreshold = 0;
+
+  /// JIT for the optimized tier, uses separate session so its compile
+  /// pipeline can differ from the main one.
+  std::unique_ptr<llvm::orc::LLJIT> optJit;
+
+  /// Tiered compilation state, keyed by module handle.
+  std::mutex tieredMutex;
+  std::unordered_map<void *, std::unique_ptr<TieredModule>> tieredModules;
+  std::atomic<uint64_t> tierUpsCount{0};
+
+  /// Background recompilation thread. Must be destroyed before anything its
+  /// tasks reference.
+  std::unique_ptr<llvm::ThreadPool> tierUpPool;
 };
 } // namespace numba
@@ -14,6 +14,12 @@ struct LogicalResult;
 
 namespace numba {
 mlir::LogicalResult naivelyFuseParallelOps(mlir::Region &region);
+
+/// Fuse parallel loops, writing temporary buffers, into their only consumer
+/// loop by recomputing values at each consumer read, removing producer loops.
+/// Unlike `naivelyFuseParallelOps`, loops can have different iteration spaces
+/// and consumer can read any elements of the buffer.
+mlir::LogicalResult fuseProducerConsumerParallelOps(mlir::Region &region);
 mlir::LogicalResult
 prepareForFusion(mlir::Region &region,
                  llvm::function_ref<bool(mlir::Operation &)> needPrepare);
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 
@@ -21,4 +22,19 @@ std::unique_ptr<mlir::Pass> createMemoryOptPass();
 /// Normalizes memref types shape and layout to most static one across func
 /// call boudaries.
 std::unique_ptr<mlir::Pass> createNormalizeMemrefArgsPass();
+
+/// Hoists temporary allocations with loop-invariant sizes out of sequential
+/// loops and reuses memory of released temporaries for the subsequent ones in
+/// the same block. Expects explicit deallocations.
+std::unique_ptr<mlir::Pass> createBufferReusePass();
+
+/// Replaces non-escaping temporary allocations, which size is static or
+/// bounded by integer range analysis and doesn't exceed the threshold, with
+/// stack allocations at the start of function or parallel loop body.
+std::unique_ptr<mlir::Pass>
+createPromoteToStackPass(int64_t maxAllocSizeInBytes = 1024);
+
+/// Marks allocations, which are only accessed inside the function and
+/// deallocated in the same block, to use runtime pool allocator.
+std::unique_ptr<mlir::Pass> createMarkPoolAllocsPass();
 } // namespace numba
@@ -7,11 +7,21 @@
 namespace mlir {
 class ArrayAttr;
 class ModuleOp;
+class Operation;
 class StringAttr;
 } // namespace mlir
 
 namespace numba {
+/// Returns sorted list of markers, set on the module or any of its top-level
+/// ops.
 mlir::ArrayAttr getPipelineJumpMarkers(mlir::ModuleOp module);
-void addPipelineJumpMarker(mlir::ModuleOp module, mlir::StringAttr name);
+
+/// Adds marker to the top-level op (direct child of the module) containing
+/// `op`, or to the module itself if `op` is the module. Markers are never
+/// stored on the parent module of `op`, so this is safe to call from nested
+/// passes running concurrently.
+void addPipelineJumpMarker(mlir::Operation *op, mlir::StringAttr name);
+
+/// Removes marker from the module and all its top-level ops.
 void removePipelineJumpMarker(mlir::ModuleOp module, mlir::StringAttr name);
 } // namespace numba
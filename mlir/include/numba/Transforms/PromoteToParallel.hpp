@@ -7,17 +7,28 @@
 #include <memory>
 
 namespace mlir {
+class Operation;
 class Pass;
 class RewritePatternSet;
+namespace scf {
+class ForOp;
+}
 } // namespace mlir
 
 namespace numba {
 void populatePromoteWhilePatterns(mlir::RewritePatternSet &patterns);
 void populatePromoteToParallelPatterns(mlir::RewritePatternSet &patterns);
 
+/// Checks if `scf.for` computes inclusive scan over its single loop-carried
+/// value, i.e. each iteration combines it with independent element and only
+/// stores the result to the non-aliased memory, indexed by induction var.
+/// Returns combining op or null if loop cannot be executed as parallel scan.
+mlir::Operation *getParallelScanCombineOp(mlir::scf::ForOp loop);
+
 /// This pass tries to promote `scf.while` ops to `scf.for`.
 std::unique_ptr<mlir::Pass> createPromoteWhilePass();
 
-/// This pass tries to promote `scf.for` ops to `scf.parallel`.
+/// This pass tries to promote `scf.for` ops to `scf.parallel` and marks scan
+/// loops with `numba.parallel_scan` attribute.
 std::unique_ptr<mlir::Pass> createPromoteToParallelPass();
 } // namespace numba
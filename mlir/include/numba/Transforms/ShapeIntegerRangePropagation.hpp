@@ -7,10 +7,15 @@
 #include <memory>
 
 namespace mlir {
+class DataFlowSolver;
 class Pass;
-}
+} // namespace mlir
 
 namespace numba {
+/// Load integer range analysis, which is aware of shaped values dimensions
+/// ranges, and its dependencies into the solver.
+void loadShapeIntegerRangeAnalysis(mlir::DataFlowSolver &solver);
+
 /// Propagate integer range info through the IR and optimize ops based on this
 /// info.
 std::unique_ptr<mlir::Pass> createShapeIntegerRangePropagationPass();
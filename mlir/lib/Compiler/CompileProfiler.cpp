@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "numba/Compiler/CompileProfiler.hpp"
+
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/ToolOutputFile.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <utility>
+
+static thread_local numba::CompileProfiler *activeProfiler = nullptr;
+
+numba::CompileProfiler::CompileProfiler() : start(Clock::now()) {}
+
+numba::CompileProfiler *numba::CompileProfiler::getActive() {
+  return activeProfiler;
+}
+
+numba::CompileProfiler *
+numba::CompileProfiler::setActive(CompileProfiler *profiler) {
+  return std::exchange(activeProfiler, profiler);
+}
+
+void numba::CompileProfiler::addEvent(llvm::StringRef category,
+                                      llvm::StringRef name,
+                                      Clock::time_point begin,
+                                      Clock::time_point end) {
+  Event event{category.str(), name.str(), begin, end, llvm::get_threadid()};
+  std::lock_guard<std::mutex> lock(mutex);
+  events.emplace_back(std::move(event));
+}
+
+void numba::CompileProfiler::writeChromeTrace(llvm::raw_ostream &os) const {
+  auto toUs = [](Clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count();
+  };
+  auto pid = static_cast<int64_t>(llvm::sys::Process::getProcessId());
+
+  std::lock_guard<std::mutex> lock(mutex);
+  llvm::json::OStream json(os);
+  json.object([&]() {
+    json.attributeArray("traceEvents", [&]() {
+      for (auto &event : events) {
+        json.object([&]() {
+          json.attribute("name", event.name);
+          json.attribute("cat", event.category);
+          json.attribute("ph", "X");
+          json.attribute("ts", toUs(event.begin - start));
+          json.attribute("dur", toUs(event.end - event.begin));
+          json.attribute("pid", pid);
+          json.attribute("tid", static_cast<int64_t>(event.threadId));
+        });
+      }
+    });
+    json.attribute("displayTimeUnit", "ms");
+  });
+}
+
+bool numba::CompileProfiler::writeChromeTrace(llvm::StringRef path) const {
+  std::error_code ec;
+  llvm::ToolOutputFile out(path, ec, llvm::sys::fs::OF_Text);
+  if (ec)
+    return false;
+
+  writeChromeTrace(out.os());
+  out.keep();
+  return !out.os().has_error();
+}
+
+numba::CompileProfiler::ActivationGuard::ActivationGuard(
+    CompileProfiler *profiler)
+    : prev(setActive(profiler)) {}
+
+numba::CompileProfiler::ActivationGuard::~ActivationGuard() {
+  setActive(prev);
+}
+
+numba::CompileProfiler::Scope::Scope(llvm::StringRef category,
+                                     llvm::StringRef name)
+    : profiler(getActive()), category(category) {
+  if (!profiler)
+    return;
+
+  this->name = name.str();
+  begin = Clock::now();
+}
+
+numba::CompileProfiler::Scope::~Scope() {
+  if (profiler)
+    profiler->addEvent(category, name, begin, Clock::now());
+}
@@ -4,6 +4,7 @@
 
 #include "numba/Compiler/Compiler.hpp"
 
+#include "numba/Compiler/CompileProfiler.hpp"
 #include "numba/Compiler/PipelineRegistry.hpp"
 #include "numba/Transforms/PipelineUtils.hpp"
 #include "numba/Utils.hpp"
@@ -12,23 +13,87 @@
 #include <mlir/IR/Diagnostics.h>
 #include <mlir/IR/Verifier.h>
 #include <mlir/Pass/Pass.h>
+#include <mlir/Pass/PassInstrumentation.h>
 #include <mlir/Pass/PassManager.h>
 
+#include <llvm/ADT/ScopeExit.h>
 #include <llvm/Support/raw_ostream.h>
 
 #include <unordered_map>
 
 namespace {
+static llvm::StringRef getPassName(mlir::Pass *pass) {
+  auto name = pass->getName();
+  name.consume_front("`anonymous-namespace'::");
+  name.consume_front("{anonymous}::");
+  name.consume_front("(anonymous namespace)::");
+  return name;
+}
+
+/// Reports pass timings to the profiler of the current compilation. Passes can
+/// be run concurrently on nested ops from the context thread pool, so profiler
+/// is also activated on the pass thread for the duration of the pass, and
+/// per-thread stack of start times is kept.
+struct ProfilerInstrumentation : public mlir::PassInstrumentation {
+  /// `profiler` points to the slot, set by the compiler for the duration of
+  /// the compilation.
+  ProfilerInstrumentation(numba::CompileProfiler *const *profiler)
+      : profiler(profiler) {}
+
+  void runBeforePass(mlir::Pass *pass, mlir::Operation *) override {
+    auto current = *profiler;
+    if (!current)
+      return;
+
+    auto prev = numba::CompileProfiler::setActive(current);
+    getStack().push_back({numba::CompileProfiler::Clock::now(), prev});
+  }
+
+  void runAfterPass(mlir::Pass *pass, mlir::Operation *) override {
+    record(pass);
+  }
+
+  void runAfterPassFailed(mlir::Pass *pass, mlir::Operation *) override {
+    record(pass);
+  }
+
+private:
+  numba::CompileProfiler *const *profiler;
+
+  struct StackEntry {
+    numba::CompileProfiler::Clock::time_point begin;
+    numba::CompileProfiler *prev;
+  };
+  using Stack = llvm::SmallVector<StackEntry>;
+
+  static Stack &getStack() {
+    static thread_local Stack stack;
+    return stack;
+  }
+
+  void record(mlir::Pass *pass) {
+    auto current = *profiler;
+    if (!current)
+      return;
+
+    auto &stack = getStack();
+    assert(!stack.empty());
+    auto entry = stack.pop_back_val();
+    current->addEvent("pass", getPassName(pass), entry.begin,
+                      numba::CompileProfiler::Clock::now());
+    numba::CompileProfiler::setActive(entry.prev);
+  }
+};
+
 struct PassManagerStage {
   template <typename F>
   PassManagerStage(mlir::MLIRContext &ctx,
                    const numba::CompilerContext::Settings &settings,
-                   F &&initFunc)
-      : pm(&ctx) {
-    // TODO: investigate
-    ctx.disableMultithreading();
-
+                   numba::CompileProfiler *const *profiler,
+                   llvm::StringRef name, F &&initFunc)
+      : pm(&ctx), name(name.str()) {
     pm.enableVerifier(settings.verify);
+    pm.addInstrumentation(std::make_unique<ProfilerInstrumentation>(profiler));
 
     if (settings.passStatistics)
       pm.enableStatistics();
@@ -36,24 +101,20 @@ struct PassManagerStage {
     if (settings.passTimings)
       pm.enableTiming();
 
-    if (settings.irDumpStderr) {
-      ctx.disableMultithreading();
+    // Module scope IR printing requires multithreading to be disabled, caller
+    // must wrap construction and run into `SerialScope`.
+    if (settings.irDumpStderr)
       pm.enableIRPrinting();
-    }
+
     if (settings.irPrinting) {
       struct Checker {
         llvm::SmallVector<std::string, 1> names;
 
         bool operator()(mlir::Pass *pass, mlir::Operation *) const {
-          auto name = pass->getName();
-          name.consume_front("`anonymous-namespace'::");
-          name.consume_front("{anonymous}::");
-          name.consume_front("(anonymous namespace)::");
-          return llvm::is_contained(names, name);
+          return llvm::is_contained(names, getPassName(pass));
         }
       };
 
-      ctx.disableMultithreading();
       pm.enableIRPrinting(Checker{settings.irPrinting->printBefore},
                           Checker{settings.irPrinting->printAfter},
                           /*printModuleScope*/ true,
@@ -93,10 +154,14 @@ struct PassManagerStage {
 
   PassManagerStage *getNextStage() const { return nextStage; }
 
-  mlir::LogicalResult run(mlir::ModuleOp op) { return pm.run(op); }
+  mlir::LogicalResult run(mlir::ModuleOp op) {
+    numba::CompileProfiler::Scope scope("stage", name);
+    return pm.run(op);
+  }
 
 private:
   mlir::PassManager pm;
+  std::string name;
   llvm::SmallVector<std::pair<mlir::StringAttr, PassManagerStage *>, 1> jumps;
   PassManagerStage *nextStage = nullptr;
 };
@@ -104,7 +169,8 @@ private:
 struct PassManagerSchedule {
   PassManagerSchedule(mlir::MLIRContext &ctx,
                       const numba::CompilerContext::Settings &settings,
-                      const numba::PipelineRegistry &registry) {
+                      const numba::PipelineRegistry &registry,
+                      numba::CompileProfiler *const *profiler) {
     auto func = [&](auto sink) {
       struct StageDesc {
         llvm::StringRef name;
@@ -124,7 +190,8 @@ struct PassManagerSchedule {
             (stagesMap.empty() ? nullptr : stagesTemp.back().stage.get());
         stagesTemp.push_back(
             {name, jumps,
-             std::make_unique<PassManagerStage>(ctx, settings, pmInitFunc)});
+             std::make_unique<PassManagerStage>(ctx, settings, profiler,
+                                                name, pmInitFunc)});
         assert(stagesMap.count(name.data()) == 0);
         stagesMap.insert({name.data(), stagesTemp.back().stage.get()});
         if (nullptr != prevStage)
@@ -177,6 +244,40 @@ private:
   std::unique_ptr<std::unique_ptr<PassManagerStage>[]> stages;
 };
 
+/// Disables context multithreading for the lifetime of the scope. Context is
+/// shared between compilations, so the previous state is restored on exit.
+struct SerialScope {
+  SerialScope(mlir::MLIRContext &ctx, bool serial)
+      : ctx(serial && ctx.isMultithreadingEnabled() ? &ctx : nullptr) {
+    if (this->ctx)
+      this->ctx->disableMultithreading();
+  }
+
+  ~SerialScope() {
+    if (ctx)
+      ctx->disableMultithreading(false);
+  }
+
+  SerialScope(const SerialScope &) = delete;
+  SerialScope &operator=(const SerialScope &) = delete;
+
+private:
+  mlir::MLIRContext *ctx;
+};
+
+static bool isSerial(const numba::CompilerContext::Settings &settings) {
+  return settings.irDumpStderr || settings.irPrinting;
+}
+
+static PassManagerSchedule
+createSchedule(mlir::MLIRContext &ctx,
+               const numba::CompilerContext::Settings &settings,
+               const numba::PipelineRegistry &registry,
+               numba::CompileProfiler *const *profiler) {
+  SerialScope scope(ctx, isSerial(settings));
+  return PassManagerSchedule(ctx, settings, registry, profiler);
+}
+
 static void printDiag(llvm::raw_ostream &os, const mlir::Diagnostic &diag) {
   os << diag;
   for (auto &note : diag.getNotes())
@@ -190,8 +291,9 @@ public:
   CompilerContextImpl(mlir::MLIRContext &ctx,
                       const CompilerContext::Settings &settings,
                       const numba::PipelineRegistry &registry)
-      : schedule(ctx, settings, registry), verify(settings.verify),
-        dumpDiag(settings.diagDumpStderr) {}
+      : schedule(createSchedule(ctx, settings, registry, &profiler)),
+        verify(settings.verify), dumpDiag(settings.diagDumpStderr),
+        serial(isSerial(settings)) {}
 
   void run(mlir::ModuleOp module) {
     std::string err;
@@ -211,6 +313,13 @@ public:
       return err;
     };
 
+    SerialScope scope(*module.getContext(), serial);
+
+    // Compiler can be reused by subsequent compilations, pass instrumentation
+    // must only see the profiler of the current one.
+    profiler = numba::CompileProfiler::getActive();
+    auto resetProfiler = llvm::make_scope_exit([&]() { profiler = nullptr; });
+
     numba::scopedDiagHandler(*module.getContext(), diagHandler, [&]() {
       if (verify && mlir::failed(mlir::verify(module)))
         numba::reportError(llvm::Twine("MLIR broken module\n") + getErr());
@@ -221,9 +330,12 @@ public:
   }
 
 private:
+  /// Declared before `schedule`, which references it.
+  numba::CompileProfiler *profiler = nullptr;
   PassManagerSchedule schedule;
   bool verify = false;
   bool dumpDiag = false;
+  bool serial = false;
 };
 
 numba::CompilerContext::CompilerContext(mlir::MLIRContext &ctx,
@@ -60,10 +60,42 @@ llvm::StringRef numba::util::attributes::getOptLevelName() {
   return "numba.opt_level";
 }
 
+llvm::StringRef numba::util::attributes::getParallelScheduleName() {
+  return "numba.parallel_schedule";
+}
+
+llvm::StringRef numba::util::attributes::getParallelGrainSizeName() {
+  return "numba.parallel_grain_size";
+}
+
+llvm::StringRef numba::util::attributes::getParallelScanName() {
+  return "numba.parallel_scan";
+}
+
+llvm::StringRef numba::util::attributes::getPoolAllocName() {
+  return "numba.pool_alloc";
+}
+
 llvm::StringRef numba::util::attributes::getShapeRangeName() {
   return "numba.shape_range";
 }
 
+llvm::StringRef numba::util::attributes::getTileSizesName() {
+  return "numba.tile_sizes";
+}
+
+llvm::StringRef numba::util::attributes::getL1CacheSizeName() {
+  return "numba.l1_cache_size";
+}
+
+llvm::StringRef numba::util::attributes::getL2CacheSizeName() {
+  return "numba.l2_cache_size";
+}
+
+llvm::StringRef numba::util::attributes::getVectorWidthName() {
+  return "numba.vector_width";
+}
+
 namespace numba {
 namespace util {
 
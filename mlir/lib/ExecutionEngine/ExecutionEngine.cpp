@@ -4,19 +4,35 @@
 
 #include "numba/ExecutionEngine/ExecutionEngine.hpp"
 
+#include "numba/Compiler/CompileProfiler.hpp"
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/JITEventListener.h>
 #include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
 #include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
 #include <llvm/ExecutionEngine/Orc/IRCompileLayer.h>
 #include <llvm/ExecutionEngine/Orc/IRTransformLayer.h>
 #include <llvm/ExecutionEngine/Orc/LLJIT.h>
 #include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
 #include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/InstIterator.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/MDBuilder.h>
 #include <llvm/IR/Module.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/Support/CachePruning.h>
+#include <llvm/Support/FileSystem.h>
 #include <llvm/Support/Host.h>
 #include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/Process.h>
+#include <llvm/Support/SHA256.h>
+#include <llvm/Support/ThreadPool.h>
 #include <llvm/Support/ToolOutputFile.h>
 #include <llvm/Target/TargetMachine.h>
 
@@ -29,6 +45,11 @@
 #include <llvm/Passes/PassBuilder.h>
 #include <llvm/Passes/StandardInstrumentations.h>
 
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+
 #define DEBUG_TYPE "numba-execution-engine"
 
 static llvm::OptimizationLevel mapToLevel(llvm::CodeGenOptLevel level) {
@@ -75,7 +96,8 @@ getPipelineTuningOptions(llvm::CodeGenOptLevel optLevelVal) {
   return pto;
 }
 
-static void runOptimizationPasses(llvm::Module &M, llvm::TargetMachine &TM) {
+static void runOptimizationPasses(llvm::Module &M, llvm::TargetMachine &TM,
+                                  bool verify) {
   llvm::CodeGenOptLevel optLevelVal = TM.getOptLevel();
 
   llvm::LoopAnalysisManager lam;
@@ -88,7 +110,7 @@ static void runOptimizationPasses(llvm::Module &M, llvm::TargetMachine &TM) {
   ppo.Indent = false;
   ppo.SkipAnalyses = false;
   llvm::StandardInstrumentations si(M.getContext(), /*debugLogging*/ false,
-                                    /*verifyEach*/ true, ppo);
+                                    /*verifyEach*/ verify, ppo);
 
   si.registerCallbacks(pic, &mam);
 
@@ -96,7 +118,7 @@ static void runOptimizationPasses(llvm::Module &M, llvm::TargetMachine &TM) {
 
   llvm::ModulePassManager mpm;
 
-  if (/*verify*/ true) {
+  if (verify) {
     pb.registerPipelineStartEPCallback(
         [&](llvm::ModulePassManager &mpm, llvm::OptimizationLevel level) {
           mpm.addPass(createModuleToFunctionPassAdaptor(llvm::VerifierPass()));
@@ -126,6 +148,7 @@ class numba::ExecutionEngine::SimpleObjectCache : public llvm::ObjectCache {
 public:
   void notifyObjectCompiled(const llvm::Module *m,
                             llvm::MemoryBufferRef objBuffer) override {
+    std::lock_guard<std::mutex> lock(mutex);
     cachedObjects[m->getModuleIdentifier()] =
         llvm::MemoryBuffer::getMemBufferCopy(objBuffer.getBuffer(),
                                              objBuffer.getBufferIdentifier());
@@ -133,6 +156,7 @@ public:
 
   std::unique_ptr<llvm::MemoryBuffer>
   getObject(const llvm::Module *m) override {
+    std::lock_guard<std::mutex> lock(mutex);
     auto i = cachedObjects.find(m->getModuleIdentifier());
     if (i == cachedObjects.end()) {
       LLVM_DEBUG(llvm::dbgs() << "No object for " << m->getModuleIdentifier()
@@ -162,9 +186,174 @@ public:
   }
 
 private:
+  std::mutex mutex;
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cachedObjects;
 };
 
+/// Object cache persisted to disk, so compiled modules survive process
+/// restarts. Unlike `SimpleObjectCache` it is keyed by module content instead
+/// of module identifier, as identifiers are only unique within the process.
+class numba::ExecutionEngine::PersistentObjectCache {
+public:
+  PersistentObjectCache(std::string dir, uint64_t maxSize,
+                        uint64_t pruneInterval, uint64_t expiration)
+      : cacheDir(std::move(dir)), maxSize(maxSize),
+        pruneInterval(pruneInterval), expiration(expiration) {}
+
+  /// Returns true if module references absolute addresses (e.g. pointers to
+  /// the objects of the current process), such modules cannot be reused by
+  /// other processes and must not be cached.
+  static bool hasAbsoluteAddresses(const llvm::Module &m) {
+    llvm::SmallPtrSet<const llvm::Constant *, 16> visited;
+    llvm::SmallVector<const llvm::Constant *> worklist;
+    auto push = [&](const llvm::Value *val) {
+      auto c = llvm::dyn_cast<llvm::Constant>(val);
+      if (c && !llvm::isa<llvm::GlobalValue>(c) && visited.insert(c).second)
+        worklist.emplace_back(c);
+    };
+
+    for (auto &global : m.globals())
+      if (global.hasInitializer())
+        push(global.getInitializer());
+
+    for (auto &func : m.functions()) {
+      for (auto &inst : llvm::instructions(func)) {
+        if (llvm::isa<llvm::IntToPtrInst>(inst) &&
+            llvm::isa<llvm::ConstantInt>(inst.getOperand(0)))
+          return true;
+
+        for (auto &op : inst.operands())
+          push(op);
+      }
+    }
+
+    while (!worklist.empty()) {
+      auto c = worklist.pop_back_val();
+      if (auto expr = llvm::dyn_cast<llvm::ConstantExpr>(c))
+        if (expr->getOpcode() == llvm::Instruction::IntToPtr &&
+            llvm::isa<llvm::ConstantInt>(expr->getOperand(0)))
+          return true;
+
+      for (auto &op : c->operands())
+        push(op);
+    }
+    return false;
+  }
+
+  /// Computes cache key for the module before any optimizations are applied.
+  std::string getKey(const llvm::Module &m, const llvm::TargetMachine &tm) {
+    llvm::SmallVector<char, 0> bitcode;
+    llvm::raw_svector_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(m, os);
+
+    llvm::SHA256 hasher;
+    auto update = [&](llvm::StringRef str) {
+      // Prefix with size, so adjacent fields cannot alias each other.
+      hasher.update(llvm::utostr(str.size()) + ":");
+      hasher.update(str);
+    };
+    update(LLVM_VERSION_STRING);
+    update(tm.getTargetTriple().str());
+    update(tm.getTargetCPU());
+    update(tm.getTargetFeatureString());
+    update(llvm::itostr(static_cast<int>(tm.getOptLevel())));
+    update(llvm::StringRef(bitcode.data(), bitcode.size()));
+    return llvm::toHex(hasher.final(), /*LowerCase*/ true);
+  }
+
+  std::unique_ptr<llvm::MemoryBuffer> getObject(llvm::StringRef key) {
+    auto path = getPath(key);
+    int fd;
+    if (llvm::sys::fs::openFileForRead(path, fd)) {
+      LLVM_DEBUG(llvm::dbgs() << "No object for " << key
+                              << " in persistent cache. Compiling.\n");
+      ++misses;
+      return nullptr;
+    }
+
+    auto buffer = llvm::MemoryBuffer::getOpenFile(
+        llvm::sys::fs::convertFDToNativeFile(fd), path, /*FileSize*/ -1,
+        /*RequiresNullTerminator*/ false);
+
+    // Access time is not reliably updated by the filesystems, touch the entry
+    // explicitly so pruning removes least recently used entries first.
+    if (buffer)
+      (void)llvm::sys::fs::setLastAccessAndModificationTime(
+          fd, std::chrono::system_clock::now());
+
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    if (!buffer) {
+      ++misses;
+      return nullptr;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "Object for " << key
+                            << " loaded from persistent cache.\n");
+    ++hits;
+    return std::move(*buffer);
+  }
+
+  void notifyObjectCompiled(llvm::StringRef key,
+                            llvm::MemoryBufferRef objBuffer) {
+    if (auto ec = llvm::sys::fs::create_directories(cacheDir)) {
+      LLVM_DEBUG(llvm::dbgs() << "Failed to create cache dir " << cacheDir
+                              << ": " << ec.message() << "\n");
+      return;
+    }
+
+    // Write to the temp file and rename it, so concurrent processes never
+    // observe partially written entries.
+    auto err = llvm::writeToOutput(getPath(key), [&](llvm::raw_ostream &os) {
+      os << objBuffer.getBuffer();
+      return llvm::Error::success();
+    });
+    if (err) {
+      LLVM_DEBUG(llvm::dbgs() << "Failed to store object for " << key << ": "
+                              << llvm::toString(std::move(err)) << "\n");
+      llvm::consumeError(std::move(err));
+      return;
+    }
+
+    if (maxSize != 0 || expiration != 0) {
+      // All limits are set explicitly instead of relying on LLVM defaults.
+      // Zero interval would walk the whole directory after every store.
+      llvm::CachePruningPolicy policy;
+      policy.Interval =
+          std::chrono::seconds(std::max<uint64_t>(pruneInterval, 1));
+      policy.Expiration = std::chrono::seconds(expiration);
+      policy.MaxSizeBytes = maxSize;
+      policy.MaxSizePercentageOfAvailableSpace = 0;
+      policy.MaxSizeFiles = 0;
+      llvm::pruneCache(cacheDir, policy);
+    }
+  }
+
+  void skip() { ++skipped; }
+
+  void getStatistics(numba::ExecutionEngine::Statistics &stats) const {
+    stats.objectCacheHits = hits;
+    stats.objectCacheMisses = misses;
+    stats.objectCacheSkipped = skipped;
+  }
+
+private:
+  std::string cacheDir;
+  uint64_t maxSize;
+  uint64_t pruneInterval;
+  uint64_t expiration;
+
+  std::atomic<uint64_t> hits = 0;
+  std::atomic<uint64_t> misses = 0;
+  std::atomic<uint64_t> skipped = 0;
+
+  std::string getPath(llvm::StringRef key) const {
+    // `pruneCache` only considers files with this prefix.
+    llvm::SmallString<128> path(cacheDir);
+    llvm::sys::path::append(path, "llvmcache-" + key + ".o");
+    return std::string(path);
+  }
+};
+
 /// Wrap a string into an llvm::StringError.
 static llvm::Error makeStringError(const llvm::Twine &message) {
   return llvm::make_error<llvm::StringError>(message.str(),
@@ -188,56 +377,275 @@ static void setupModule(llvm::Module &M, llvm::TargetMachine &TM) {
 }
 
 namespace {
-class CustomCompiler : public llvm::orc::SimpleCompiler {
+class CustomCompiler : public llvm::orc::IRCompileLayer::IRCompiler {
 public:
   using Transformer = std::function<llvm::Error(llvm::Module &)>;
   using AsmPrinter = std::function<void(llvm::StringRef)>;
 
+  using PersistentCache = numba::ExecutionEngine::PersistentObjectCache;
+  using ProfilerLookup =
+      std::function<std::shared_ptr<numba::CompileProfiler>(llvm::StringRef)>;
+
+  /// If `TM` is null, compiler is used concurrently and will create new
+  /// target machine from `JTMB` for each compilation.
   CustomCompiler(Transformer t, AsmPrinter a,
-                 std::unique_ptr<llvm::TargetMachine> TM,
-                 llvm::ObjectCache *ObjCache = nullptr)
-      : SimpleCompiler(*TM, ObjCache), TM(std::move(TM)),
-        transformer(std::move(t)), printer(std::move(a)) {}
+                 llvm::orc::JITTargetMachineBuilder JTMB,
+                 std::unique_ptr<llvm::TargetMachine> TM, bool verify,
+                 llvm::ObjectCache *ObjCache = nullptr,
+                 PersistentCache *persistentCache = nullptr,
+                 ProfilerLookup profilerLookup = nullptr)
+      : IRCompiler(llvm::orc::irManglingOptionsFromTargetOptions(
+            JTMB.getOptions())),
+        JTMB(std::move(JTMB)), TM(std::move(TM)), objCache(ObjCache),
+        transformer(std::move(t)), printer(std::move(a)),
+        persistentCache(persistentCache),
+        profilerLookup(std::move(profilerLookup)), verify(verify) {}
 
   llvm::Expected<CompileResult> operator()(llvm::Module &M) override {
+    auto TM = getTargetMachine();
+    if (!TM)
+      return TM.takeError();
+
+    return compile(M, **TM);
+  }
+
+private:
+  llvm::orc::JITTargetMachineBuilder JTMB;
+  std::shared_ptr<llvm::TargetMachine> TM;
+  llvm::ObjectCache *objCache;
+  Transformer transformer;
+  AsmPrinter printer;
+  PersistentCache *persistentCache;
+  ProfilerLookup profilerLookup;
+  bool verify;
+
+  llvm::Expected<std::shared_ptr<llvm::TargetMachine>> getTargetMachine() {
+    if (TM)
+      return TM;
+
+    auto newTM = JTMB.createTargetMachine();
+    if (!newTM)
+      return newTM.takeError();
+
+    return std::shared_ptr<llvm::TargetMachine>(std::move(*newTM));
+  }
+
+  llvm::Expected<CompileResult> compile(llvm::Module &M,
+                                        llvm::TargetMachine &TM) {
+    // Module can be compiled on the JIT compile thread, activate profiler of
+    // the compilation it belongs to.
+    auto profiler =
+        profilerLookup ? profilerLookup(M.getModuleIdentifier()) : nullptr;
+    numba::CompileProfiler::ActivationGuard profilerGuard(
+        profiler ? profiler.get() : numba::CompileProfiler::getActive());
+
+    // Printers expect to see the module contents, bypass the persistent cache
+    // if any of them is set.
+    std::string cacheKey;
+    if (persistentCache && !transformer && !printer) {
+      if (PersistentCache::hasAbsoluteAddresses(M)) {
+        persistentCache->skip();
+      } else {
+        cacheKey = persistentCache->getKey(M, TM);
+        if (auto obj = persistentCache->getObject(cacheKey))
+          return std::move(obj);
+      }
+    }
+
     if (transformer) {
       auto err = transformer(M);
       if (err)
         return err;
     }
 
-    setupModule(M, *TM);
-    runOptimizationPasses(M, *TM);
+    setupModule(M, TM);
+    {
+      numba::CompileProfiler::Scope scope("llvm", "optimize");
+      runOptimizationPasses(M, TM, verify);
+    }
 
     if (printer) {
       llvm::SmallVector<char, 0> buffer;
       llvm::raw_svector_ostream os(buffer);
 
       llvm::legacy::PassManager PM;
-      if (TM->addPassesToEmitFile(PM, os, nullptr,
-                                  llvm::CodeGenFileType::AssemblyFile))
+      if (TM.addPassesToEmitFile(PM, os, nullptr,
+                                 llvm::CodeGenFileType::AssemblyFile))
         return makeStringError("Target does not support Asm emission");
 
       PM.run(M);
       printer(llvm::StringRef(buffer.data(), buffer.size()));
     }
 
-    return llvm::orc::SimpleCompiler::operator()(M);
-  }
+    numba::CompileProfiler::Scope scope("llvm", "codegen");
+    auto res = llvm::orc::SimpleCompiler(TM, objCache)(M);
+    if (res && !cacheKey.empty())
+      persistentCache->notifyObjectCompiled(cacheKey,
+                                            (*res)->getMemBufferRef());
 
-private:
-  std::shared_ptr<llvm::TargetMachine> TM;
-  Transformer transformer;
-  AsmPrinter printer;
+    return res;
+  }
 };
 } // namespace
 
+// Tiered compilation.
+//
+// Tier-0 module is compiled with cheap pipeline and each exported function is
+// replaced with the stub, which counts calls and jumps to the implementation
+// through the pointer global. When any counter reaches the threshold, the
+// original module bitcode is recompiled with full optimizations on the
+// background thread and stub pointers are atomically switched to the new code.
+// Mutable globals are shared between tiers, optimized tier references tier-0
+// copies by absolute address.
+
+static const constexpr llvm::StringLiteral kTierUpFuncName("__numba_tier_up");
+static const constexpr llvm::StringLiteral
+    kTierUpStateName("__numba_tier_state");
+
+struct numba::ExecutionEngine::TieredModule {
+  ExecutionEngine *engine = nullptr;
+  llvm::orc::JITDylib *dylib = nullptr;
+
+  /// Module bitcode before stubs insertion.
+  std::string bitcode;
+
+  /// Mutable globals, which must be shared with the optimized tier.
+  llvm::SmallVector<std::string, 0> sharedGlobals;
+
+  /// Functions, replaced by stubs.
+  llvm::SmallVector<std::string, 0> funcs;
+
+  std::mutex mutex;
+  bool started = false;
+  std::shared_future<void> done;
+
+  /// Dylib with optimized code, if tier up succeeded.
+  llvm::orc::JITDylib *optDylib = nullptr;
+};
+
+static std::string getStubPtrName(llvm::StringRef funcName) {
+  return (funcName + ".tier.ptr").str();
+}
+
+/// Makes mutable globals visible to the JIT lookup, so the optimized tier can
+/// reuse them. Returns false if module cannot be tiered.
+static bool collectSharedGlobals(llvm::Module &m,
+                                 llvm::SmallVectorImpl<std::string> &names) {
+  for (auto &global : m.globals()) {
+    if (global.isDeclaration() || global.isConstant() ||
+        global.hasAppendingLinkage())
+      continue;
+
+    if (global.isThreadLocal())
+      return false;
+
+    if (!global.hasName())
+      global.setName("numba_tier_global");
+
+    if (global.hasLocalLinkage())
+      global.setLinkage(llvm::GlobalValue::ExternalLinkage);
+
+    names.emplace_back(global.getName());
+  }
+  return true;
+}
+
+/// Replaces exported functions with counting stubs, calling implementation
+/// through the pointer global.
+static void insertTierStubs(llvm::Module &m, unsigned threshold,
+                            llvm::SmallVectorImpl<std::string> &names) {
+  llvm::SmallVector<llvm::Function *> funcs;
+  for (auto &func : m.functions())
+    if (!func.isDeclaration() && !func.hasLocalLinkage() && !func.isVarArg())
+      funcs.emplace_back(&func);
+
+  if (funcs.empty())
+    return;
+
+  auto &ctx = m.getContext();
+  auto ptrType = llvm::PointerType::get(ctx, 0);
+  auto i64 = llvm::Type::getInt64Ty(ctx);
+  auto ptrAlign = llvm::Align(alignof(void *));
+  auto tierUpFunc = m.getOrInsertFunction(
+      kTierUpFuncName,
+      llvm::FunctionType::get(llvm::Type::getVoidTy(ctx), ptrType, false));
+
+  // Filled by the engine after the module is loaded.
+  auto state = new llvm::GlobalVariable(
+      m, ptrType, /*isConstant*/ false, llvm::GlobalValue::ExternalLinkage,
+      llvm::ConstantPointerNull::get(ptrType), kTierUpStateName);
+
+  for (auto func : funcs) {
+    auto name = func->getName().str();
+    auto stub = llvm::Function::Create(func->getFunctionType(),
+                                       func->getLinkage(),
+                                       func->getAddressSpace(), "", &m);
+    stub->copyAttributesFrom(func);
+    func->replaceAllUsesWith(stub);
+    stub->takeName(func);
+    func->setName(name + ".tier0");
+    func->setLinkage(llvm::GlobalValue::InternalLinkage);
+
+    auto counter = new llvm::GlobalVariable(
+        m, i64, /*isConstant*/ false, llvm::GlobalValue::InternalLinkage,
+        llvm::ConstantInt::get(i64, 0), name + ".tier.count");
+    auto implPtr = new llvm::GlobalVariable(
+        m, ptrType, /*isConstant*/ false, llvm::GlobalValue::ExternalLinkage,
+        func, getStubPtrName(name));
+    implPtr->setAlignment(ptrAlign);
+
+    auto entryBlock = llvm::BasicBlock::Create(ctx, "entry", stub);
+    auto tierUpBlock = llvm::BasicBlock::Create(ctx, "tier_up", stub);
+    auto callBlock = llvm::BasicBlock::Create(ctx, "call", stub);
+
+    llvm::IRBuilder<> builder(entryBlock);
+    auto count = builder.CreateAtomicRMW(
+        llvm::AtomicRMWInst::Add, counter, builder.getInt64(1),
+        llvm::MaybeAlign(8), llvm::AtomicOrdering::Monotonic);
+    auto isHot = builder.CreateICmpEQ(count, builder.getInt64(threshold));
+    builder.CreateCondBr(isHot, tierUpBlock, callBlock,
+                         llvm::MDBuilder(ctx).createBranchWeights(1, 1 << 20));
+
+    builder.SetInsertPoint(tierUpBlock);
+    builder.CreateCall(tierUpFunc,
+                       builder.CreateAlignedLoad(ptrType, state, ptrAlign));
+    builder.CreateBr(callBlock);
+
+    builder.SetInsertPoint(callBlock);
+    auto impl = builder.CreateAlignedLoad(ptrType, implPtr, ptrAlign);
+    impl->setAtomic(llvm::AtomicOrdering::Acquire);
+
+    llvm::SmallVector<llvm::Value *> args;
+    for (auto &arg : stub->args())
+      args.emplace_back(&arg);
+
+    auto call = builder.CreateCall(func->getFunctionType(), impl, args);
+    call->setCallingConv(func->getCallingConv());
+    call->setAttributes(func->getAttributes().removeFnAttributes(ctx));
+    call->setTailCall();
+    if (call->getType()->isVoidTy()) {
+      builder.CreateRetVoid();
+    } else {
+      builder.CreateRet(call);
+    }
+
+    names.emplace_back(std::move(name));
+  }
+}
+
 numba::ExecutionEngine::ExecutionEngine(ExecutionEngineOptions options)
     : cache(options.enableObjectCache ? new SimpleObjectCache() : nullptr),
+      persistentCache(options.objectCacheDir.empty()
+                          ? nullptr
+                          : new PersistentObjectCache(
+                                options.objectCacheDir,
+                                options.objectCacheMaxSize,
+                                options.objectCachePruneInterval,
+                                options.objectCacheExpiration)),
       gdbListener(options.enableGDBNotificationListener
                       ? llvm::JITEventListener::createGDBRegistrationListener()
                       : nullptr),
-      perfListener(nullptr) {
+      perfListener(nullptr), lazyCompilation(options.lazyCompilation) {
   if (options.enablePerfNotificationListener) {
     if (auto *listener = llvm::JITEventListener::createPerfJITEventListener())
       perfListener = listener;
@@ -274,43 +682,113 @@ numba::ExecutionEngine::ExecutionEngine(ExecutionEngineOptions options)
 
   // Callback to inspect the cache and recompile on demand. This follows Lang's
   // LLJITWithObjectCache example.
-  auto compileFunctionCreator =
-      [this, jitCodeGenOptLevel = options.jitCodeGenOptLevel,
-       transformer = options.lateTransformer,
-       asmPrinter = options.asmPrinter](llvm::orc::JITTargetMachineBuilder jtmb)
-      -> llvm::Expected<
-          std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
-    if (jitCodeGenOptLevel)
-      jtmb.setCodeGenOptLevel(*jitCodeGenOptLevel);
-    auto tm = jtmb.createTargetMachine();
-    if (!tm)
-      return tm.takeError();
-    return std::make_unique<CustomCompiler>(transformer, asmPrinter,
-                                            std::move(*tm), cache.get());
-  };
+  auto makeCompileFunctionCreator =
+      [this, transformer = options.lateTransformer,
+       asmPrinter = options.asmPrinter](
+          std::optional<llvm::CodeGenOptLevel> jitCodeGenOptLevel, bool verify,
+          bool concurrent, llvm::ObjectCache *objCache,
+          PersistentObjectCache *persistentCache) {
+        return [this, transformer, asmPrinter, jitCodeGenOptLevel, verify,
+                concurrent, objCache,
+                persistentCache](llvm::orc::JITTargetMachineBuilder jtmb)
+                   -> llvm::Expected<
+                       std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+          if (jitCodeGenOptLevel)
+            jtmb.setCodeGenOptLevel(*jitCodeGenOptLevel);
+
+          // TargetMachine is not thread-safe, concurrent compiler will create
+          // one per compilation.
+          std::unique_ptr<llvm::TargetMachine> tm;
+          if (!concurrent) {
+            auto res = jtmb.createTargetMachine();
+            if (!res)
+              return res.takeError();
+
+            tm = std::move(*res);
+          }
+          return std::make_unique<CustomCompiler>(
+              transformer, asmPrinter, std::move(jtmb), std::move(tm), verify,
+              objCache, persistentCache,
+              [this](llvm::StringRef id) { return getProfiler(id); });
+        };
+      };
 
   auto tmBuilder =
       llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost());
 
   // Create the LLJIT by calling the LLJITBuilder with 2 callbacks.
-  jit = cantFail(llvm::orc::LLJITBuilder()
-                     .setCompileFunctionCreator(compileFunctionCreator)
-                     .setObjectLinkingLayerCreator(objectLinkingLayerCreator)
-                     .setJITTargetMachineBuilder(tmBuilder)
-                     .create());
+  auto createJit = [&](auto &&builder, auto &&compileFunctionCreator,
+                       unsigned numCompileThreads)
+      -> std::unique_ptr<llvm::orc::LLJIT> {
+    return cantFail(builder.setCompileFunctionCreator(compileFunctionCreator)
+                        .setObjectLinkingLayerCreator(objectLinkingLayerCreator)
+                        .setJITTargetMachineBuilder(tmBuilder)
+                        .setNumCompileThreads(numCompileThreads)
+                        .create());
+  };
+  bool concurrent = (options.numCompileThreads > 0);
+  if (lazyCompilation) {
+    jit = createJit(llvm::orc::LLLazyJITBuilder(),
+                    makeCompileFunctionCreator(options.jitCodeGenOptLevel,
+                                               /*verify*/ true, concurrent,
+                                               cache.get(),
+                                               persistentCache.get()),
+                    options.numCompileThreads);
+  } else if (options.tieredCompilation) {
+    // Tier-0 code is only executed until optimized version is ready, don't
+    // spend time on optimizations and verification.
+    jit = createJit(llvm::orc::LLJITBuilder(),
+                    makeCompileFunctionCreator(llvm::CodeGenOptLevel::Less,
+                                               /*verify*/ false, concurrent,
+                                               cache.get(),
+                                               persistentCache.get()),
+                    options.numCompileThreads);
+
+    // Optimized tier is only compiled from the single background thread.
+    // It references tier-0 globals by absolute addresses, so its objects are
+    // never reusable and are not stored in the persistent cache.
+    optJit = createJit(llvm::orc::LLJITBuilder(),
+                       makeCompileFunctionCreator(options.jitCodeGenOptLevel,
+                                                  /*verify*/ true,
+                                                  /*concurrent*/ false,
+                                                  /*objCache*/ nullptr,
+                                                  /*persistentCache*/ nullptr),
+                       /*numCompileThreads*/ 0);
+    tierUpThreshold = std::max(options.tierUpThreshold, 1u);
+    tierUpPool =
+        std::make_unique<llvm::ThreadPool>(llvm::hardware_concurrency(1));
+  } else {
+    jit = createJit(llvm::orc::LLJITBuilder(),
+                    makeCompileFunctionCreator(options.jitCodeGenOptLevel,
+                                               /*verify*/ true, concurrent,
+                                               cache.get(),
+                                               persistentCache.get()),
+                    options.numCompileThreads);
+  }
 
   symbolMap = std::move(options.symbolMap);
   transformer = std::move(options.transformer);
 }
 
-numba::ExecutionEngine::~ExecutionEngine() {}
+numba::ExecutionEngine::~ExecutionEngine() {
+  // Background tasks reference modules and JITs.
+  if (tierUpPool)
+    tierUpPool->wait();
+}
 
 llvm::Expected<numba::ExecutionEngine::ModuleHandle>
-numba::ExecutionEngine::loadModule(mlir::ModuleOp m) {
+numba::ExecutionEngine::loadModule(mlir::ModuleOp m,
+                                   std::shared_ptr<CompileProfiler> profiler) {
   assert(m);
+  numba::CompileProfiler::ActivationGuard profilerGuard(
+      profiler ? profiler.get() : numba::CompileProfiler::getActive());
 
   std::unique_ptr<llvm::LLVMContext> ctx(new llvm::LLVMContext);
-  auto llvmModule = mlir::translateModuleToLLVMIR(m, *ctx);
+  std::unique_ptr<llvm::Module> llvmModule;
+  {
+    numba::CompileProfiler::Scope scope("llvm", "translate");
+    llvmModule = mlir::translateModuleToLLVMIR(m, *ctx);
+  }
   if (!llvmModule)
     return makeStringError("could not convert to LLVM IR");
 
@@ -320,6 +798,22 @@ numba::ExecutionEngine::loadModule(mlir::ModuleOp m) {
     cantFail(tsm.withModuleDo(
         [this](llvm::Module &module) { return transformer(module); }));
 
+  std::unique_ptr<TieredModule> tiered;
+  if (tierUpThreshold > 0) {
+    tiered = std::make_unique<TieredModule>();
+    tsm.withModuleDo([&](llvm::Module &module) {
+      if (!collectSharedGlobals(module, tiered->sharedGlobals))
+        return;
+
+      llvm::raw_string_ostream os(tiered->bitcode);
+      llvm::WriteBitcodeToFile(module, os);
+      os.flush();
+      insertTierStubs(module, tierUpThreshold, tiered->funcs);
+    });
+    if (tiered->funcs.empty())
+      tiered.reset();
+  }
+
   llvm::orc::JITDylib *dylib;
   while (true) {
     auto uniqueName =
@@ -336,6 +830,16 @@ numba::ExecutionEngine::loadModule(mlir::ModuleOp m) {
   }
   assert(dylib);
 
+  // Module identifier is used to find the profiler, when module (or its
+  // partitions in lazy mode) is compiled.
+  tsm.withModuleDo([&](llvm::Module &module) {
+    module.setModuleIdentifier(dylib->getName());
+  });
+  if (profiler) {
+    std::lock_guard<std::mutex> lock(profilersMutex);
+    profilers[dylib->getName()] = std::move(profiler);
+  }
+
   auto dataLayout = jit->getDataLayout();
   dylib->addGenerator(
       cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
@@ -346,7 +850,40 @@ numba::ExecutionEngine::loadModule(mlir::ModuleOp m) {
         dylib->define(absoluteSymbols(symbolMap(llvm::orc::MangleAndInterner(
             dylib->getExecutionSession(), jit->getDataLayout())))));
 
-  llvm::cantFail(jit->addIRModule(*dylib, std::move(tsm)));
+  if (tiered) {
+    llvm::orc::MangleAndInterner mangle(dylib->getExecutionSession(),
+                                        dataLayout);
+    llvm::orc::ExecutorSymbolDef tierUpPtr{
+        llvm::orc::ExecutorAddr::fromPtr(&tierUpCallback),
+        llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+    cantFail(dylib->define(
+        absoluteSymbols({{mangle(kTierUpFuncName), tierUpPtr}})));
+  }
+
+  if (lazyCompilation) {
+    // Functions will be compiled on the first call through the lazy
+    // reexports, only module initializers are materialized here.
+    auto &lazyJit = static_cast<llvm::orc::LLLazyJIT &>(*jit);
+    llvm::cantFail(lazyJit.addLazyIRModule(*dylib, std::move(tsm)));
+  } else {
+    llvm::cantFail(jit->addIRModule(*dylib, std::move(tsm)));
+  }
+
+  if (tiered) {
+    // State must be set before any stub can be called, including from module
+    // initializers.
+    auto state = jit->lookup(*dylib, kTierUpStateName);
+    if (!state)
+      return state.takeError();
+
+    tiered->engine = this;
+    tiered->dylib = dylib;
+    *state->toPtr<TieredModule **>() = tiered.get();
+
+    std::lock_guard<std::mutex> lock(tieredMutex);
+    tieredModules.emplace(dylib, std::move(tiered));
+  }
+
   llvm::cantFail(jit->initialize(*dylib));
   return static_cast<ModuleHandle>(dylib);
 }
@@ -354,10 +891,144 @@ numba::ExecutionEngine::loadModule(mlir::ModuleOp m) {
 void numba::ExecutionEngine::releaseModule(ModuleHandle handle) {
   assert(handle);
   auto dylib = static_cast<llvm::orc::JITDylib *>(handle);
+
+  std::unique_ptr<TieredModule> tiered;
+  {
+    std::lock_guard<std::mutex> lock(tieredMutex);
+    auto it = tieredModules.find(handle);
+    if (it != tieredModules.end()) {
+      tiered = std::move(it->second);
+      tieredModules.erase(it);
+    }
+  }
+  if (tiered) {
+    std::shared_future<void> done;
+    {
+      // Block any further tier up requests.
+      std::lock_guard<std::mutex> lock(tiered->mutex);
+      tiered->started = true;
+      done = tiered->done;
+    }
+    if (done.valid())
+      done.wait();
+
+    if (tiered->optDylib)
+      tiered->optDylib->Release();
+  }
+
   llvm::cantFail(jit->deinitialize(*dylib));
+  {
+    std::lock_guard<std::mutex> lock(profilersMutex);
+    profilers.erase(dylib->getName());
+  }
   dylib->Release();
 }
 
+std::shared_ptr<numba::CompileProfiler>
+numba::ExecutionEngine::getProfiler(llvm::StringRef moduleId) {
+  // Partitions, created by the lazy JIT, use original identifier as prefix.
+  auto name = moduleId.split('.').first;
+  std::lock_guard<std::mutex> lock(profilersMutex);
+  auto it = profilers.find(name);
+  if (it == profilers.end())
+    return nullptr;
+
+  return it->second;
+}
+
+void numba::ExecutionEngine::tierUpCallback(void *state) {
+  if (!state)
+    return;
+
+  auto &mod = *static_cast<TieredModule *>(state);
+  std::lock_guard<std::mutex> lock(mod.mutex);
+  if (mod.started)
+    return;
+
+  mod.started = true;
+  auto engine = mod.engine;
+  mod.done = engine->tierUpPool->async([engine, &mod]() {
+    // Module just stays on tier 0 in case of failure.
+    llvm::handleAllErrors(
+        engine->tierUp(mod), [](llvm::ErrorInfoBase &err) {
+          LLVM_DEBUG(llvm::dbgs()
+                     << "Tier up failed: " << err.message() << "\n");
+        });
+  });
+}
+
+llvm::Error numba::ExecutionEngine::tierUp(TieredModule &mod) {
+  auto ctx = std::make_unique<llvm::LLVMContext>();
+  auto buffer = llvm::MemoryBuffer::getMemBuffer(
+      mod.bitcode, mod.dylib->getName(), /*RequiresNullTerminator*/ false);
+  auto parsed = llvm::parseBitcodeFile(*buffer, *ctx);
+  if (!parsed)
+    return parsed.takeError();
+
+  auto &module = **parsed;
+
+  // Initializers were already executed by tier 0.
+  for (auto name : {"llvm.global_ctors", "llvm.global_dtors"})
+    if (auto global = module.getNamedGlobal(name))
+      global->eraseFromParent();
+
+  // Reference tier-0 globals by absolute address, as they can be outside of
+  // the range of the pc-relative relocations.
+  auto i64 = llvm::Type::getInt64Ty(*ctx);
+  for (auto &name : mod.sharedGlobals) {
+    auto global = module.getNamedGlobal(name);
+    if (!global)
+      continue;
+
+    auto addr = jit->lookup(*mod.dylib, name);
+    if (!addr)
+      return addr.takeError();
+
+    auto ptr = llvm::ConstantExpr::getIntToPtr(
+        llvm::ConstantInt::get(i64, addr->getValue()), global->getType());
+    global->replaceAllUsesWith(ptr);
+    global->eraseFromParent();
+  }
+
+  auto res = optJit->createJITDylib((mod.dylib->getName() + ".opt").str());
+  if (!res)
+    return res.takeError();
+
+  auto &dylib = *res;
+  mod.optDylib = &dylib;
+
+  auto dataLayout = optJit->getDataLayout();
+  dylib.addGenerator(
+      cantFail(llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+          dataLayout.getGlobalPrefix())));
+
+  if (symbolMap) {
+    llvm::orc::MangleAndInterner mangle(dylib.getExecutionSession(),
+                                        dataLayout);
+    cantFail(dylib.define(absoluteSymbols(symbolMap(mangle))));
+  }
+
+  if (auto err = optJit->addIRModule(
+          dylib, llvm::orc::ThreadSafeModule(std::move(*parsed),
+                                             std::move(ctx))))
+    return err;
+
+  for (auto &name : mod.funcs) {
+    auto impl = optJit->lookup(dylib, name);
+    if (!impl)
+      return impl.takeError();
+
+    auto implPtr = jit->lookup(*mod.dylib, getStubPtrName(name));
+    if (!implPtr)
+      return implPtr.takeError();
+
+    implPtr->toPtr<std::atomic<void *> *>()->store(impl->toPtr<void *>(),
+                                                   std::memory_order_release);
+  }
+  ++tierUpsCount;
+  return llvm::Error::success();
+}
+
 llvm::Expected<void *>
 numba::ExecutionEngine::lookup(numba::ExecutionEngine::ModuleHandle handle,
                                llvm::StringRef name) const {
@@ -393,3 +1064,13 @@ void numba::ExecutionEngine::dumpToObjectFile(llvm::StringRef filename) {
   }
   cache->dumpToObjectFile(filename);
 }
+
+numba::ExecutionEngine::Statistics
+numba::ExecutionEngine::getStatistics() const {
+  Statistics stats;
+  if (persistentCache)
+    persistentCache->getStatistics(stats);
+
+  stats.tierUps = tierUpsCount.load();
+  return stats;
+}
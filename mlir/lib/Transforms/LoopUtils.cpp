@@ -10,6 +10,7 @@
 
 #include <mlir/Analysis/AliasAnalysis.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Arith/Utils/Utils.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/IR/Dominance.h>
@@ -217,8 +218,261 @@ bool hasNoEffect(mlir::scf::ParallelOp currentPloop, mlir::Operation *op) {
 
   return hasNoEffect(op);
 }
+
+// Max number of ops, which can be recomputed in consumer per single fused
+// producer.
+static constexpr unsigned kMaxRecomputedOps = 64;
+
+/// Checks if `val` is equal to `dim` dimension size of the `alloc`.
+static bool isAllocDim(Value val, memref::AllocOp alloc, unsigned dim) {
+  auto type = alloc.getType();
+  if (!type.isDynamicDim(dim))
+    return getConstantIntValue(val) == type.getDimSize(dim);
+
+  if (val == alloc.getDynamicSizes()[type.getDynamicDimIndex(dim)])
+    return true;
+
+  auto dimOp = val.getDefiningOp<memref::DimOp>();
+  return dimOp && dimOp.getSource() == alloc.getResult() &&
+         getConstantIntValue(dimOp.getIndex()) == static_cast<int64_t>(dim);
+}
+
+/// Returns store op if `ploop` is a simple producer: it writes every element
+/// of the temporary buffer exactly once, at the loop induction variables, and
+/// the stored value can be recomputed at arbitrary index, i.e. body only
+/// contains pure ops and loads.
+static memref::StoreOp getProducerStore(scf::ParallelOp ploop) {
+  if (ploop->getNumResults() != 0)
+    return nullptr;
+
+  memref::StoreOp store;
+  for (auto &op : ploop.getBody()->without_terminator()) {
+    if (op.getNumRegions() != 0)
+      return nullptr;
+
+    if (auto storeOp = dyn_cast<memref::StoreOp>(op)) {
+      if (store)
+        return nullptr;
+
+      store = storeOp;
+      continue;
+    }
+
+    if (!isa<memref::LoadOp>(op) && !isPure(&op))
+      return nullptr;
+  }
+
+  if (!store || !llvm::equal(store.getIndices(), ploop.getInductionVars()))
+    return nullptr;
+
+  auto alloc = store.getMemRef().getDefiningOp<memref::AllocOp>();
+  if (!alloc)
+    return nullptr;
+
+  for (auto &&[i, lb, ub, step] :
+       llvm::enumerate(ploop.getLowerBound(), ploop.getUpperBound(),
+                       ploop.getStep())) {
+    if (getConstantIntValue(lb) != 0 || getConstantIntValue(step) != 1 ||
+        !isAllocDim(ub, alloc, static_cast<unsigned>(i)))
+      return nullptr;
+  }
+  return store;
+}
+
+/// Collect loads from `memref` and its views. Returns false if there are
+/// any other uses except dims and producer `store`.
+static bool collectTmpLoads(Value memref, Operation *store,
+                            SmallVectorImpl<memref::LoadOp> &loads) {
+  for (auto user : memref.getUsers()) {
+    if (user == store || isa<memref::DimOp>(user))
+      continue;
+
+    if (auto load = dyn_cast<memref::LoadOp>(user)) {
+      loads.emplace_back(load);
+      continue;
+    }
+
+    if (auto subview = dyn_cast<memref::SubViewOp>(user)) {
+      if (subview.getSourceType().getRank() != subview.getType().getRank() ||
+          !collectTmpLoads(subview.getResult(), store, loads))
+        return false;
+
+      continue;
+    }
+
+    if (auto cast = dyn_cast<memref::CastOp>(user)) {
+      if (!collectTmpLoads(cast.getResult(), store, loads))
+        return false;
+
+      continue;
+    }
+
+    return false;
+  }
+  return true;
+}
+
+/// Checks `op` doesn't write to any of `memrefs`.
+static bool
+hasNoWritesTo(Operation *op, ArrayRef<Value> memrefs,
+              llvm::function_ref<mlir::AliasAnalysis &()> getAnalysis) {
+  auto walkResult = op->walk([&](Operation *nested) {
+    if (nested->hasTrait<OpTrait::HasRecursiveMemoryEffects>())
+      return WalkResult::advance();
+
+    auto iface = dyn_cast<MemoryEffectOpInterface>(nested);
+    if (!iface)
+      return WalkResult::interrupt();
+
+    SmallVector<MemoryEffects::EffectInstance> effects;
+    iface.getEffects(effects);
+    for (auto &effect : effects) {
+      if (!isa<MemoryEffects::Write>(effect.getEffect()))
+        continue;
+
+      auto value = effect.getValue();
+      if (!value)
+        return WalkResult::interrupt();
+
+      auto &analysis = getAnalysis();
+      for (auto memref : memrefs)
+        if (!analysis.alias(value, memref).isNo())
+          return WalkResult::interrupt();
+    }
+    return WalkResult::advance();
+  });
+  return !walkResult.wasInterrupted();
+}
+
+/// Translate indices of the `memref` view into the indices of `src`.
+static SmallVector<Value> getSourceIndices(OpBuilder &b, Location loc,
+                                           Value memref, ValueRange indices,
+                                           Value src) {
+  SmallVector<Value> ret(indices.begin(), indices.end());
+  while (memref != src) {
+    auto subview = memref.getDefiningOp<memref::SubViewOp>();
+    if (!subview) {
+      memref = memref.getDefiningOp<memref::CastOp>().getSource();
+      continue;
+    }
+
+    auto offsets = subview.getMixedOffsets();
+    auto strides = subview.getMixedStrides();
+    for (auto &&[i, idx] : llvm::enumerate(ret)) {
+      auto offset = getValueOrCreateConstantIndexOp(b, loc, offsets[i]);
+      auto stride = getValueOrCreateConstantIndexOp(b, loc, strides[i]);
+      Value val = b.createOrFold<arith::MulIOp>(loc, idx, stride);
+      idx = b.createOrFold<arith::AddIOp>(loc, val, offset);
+    }
+    memref = subview.getSource();
+  }
+  return ret;
+}
+
+/// Fuse producer into the single consumer loop by recomputing producer value
+/// for each consumer load of the temporary buffer. Consumer can have any
+/// iteration space and can read neighbouring elements (stencils) or reduce
+/// them. Producer loop is removed after fusion, so temporary buffer is not
+/// written anymore.
+static bool
+fuseProducerIfLegal(scf::ParallelOp producer, OpBuilder &b,
+                    llvm::function_ref<mlir::AliasAnalysis &()> getAnalysis) {
+  if (hasNestedParallelOp(producer))
+    return false;
+
+  auto store = getProducerStore(producer);
+  if (!store)
+    return false;
+
+  auto tmp = store.getMemRef();
+  SmallVector<memref::LoadOp> loads;
+  if (!collectTmpLoads(tmp, store, loads) || loads.empty())
+    return false;
+
+  // All loads must be inside the single consumer loop, following the
+  // producer in the same block.
+  auto block = producer->getBlock();
+  scf::ParallelOp consumer;
+  for (auto load : loads) {
+    auto ancestor = block->findAncestorOpInBlock(*load.getOperation());
+    auto ploop = dyn_cast_or_null<scf::ParallelOp>(ancestor);
+    if (!ploop || (consumer && ploop != consumer) ||
+        !producer->isBeforeInBlock(ploop))
+      return false;
+
+    consumer = ploop;
+  }
+
+  unsigned bodySize = 0;
+  SmallVector<Value> inputs;
+  for (auto &op : producer.getBody()->without_terminator()) {
+    ++bodySize;
+    if (auto load = dyn_cast<memref::LoadOp>(op))
+      inputs.emplace_back(load.getMemRef());
+  }
+
+  if (bodySize * loads.size() > kMaxRecomputedOps)
+    return false;
+
+  // Producer inputs must stay unchanged until the end of the consumer.
+  if (!inputs.empty()) {
+    for (auto it = std::next(Block::iterator(producer));
+         it != Block::iterator(consumer); ++it)
+      if (!hasNoWritesTo(&*it, inputs, getAnalysis))
+        return false;
+
+    if (!hasNoWritesTo(consumer, inputs, getAnalysis))
+      return false;
+  }
+
+  IRMapping mapping;
+  auto ivs = producer.getInductionVars();
+  for (auto load : loads) {
+    auto loc = load.getLoc();
+    b.setInsertionPoint(load);
+    auto indices =
+        getSourceIndices(b, loc, load.getMemRef(), load.getIndices(), tmp);
+    mapping.clear();
+    mapping.map(ivs, indices);
+    for (auto &op : producer.getBody()->without_terminator())
+      if (&op != store.getOperation())
+        b.clone(op, mapping);
+
+    load.replaceAllUsesWith(mapping.lookupOrDefault(store.getValue()));
+    load->erase();
+  }
+  producer->erase();
+  return true;
+}
 } // namespace
 
+mlir::LogicalResult numba::fuseProducerConsumerParallelOps(Region &region) {
+  std::unique_ptr<mlir::AliasAnalysis> analysis;
+  auto getAnalysis = [&]() -> mlir::AliasAnalysis & {
+    if (!analysis) {
+      auto parent = region.getParentOfType<mlir::FunctionOpInterface>();
+      analysis = std::make_unique<mlir::AliasAnalysis>(parent);
+      analysis->addAnalysisImplementation(numba::LocalAliasAnalysis());
+    }
+
+    return *analysis;
+  };
+  OpBuilder b(region);
+  bool changed = false;
+  for (auto &block : region) {
+    for (auto &op : llvm::make_early_inc_range(block)) {
+      for (auto &innerReg : op.getRegions())
+        if (succeeded(fuseProducerConsumerParallelOps(innerReg)))
+          changed = true;
+
+      if (auto ploop = dyn_cast<scf::ParallelOp>(op))
+        if (fuseProducerIfLegal(ploop, b, getAnalysis))
+          changed = true;
+    }
+  }
+  return mlir::success(changed);
+}
+
 mlir::LogicalResult numba::naivelyFuseParallelOps(Region &region) {
   std::unique_ptr<mlir::AliasAnalysis> analysis;
   auto getAnalysis = [&]() -> mlir::AliasAnalysis & {
@@ -5,8 +5,16 @@
 #include "numba/Transforms/MemoryRewrites.hpp"
 
 #include "numba/Analysis/MemorySsaAnalysis.hpp"
-
+#include "numba/Dialect/numba_util/Dialect.hpp"
+#include "numba/Transforms/ShapeIntegerRangePropagation.hpp"
+
+#include <mlir/Analysis/DataFlow/IntegerRangeAnalysis.h>
+#include <mlir/Analysis/DataFlowFramework.h>
+#include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/Arith/Utils/Utils.h>
+#include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
+#include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Dialect/Vector/IR/VectorOps.h>
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/Dominance.h>
@@ -531,6 +539,513 @@ struct NormalizeMemrefArgs
       markAllAnalysesPreserved();
   }
 };
+
+/// Returns true if op is an environment region, which is not executed on host,
+/// e.g. GPU region.
+static bool isDeviceRegion(mlir::Operation *op) {
+  auto region = mlir::dyn_cast<numba::util::EnvironmentRegionOp>(op);
+  if (!region)
+    return false;
+
+  auto env = region.getEnvironment();
+  return !mlir::isa<numba::util::ParallelAttr, numba::util::AtomicAttr>(env);
+}
+
+/// Check all uses of the `value` (including uses through views) are plain
+/// memory accesses, placed before the `dealloc` in its block.
+static bool checkLocalUses(mlir::Value value, mlir::Operation *dealloc) {
+  auto block = dealloc->getBlock();
+  for (auto user : value.getUsers()) {
+    if (user == dealloc)
+      continue;
+
+    auto ancestor = block->findAncestorOpInBlock(*user);
+    if (!ancestor || !ancestor->isBeforeInBlock(dealloc))
+      return false;
+
+    for (auto parent = user->getParentOp(); parent != block->getParentOp();
+         parent = parent->getParentOp())
+      if (isDeviceRegion(parent))
+        return false;
+
+    if (mlir::isa<mlir::memref::LoadOp, mlir::memref::StoreOp,
+                  mlir::memref::DimOp, mlir::memref::CopyOp,
+                  mlir::vector::LoadOp, mlir::vector::StoreOp,
+                  mlir::vector::TransferReadOp,
+                  mlir::vector::TransferWriteOp>(user))
+      continue;
+
+    // Retain is also a view, but it transfers ownership.
+    if (mlir::isa<mlir::ViewLikeOpInterface>(user) &&
+        !mlir::isa<numba::util::RetainOp>(user)) {
+      for (auto res : user->getResults())
+        if (!checkLocalUses(res, dealloc))
+          return false;
+
+      continue;
+    }
+
+    return false;
+  }
+  return true;
+}
+
+/// Returns dealloc op if allocation is a host temporary, which never escapes
+/// and is released in the same block it was allocated.
+static mlir::memref::DeallocOp getLocalDealloc(mlir::memref::AllocOp op) {
+  auto type = op.getType();
+  if (type.getMemorySpace() || !type.getLayout().isIdentity() ||
+      !op.getSymbolOperands().empty())
+    return nullptr;
+
+  for (auto parent = op->getParentOp(); parent; parent = parent->getParentOp())
+    if (isDeviceRegion(parent))
+      return nullptr;
+
+  mlir::memref::DeallocOp dealloc;
+  for (auto user : op->getUsers()) {
+    auto userDealloc = mlir::dyn_cast<mlir::memref::DeallocOp>(user);
+    if (!userDealloc)
+      continue;
+
+    if (dealloc || userDealloc->getBlock() != op->getBlock())
+      return nullptr;
+
+    dealloc = userDealloc;
+  }
+
+  if (!dealloc || !checkLocalUses(op.getResult(), dealloc))
+    return nullptr;
+
+  return dealloc;
+}
+
+/// Move temporaries with loop-invariant sizes out of sequential loops. Each
+/// iteration releases buffer before the next one starts, so single allocation
+/// can be shared by all iterations.
+static bool hoistLoopAllocs(mlir::scf::ForOp loop) {
+  bool changed = false;
+  auto body = loop.getBody();
+  for (auto alloc :
+       llvm::make_early_inc_range(body->getOps<mlir::memref::AllocOp>())) {
+    auto isInvariant = [&](mlir::Value val) {
+      return loop.isDefinedOutsideOfLoop(val);
+    };
+    if (!llvm::all_of(alloc.getDynamicSizes(), isInvariant))
+      continue;
+
+    auto dealloc = getLocalDealloc(alloc);
+    if (!dealloc)
+      continue;
+
+    alloc->moveBefore(loop);
+    dealloc->moveAfter(loop);
+    changed = true;
+  }
+  return changed;
+}
+
+/// Returns number of elements of `type`, which can be stored in the `buffer`
+/// memory, or `std::nullopt` if it is not known or buffer is too small.
+static std::optional<int64_t> getReuseCost(mlir::memref::AllocOp buffer,
+                                           mlir::memref::AllocOp alloc) {
+  if (buffer.getAlignment() != alloc.getAlignment())
+    return std::nullopt;
+
+  auto bufferType = buffer.getType();
+  auto type = alloc.getType();
+  if (bufferType == type) {
+    if (!llvm::equal(buffer.getDynamicSizes(), alloc.getDynamicSizes()))
+      return std::nullopt;
+
+    return 0;
+  }
+
+  if (bufferType.getElementType() != type.getElementType() ||
+      !bufferType.hasStaticShape() || !type.hasStaticShape())
+    return std::nullopt;
+
+  // Do not keep big buffers alive for much smaller temporaries, it can
+  // increase peak memory instead of reducing it.
+  auto bufferSize = bufferType.getNumElements();
+  auto size = type.getNumElements();
+  if (size > bufferSize || size * 2 < bufferSize)
+    return std::nullopt;
+
+  return bufferSize - size;
+}
+
+/// Reuse memory of temporaries, released earlier in the block, for the new
+/// temporaries instead of allocating new buffers.
+static bool reuseBlockAllocs(mlir::Block &block) {
+  struct Buffer {
+    mlir::memref::AllocOp alloc;
+    mlir::memref::DeallocOp dealloc;
+  };
+
+  // Dealloc of the live temporary -> alloc which owns its memory.
+  llvm::SmallDenseMap<mlir::Operation *, mlir::memref::AllocOp> liveBuffers;
+  llvm::SmallVector<Buffer> deadBuffers;
+
+  bool changed = false;
+  mlir::OpBuilder builder(block.getParent()->getContext());
+  for (auto &op : llvm::make_early_inc_range(block)) {
+    if (auto dealloc = mlir::dyn_cast<mlir::memref::DeallocOp>(op)) {
+      auto it = liveBuffers.find(dealloc);
+      if (it != liveBuffers.end()) {
+        deadBuffers.push_back({it->second, dealloc});
+        liveBuffers.erase(it);
+      }
+      continue;
+    }
+
+    auto alloc = mlir::dyn_cast<mlir::memref::AllocOp>(op);
+    if (!alloc)
+      continue;
+
+    auto dealloc = getLocalDealloc(alloc);
+    if (!dealloc)
+      continue;
+
+    // Best fit.
+    Buffer *buffer = nullptr;
+    int64_t bestCost = 0;
+    for (auto &dead : deadBuffers) {
+      auto cost = getReuseCost(dead.alloc, alloc);
+      if (cost && (!buffer || *cost < bestCost)) {
+        buffer = &dead;
+        bestCost = *cost;
+      }
+    }
+
+    if (!buffer) {
+      liveBuffers.insert({dealloc, alloc});
+      continue;
+    }
+
+    auto bufferAlloc = buffer->alloc;
+    buffer->dealloc->erase();
+    *buffer = deadBuffers.back();
+    deadBuffers.pop_back();
+
+    mlir::Value newMemref = bufferAlloc.getResult();
+    auto type = alloc.getType();
+    if (newMemref.getType() != type) {
+      llvm::SmallVector<int64_t> strides;
+      int64_t offset;
+      auto result = mlir::getStridesAndOffset(type, strides, offset);
+      assert(mlir::succeeded(result) && offset == 0);
+      (void)result;
+      builder.setInsertionPoint(alloc);
+      newMemref = builder.create<mlir::memref::ReinterpretCastOp>(
+          alloc.getLoc(), type, newMemref, offset, type.getShape(), strides);
+    }
+
+    dealloc.getMemrefMutable().assign(bufferAlloc.getResult());
+    alloc.getResult().replaceAllUsesWith(newMemref);
+    alloc->erase();
+    liveBuffers.insert({dealloc, bufferAlloc});
+    changed = true;
+  }
+  return changed;
+}
+
+struct BufferReusePass
+    : public mlir::PassWrapper<BufferReusePass,
+                               mlir::InterfacePass<mlir::FunctionOpInterface>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(BufferReusePass)
+
+  virtual void
+  getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::memref::MemRefDialect>();
+  }
+
+  void runOnOperation() override {
+    auto func = getOperation();
+
+    bool changed = false;
+
+    // Post-order walk, so inner loops allocations are hoisted first and then
+    // can be hoisted from outer loops.
+    func->walk([&](mlir::scf::ForOp loop) {
+      changed = hoistLoopAllocs(loop) || changed;
+    });
+
+    llvm::SmallVector<mlir::Block *> blocks;
+    func->walk([&](mlir::Block *block) { blocks.emplace_back(block); });
+    for (auto block : blocks)
+      changed = reuseBlockAllocs(*block) || changed;
+
+    if (!changed)
+      markAllAnalysesPreserved();
+  }
+};
+
+static std::optional<int64_t> getElementSizeInBytes(mlir::Type type) {
+  if (mlir::isa<mlir::IndexType>(type))
+    return mlir::IndexType::kInternalStorageBitWidth / 8;
+
+  if (type.isIntOrFloat())
+    return llvm::divideCeil(type.getIntOrFloatBitWidth(), 8);
+
+  if (auto complex = mlir::dyn_cast<mlir::ComplexType>(type)) {
+    auto elemSize = getElementSizeInBytes(complex.getElementType());
+    if (elemSize)
+      return *elemSize * 2;
+  }
+
+  return std::nullopt;
+}
+
+static std::optional<int64_t> getUpperBound(mlir::DataFlowSolver &solver,
+                                            mlir::Value value) {
+  if (auto val = mlir::getConstantIntValue(value))
+    return *val;
+
+  auto lattice =
+      solver.lookupState<mlir::dataflow::IntegerValueRangeLattice>(value);
+  if (!lattice || lattice->getValue().isUninitialized())
+    return std::nullopt;
+
+  auto &range = lattice->getValue().getValue();
+  auto max = range.smax();
+  if (max.getSignificantBits() > 64)
+    return std::nullopt;
+
+  return max.getSExtValue();
+}
+
+/// Returns block, where stack allocations for op can be placed: either start
+/// of the function or start of the parallel loop body, as body is executed in
+/// separate function for each thread. Allocations at the start of the parallel
+/// body are moved to the entry block of the outlined function when it is
+/// lowered. Parallel scan regions are cloned into loops when outlined, so
+/// allocations inside them are not promoted.
+static mlir::Block *getAllocaScope(mlir::Operation *op) {
+  for (auto parent = op->getParentOp(); parent;
+       parent = parent->getParentOp()) {
+    if (auto parallel = mlir::dyn_cast<numba::util::ParallelOp>(parent))
+      return parallel.getBodyBlock();
+
+    if (mlir::isa<numba::util::ParallelScanOp>(parent))
+      return nullptr;
+
+    if (auto func = mlir::dyn_cast<mlir::func::FuncOp>(parent))
+      return &func.getFunctionBody().front();
+  }
+  return nullptr;
+}
+
+static llvm::SmallVector<mlir::OpFoldResult>
+getIdentityStrides(mlir::OpBuilder &builder, mlir::Location loc,
+                   llvm::ArrayRef<mlir::OpFoldResult> sizes) {
+  auto rank = sizes.size();
+  llvm::SmallVector<mlir::OpFoldResult> strides(rank);
+  mlir::OpFoldResult stride = builder.getIndexAttr(1);
+  for (auto i : llvm::reverse(llvm::seq<size_t>(0, rank))) {
+    strides[i] = stride;
+    if (i == 0)
+      break;
+
+    auto lhs = mlir::getValueOrCreateConstantIndexOp(builder, loc, stride);
+    auto rhs = mlir::getValueOrCreateConstantIndexOp(builder, loc, sizes[i]);
+    mlir::Value res = builder.createOrFold<mlir::arith::MulIOp>(loc, lhs, rhs);
+    if (auto val = mlir::getConstantIntValue(res)) {
+      stride = builder.getIndexAttr(*val);
+    } else {
+      stride = res;
+    }
+  }
+  return strides;
+}
+
+struct PromoteToStackPass
+    : public mlir::PassWrapper<PromoteToStackPass,
+                               mlir::OperationPass<mlir::ModuleOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(PromoteToStackPass)
+
+  // Total size of promoted allocations per scope, so multiple small
+  // temporaries won't overflow the stack, especially on worker threads.
+  static constexpr int64_t kMaxScopeSizeInBytes = 16 * 1024;
+
+  PromoteToStackPass(int64_t maxAllocSizeInBytes)
+      : maxAllocSizeInBytes(maxAllocSizeInBytes) {}
+
+  virtual void
+  getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::arith::ArithDialect>();
+    registry.insert<mlir::memref::MemRefDialect>();
+  }
+
+  void runOnOperation() override {
+    auto mod = getOperation();
+
+    llvm::SmallVector<std::pair<mlir::memref::AllocOp, mlir::Operation *>>
+        candidates;
+    bool hasDynamic = false;
+    for (auto func : mod.getOps<mlir::func::FuncOp>()) {
+      func->walk([&](mlir::memref::AllocOp op) {
+        auto dealloc = getLocalDealloc(op);
+        if (!dealloc)
+          return;
+
+        candidates.emplace_back(op, dealloc);
+        hasDynamic = hasDynamic || !op.getType().hasStaticShape();
+      });
+    }
+
+    if (candidates.empty())
+      return markAllAnalysesPreserved();
+
+    // Range analysis is only needed to bound dynamic sizes.
+    mlir::DataFlowSolver solver;
+    if (hasDynamic) {
+      numba::loadShapeIntegerRangeAnalysis(solver);
+      if (mlir::failed(solver.initializeAndRun(mod)))
+        return signalPassFailure();
+    }
+
+    bool changed = false;
+    llvm::SmallDenseMap<mlir::Block *, int64_t> scopeSizes;
+    mlir::OpBuilder builder(&getContext());
+    for (auto &&[alloc, dealloc] : candidates) {
+      auto type = alloc.getType();
+      auto elemSize = getElementSizeInBytes(type.getElementType());
+      if (!elemSize)
+        continue;
+
+      llvm::SmallVector<int64_t> shape(type.getShape());
+      auto dynamicSizes = alloc.getDynamicSizes();
+      int64_t size = *elemSize;
+      bool bounded = true;
+      for (auto &dim : shape) {
+        if (mlir::ShapedType::isDynamic(dim)) {
+          auto dynamicSize = dynamicSizes.front();
+          dynamicSizes = dynamicSizes.drop_front();
+          auto bound = getUpperBound(solver, dynamicSize);
+          if (!bound || *bound < 0) {
+            bounded = false;
+            break;
+          }
+          dim = *bound;
+        }
+
+        if (dim != 0 && size > maxAllocSizeInBytes / dim) {
+          bounded = false;
+          break;
+        }
+        size *= dim;
+      }
+
+      if (!bounded || size > maxAllocSizeInBytes)
+        continue;
+
+      auto scope = getAllocaScope(alloc);
+      if (!scope)
+        continue;
+
+      auto &scopeSize = scopeSizes[scope];
+      if (scopeSize + size > kMaxScopeSizeInBytes)
+        continue;
+
+      scopeSize += size;
+
+      // Match heap allocations alignment.
+      auto alignment = alloc.getAlignmentAttr();
+      if (!alignment && type.getElementType().isSignlessIntOrIndexOrFloat())
+        alignment = builder.getI64IntegerAttr(32);
+
+      auto loc = alloc.getLoc();
+      builder.setInsertionPointToStart(scope);
+      auto allocaType = mlir::MemRefType::get(shape, type.getElementType());
+      mlir::Value newMemref =
+          builder.create<mlir::memref::AllocaOp>(loc, allocaType, alignment);
+
+      if (allocaType != type) {
+        builder.setInsertionPoint(alloc);
+        llvm::SmallVector<mlir::OpFoldResult> sizes;
+        dynamicSizes = alloc.getDynamicSizes();
+        for (auto dim : type.getShape()) {
+          if (mlir::ShapedType::isDynamic(dim)) {
+            sizes.emplace_back(dynamicSizes.front());
+            dynamicSizes = dynamicSizes.drop_front();
+          } else {
+            sizes.emplace_back(builder.getIndexAttr(dim));
+          }
+        }
+        auto strides = getIdentityStrides(builder, loc, sizes);
+        newMemref = builder.create<mlir::memref::ReinterpretCastOp>(
+            loc, type, newMemref, builder.getIndexAttr(0), sizes, strides);
+      }
+
+      dealloc->erase();
+      alloc.getResult().replaceAllUsesWith(newMemref);
+      alloc->erase();
+      changed = true;
+    }
+
+    if (!changed)
+      markAllAnalysesPreserved();
+  }
+
+private:
+  int64_t maxAllocSizeInBytes;
+};
+
+static bool canUseEscape(mlir::Operation *user) {
+  if (mlir::isa<mlir::memref::LoadOp, mlir::memref::StoreOp,
+                mlir::memref::DimOp, mlir::memref::CopyOp>(user))
+    return false;
+
+  if (mlir::isa<mlir::ViewLikeOpInterface>(user))
+    return llvm::any_of(user->getUsers(), &canUseEscape);
+
+  return true;
+}
+
+/// Returns dealloc op if allocation result is only accessed inside the
+/// function and released in the same block it was allocated.
+static mlir::memref::DeallocOp
+getNonEscapingDealloc(mlir::memref::AllocOp op) {
+  if (op.getType().getMemorySpace())
+    return nullptr;
+
+  mlir::memref::DeallocOp dealloc;
+  for (auto user : op->getUsers()) {
+    if (auto userDealloc = mlir::dyn_cast<mlir::memref::DeallocOp>(user)) {
+      if (dealloc || userDealloc->getBlock() != op->getBlock())
+        return nullptr;
+
+      dealloc = userDealloc;
+      continue;
+    }
+
+    if (canUseEscape(user))
+      return nullptr;
+  }
+  return dealloc;
+}
+
+/// Mark allocations which never escape to python, so they can use runtime
+/// thread-caching pool allocator instead of NRT.
+struct MarkPoolAllocsPass
+    : public mlir::PassWrapper<MarkPoolAllocsPass,
+                               mlir::OperationPass<mlir::func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(MarkPoolAllocsPass)
+
+  void runOnOperation() override final {
+    auto attrName = numba::util::attributes::getPoolAllocName();
+    auto attr = mlir::UnitAttr::get(&getContext());
+    getOperation()->walk([&](mlir::memref::AllocOp op) {
+      auto dealloc = getNonEscapingDealloc(op);
+      if (!dealloc)
+        return;
+
+      op->setAttr(attrName, attr);
+      dealloc->setAttr(attrName, attr);
+    });
+  }
+};
 } // namespace
 
 std::unique_ptr<mlir::Pass> numba::createMemoryOptPass() {
@@ -540,3 +1055,16 @@ std::unique_ptr<mlir::Pass> numba::createMemoryOptPass() {
 std::unique_ptr<mlir::Pass> numba::createNormalizeMemrefArgsPass() {
   return std::make_unique<NormalizeMemrefArgs>();
 }
+
+std::unique_ptr<mlir::Pass> numba::createBufferReusePass() {
+  return std::make_unique<BufferReusePass>();
+}
+
+std::unique_ptr<mlir::Pass>
+numba::createPromoteToStackPass(int64_t maxAllocSizeInBytes) {
+  return std::make_unique<PromoteToStackPass>(maxAllocSizeInBytes);
+}
+
+std::unique_ptr<mlir::Pass> numba::createMarkPoolAllocsPass() {
+  return std::make_unique<MarkPoolAllocsPass>();
+}
@@ -9,32 +9,58 @@
 
 #include "numba/Dialect/numba_util/Dialect.hpp"
 
+static bool lessName(mlir::Attribute lhs, mlir::StringAttr rhs) {
+  return lhs.cast<mlir::StringAttr>().getValue() < rhs.getValue();
+}
+
+static void addMarker(llvm::SmallVectorImpl<mlir::Attribute> &nameList,
+                      mlir::StringAttr name) {
+  auto it = llvm::lower_bound(nameList, name, &lessName);
+  if (it == nameList.end()) {
+    nameList.emplace_back(name);
+  } else if (*it != name) {
+    nameList.insert(it, name);
+  }
+}
+
 mlir::ArrayAttr numba::getPipelineJumpMarkers(mlir::ModuleOp module) {
-  return module->getAttrOfType<mlir::ArrayAttr>(
-      numba::util::attributes::getJumpMarkersName());
+  auto jumpMarkers = numba::util::attributes::getJumpMarkersName();
+  llvm::SmallVector<mlir::Attribute, 16> nameList;
+  auto collect = [&](mlir::Operation *op) {
+    if (auto attr = op->getAttrOfType<mlir::ArrayAttr>(jumpMarkers))
+      for (auto name : attr.getAsRange<mlir::StringAttr>())
+        addMarker(nameList, name);
+  };
+
+  collect(module);
+  for (auto &op : module.getBody()->getOperations())
+    collect(&op);
+
+  if (nameList.empty())
+    return nullptr;
+
+  return mlir::ArrayAttr::get(module.getContext(), nameList);
 }
 
-void numba::addPipelineJumpMarker(mlir::ModuleOp module,
-                                  mlir::StringAttr name) {
+void numba::addPipelineJumpMarker(mlir::Operation *op, mlir::StringAttr name) {
+  assert(op);
   assert(name);
   assert(!name.getValue().empty());
 
+  while (auto parent = op->getParentOp()) {
+    if (mlir::isa<mlir::ModuleOp>(parent))
+      break;
+
+    op = parent;
+  }
+
   auto jumpMarkers = numba::util::attributes::getJumpMarkersName();
   llvm::SmallVector<mlir::Attribute, 16> nameList;
-  if (auto oldAttr = module->getAttrOfType<mlir::ArrayAttr>(jumpMarkers))
+  if (auto oldAttr = op->getAttrOfType<mlir::ArrayAttr>(jumpMarkers))
     nameList.assign(oldAttr.begin(), oldAttr.end());
 
-  auto it = llvm::lower_bound(
-      nameList, name, [](mlir::Attribute lhs, mlir::StringAttr rhs) {
-        return lhs.cast<mlir::StringAttr>().getValue() < rhs.getValue();
-      });
-  if (it == nameList.end()) {
-    nameList.emplace_back(name);
-  } else if (*it != name) {
-    nameList.insert(it, name);
-  }
-  module->setAttr(jumpMarkers,
-                  mlir::ArrayAttr::get(module.getContext(), nameList));
+  addMarker(nameList, name);
+  op->setAttr(jumpMarkers, mlir::ArrayAttr::get(op->getContext(), nameList));
 }
 
 void numba::removePipelineJumpMarker(mlir::ModuleOp module,
@@ -43,16 +69,27 @@ void numba::removePipelineJumpMarker(mlir::ModuleOp module,
   assert(!name.getValue().empty());
 
   auto jumpMarkers = numba::util::attributes::getJumpMarkersName();
-  llvm::SmallVector<mlir::Attribute, 16> nameList;
-  if (auto oldAttr = module->getAttrOfType<mlir::ArrayAttr>(jumpMarkers))
-    nameList.assign(oldAttr.begin(), oldAttr.end());
+  auto remove = [&](mlir::Operation *op) {
+    auto oldAttr = op->getAttrOfType<mlir::ArrayAttr>(jumpMarkers);
+    if (!oldAttr)
+      return;
+
+    llvm::SmallVector<mlir::Attribute, 16> nameList(oldAttr.begin(),
+                                                    oldAttr.end());
+    auto it = llvm::lower_bound(nameList, name, &lessName);
+    if (it == nameList.end() || *it != name)
+      return;
+
+    nameList.erase(it);
+    if (nameList.empty()) {
+      op->removeAttr(jumpMarkers);
+    } else {
+      op->setAttr(jumpMarkers,
+                  mlir::ArrayAttr::get(op->getContext(), nameList));
+    }
+  };
 
-  auto it = llvm::lower_bound(
-      nameList, name, [](mlir::Attribute lhs, mlir::StringAttr rhs) {
-        return lhs.cast<mlir::StringAttr>().getValue() < rhs.getValue();
-      });
-  assert(it != nameList.end());
-  nameList.erase(it);
-  module->setAttr(jumpMarkers,
-                  mlir::ArrayAttr::get(module.getContext(), nameList));
+  remove(module);
+  for (auto &op : module.getBody()->getOperations())
+    remove(&op);
 }
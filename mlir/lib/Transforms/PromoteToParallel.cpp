@@ -4,15 +4,19 @@
 
 #include "numba/Transforms/PromoteToParallel.hpp"
 
+#include "numba/Analysis/AliasAnalysis.hpp"
 #include "numba/Dialect/numba_util/Dialect.hpp"
 #include "numba/Transforms/CommonOpts.hpp"
 #include "numba/Transforms/ConstUtils.hpp"
 
 #include <mlir/Dialect/Arith/IR/Arith.h>
+#include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
+#include <mlir/Dialect/Utils/StaticValueUtils.h>
 #include <mlir/IR/Dominance.h>
 #include <mlir/IR/IRMapping.h>
 #include <mlir/Interfaces/CallInterfaces.h>
+#include <mlir/Interfaces/SideEffectInterfaces.h>
 #include <mlir/Pass/Pass.h>
 #include <mlir/Transforms/GreedyPatternRewriteDriver.h>
 
@@ -145,6 +149,75 @@ static LowerFunc getLowerer(mlir::Operation *op, mlir::Value iterVar) {
   return nullptr;
 }
 
+static bool isScanCombineOp(mlir::Operation *op) {
+  if (mlir::isa<arith::AddIOp, arith::MulIOp, arith::MinSIOp, arith::MinUIOp,
+                arith::MaxSIOp, arith::MaxUIOp, arith::MinimumFOp,
+                arith::MaximumFOp>(op))
+    return true;
+
+  // Parallel scan reassociates operations, only allow it for floats if
+  // explicitly permitted.
+  if (mlir::isa<arith::AddFOp, arith::MulFOp>(op)) {
+    auto fmf = mlir::cast<arith::ArithFastMathInterface>(op)
+                   .getFastMathFlagsAttr();
+    return fmf && arith::bitEnumContainsAll(fmf.getValue(),
+                                            arith::FastMathFlags::reassoc);
+  }
+
+  return false;
+}
+
+static mlir::Value skipIndexCasts(mlir::Value val) {
+  while (auto cast = val.getDefiningOp<mlir::arith::IndexCastOp>())
+    val = cast.getIn();
+
+  return val;
+}
+
+/// Checks if index is loop induction var, possibly wrapped into negative index
+/// handling `select(idx < 0, size + idx, idx)`, which is noop for non-negative
+/// induction var.
+static bool isInductionVarIndex(mlir::scf::ForOp loop, mlir::Value index) {
+  auto iv = loop.getInductionVar();
+  index = skipIndexCasts(index);
+  if (index == iv)
+    return true;
+
+  auto select = index.getDefiningOp<mlir::arith::SelectOp>();
+  if (!select || skipIndexCasts(select.getFalseValue()) != iv)
+    return false;
+
+  auto cmp = select.getCondition().getDefiningOp<mlir::arith::CmpIOp>();
+  if (!cmp || cmp.getPredicate() != mlir::arith::CmpIPredicate::slt ||
+      skipIndexCasts(cmp.getLhs()) != iv)
+    return false;
+
+  auto rhs = mlir::getConstantIntValue(cmp.getRhs());
+  auto lowerBound = mlir::getConstantIntValue(loop.getLowerBound());
+  return rhs && *rhs == 0 && lowerBound && *lowerBound >= 0;
+}
+
+/// Each iteration must store into its own memory location, so stores from
+/// different iterations can be executed in any order.
+static bool isScanStoreLegal(mlir::scf::ForOp loop,
+                             mlir::memref::StoreOp store) {
+  if (store->getBlock() != loop.getBody() ||
+      !loop.isDefinedOutsideOfLoop(store.getMemref()))
+    return false;
+
+  bool hasInductionVar = false;
+  for (auto index : store.getIndices()) {
+    if (isInductionVarIndex(loop, index)) {
+      hasInductionVar = true;
+      continue;
+    }
+
+    if (!loop.isDefinedOutsideOfLoop(index))
+      return false;
+  }
+  return hasInductionVar;
+}
+
 static bool isInsideParallelRegion(mlir::Operation *op) {
   assert(op && "Invalid op");
   while (true) {
@@ -501,6 +574,31 @@ struct MergeNestedForIntoParallel
   }
 };
 
+struct MarkParallelScan : public mlir::OpRewritePattern<mlir::scf::ForOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::scf::ForOp op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto attrName = numba::util::attributes::getParallelScanName();
+    if (op->hasAttr(attrName))
+      return mlir::failure();
+
+    // Loops inside parallel or device regions are already handled by
+    // corresponding lowering.
+    if (op->getParentOfType<numba::util::EnvironmentRegionOp>() ||
+        op->getParentOfType<mlir::scf::ParallelOp>())
+      return mlir::failure();
+
+    if (!numba::getParallelScanCombineOp(op))
+      return mlir::failure();
+
+    rewriter.updateRootInPlace(
+        op, [&]() { op->setAttr(attrName, rewriter.getUnitAttr()); });
+    return mlir::success();
+  }
+};
+
 struct PromoteWhilePass
     : public mlir::PassWrapper<PromoteWhilePass, mlir::OperationPass<void>> {
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(PromoteWhilePass)
@@ -556,8 +654,67 @@ void numba::populatePromoteWhilePatterns(mlir::RewritePatternSet &patterns) {
 
 void numba::populatePromoteToParallelPatterns(
     mlir::RewritePatternSet &patterns) {
-  patterns.insert<PromoteToParallel, MergeNestedForIntoParallel>(
-      patterns.getContext());
+  patterns.insert<PromoteToParallel, MergeNestedForIntoParallel,
+                  MarkParallelScan>(patterns.getContext());
+}
+
+mlir::Operation *numba::getParallelScanCombineOp(mlir::scf::ForOp loop) {
+  if (loop.getNumRegionIterArgs() != 1)
+    return nullptr;
+
+  auto acc = loop.getRegionIterArgs().front();
+  if (!acc.getType().isIntOrIndexOrFloat() || !acc.hasOneUse())
+    return nullptr;
+
+  mlir::Block *body = loop.getBody();
+  auto term = mlir::cast<mlir::scf::YieldOp>(body->getTerminator());
+  auto combineOp = term.getResults().front().getDefiningOp();
+  if (!combineOp || combineOp != *acc.user_begin() ||
+      !isScanCombineOp(combineOp))
+    return nullptr;
+
+  // Combined value which is only yielded is a plain reduction.
+  if (combineOp->getResult(0).hasOneUse())
+    return nullptr;
+
+  llvm::SmallVector<mlir::Value> loads;
+  llvm::SmallVector<mlir::Value> stores;
+  auto visitor = [&](mlir::Operation *bodyOp) -> mlir::WalkResult {
+    if (auto load = mlir::dyn_cast<mlir::memref::LoadOp>(bodyOp)) {
+      loads.emplace_back(load.getMemref());
+      return mlir::WalkResult::advance();
+    }
+
+    if (auto store = mlir::dyn_cast<mlir::memref::StoreOp>(bodyOp)) {
+      if (!isScanStoreLegal(loop, store))
+        return mlir::WalkResult::interrupt();
+
+      stores.emplace_back(store.getMemref());
+      return mlir::WalkResult::advance();
+    }
+
+    if (bodyOp->hasTrait<mlir::OpTrait::HasRecursiveMemoryEffects>() ||
+        bodyOp->hasTrait<mlir::OpTrait::IsTerminator>() ||
+        mlir::isMemoryEffectFree(bodyOp))
+      return mlir::WalkResult::advance();
+
+    return mlir::WalkResult::interrupt();
+  };
+  if (body->walk(visitor).wasInterrupted())
+    return nullptr;
+
+  numba::LocalAliasAnalysis aliasAnalysis;
+  for (auto &&[i, store] : llvm::enumerate(stores)) {
+    for (auto load : loads)
+      if (!aliasAnalysis.alias(store, load).isNo())
+        return nullptr;
+
+    for (auto other : llvm::ArrayRef<mlir::Value>(stores).drop_front(i + 1))
+      if (other != store && !aliasAnalysis.alias(store, other).isNo())
+        return nullptr;
+  }
+
+  return combineOp;
 }
 
 std::unique_ptr<mlir::Pass> numba::createPromoteWhilePass() {
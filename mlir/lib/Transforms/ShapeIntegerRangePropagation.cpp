@@ -670,9 +670,7 @@ struct ShapeIntegerRangePropagationPass
     LLVM_DEBUG(llvm::dbgs() << "ShapeIntegerRangePropagationPass:\n");
     auto op = getOperation();
     mlir::DataFlowSolver solver;
-    solver.load<mlir::dataflow::DeadCodeAnalysis>();
-    solver.load<ShapeValueAnalysis>();
-    solver.load<IntegerRangeAnalysisEx>();
+    numba::loadShapeIntegerRangeAnalysis(solver);
     if (failed(solver.initializeAndRun(op)))
       return signalPassFailure();
 
@@ -690,6 +688,12 @@ struct ShapeIntegerRangePropagationPass
 };
 } // namespace
 
+void numba::loadShapeIntegerRangeAnalysis(mlir::DataFlowSolver &solver) {
+  solver.load<mlir::dataflow::DeadCodeAnalysis>();
+  solver.load<ShapeValueAnalysis>();
+  solver.load<IntegerRangeAnalysisEx>();
+}
+
 std::unique_ptr<mlir::Pass> numba::createShapeIntegerRangePropagationPass() {
   return std::make_unique<ShapeIntegerRangePropagationPass>();
 }
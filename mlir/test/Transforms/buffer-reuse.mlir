@@ -0,0 +1,157 @@
+// RUN: numba-mlir-opt -allow-unregistered-dialect -pass-pipeline='builtin.module(func.func(numba-buffer-reuse))' --split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func @reuse_same_type
+// CHECK-SAME:  (%[[D:.*]]: index, %{{.*}}: f32, %{{.*}}: index)
+// CHECK:       %[[M:.*]] = memref.alloc(%[[D]]) : memref<?xf32>
+// CHECK-NEXT:  memref.store %{{.*}}, %[[M]][%{{.*}}] : memref<?xf32>
+// CHECK-NEXT:  %[[V1:.*]] = memref.load %[[M]][%{{.*}}] : memref<?xf32>
+// CHECK-NEXT:  memref.store %[[V1]], %[[M]][%{{.*}}] : memref<?xf32>
+// CHECK-NEXT:  %[[V2:.*]] = memref.load %[[M]][%{{.*}}] : memref<?xf32>
+// CHECK-NEXT:  memref.dealloc %[[M]] : memref<?xf32>
+// CHECK-NEXT:  return %[[V2]]
+func.func @reuse_same_type(%d: index, %v: f32, %i: index) -> f32 {
+  %m1 = memref.alloc(%d) : memref<?xf32>
+  memref.store %v, %m1[%i] : memref<?xf32>
+  %v1 = memref.load %m1[%i] : memref<?xf32>
+  memref.dealloc %m1 : memref<?xf32>
+  %m2 = memref.alloc(%d) : memref<?xf32>
+  memref.store %v1, %m2[%i] : memref<?xf32>
+  %v2 = memref.load %m2[%i] : memref<?xf32>
+  memref.dealloc %m2 : memref<?xf32>
+  return %v2 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @reuse_load_store
+// CHECK:       %[[M:.*]] = memref.alloc() : memref<10xf32>
+// CHECK-NEXT:  memref.store %{{.*}}, %[[M]][%{{.*}}] : memref<10xf32>
+// CHECK-NEXT:  %[[V1:.*]] = memref.load %[[M]][%{{.*}}] : memref<10xf32>
+// CHECK-NEXT:  %[[C:.*]] = memref.reinterpret_cast %[[M]] to offset: [0], sizes: [8], strides: [1] : memref<10xf32> to memref<8xf32>
+// CHECK-NEXT:  memref.store %[[V1]], %[[C]][%{{.*}}] : memref<8xf32>
+// CHECK-NEXT:  %[[V2:.*]] = memref.load %[[C]][%{{.*}}] : memref<8xf32>
+// CHECK-NEXT:  memref.dealloc %[[M]] : memref<10xf32>
+// CHECK-NEXT:  return %[[V2]]
+func.func @reuse_load_store(%v: f32, %i: index) -> f32 {
+  %m1 = memref.alloc() : memref<10xf32>
+  memref.store %v, %m1[%i] : memref<10xf32>
+  %v1 = memref.load %m1[%i] : memref<10xf32>
+  memref.dealloc %m1 : memref<10xf32>
+  %m2 = memref.alloc() : memref<8xf32>
+  memref.store %v1, %m2[%i] : memref<8xf32>
+  %v2 = memref.load %m2[%i] : memref<8xf32>
+  memref.dealloc %m2 : memref<8xf32>
+  return %v2 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_reuse_live
+// CHECK:       memref.alloc() : memref<10xf32>
+// CHECK:       memref.alloc() : memref<10xf32>
+func.func @no_reuse_live(%v: f32, %i: index) -> f32 {
+  %m1 = memref.alloc() : memref<10xf32>
+  memref.store %v, %m1[%i] : memref<10xf32>
+  %m2 = memref.alloc() : memref<10xf32>
+  memref.store %v, %m2[%i] : memref<10xf32>
+  %v1 = memref.load %m1[%i] : memref<10xf32>
+  memref.store %v1, %m2[%i] : memref<10xf32>
+  memref.dealloc %m1 : memref<10xf32>
+  %v2 = memref.load %m2[%i] : memref<10xf32>
+  memref.dealloc %m2 : memref<10xf32>
+  return %v2 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_reuse_escaping
+// CHECK:       memref.alloc() : memref<10xf32>
+// CHECK:       memref.alloc() : memref<10xf32>
+func.func @no_reuse_escaping(%v: f32, %i: index) -> memref<10xf32> {
+  %m1 = memref.alloc() : memref<10xf32>
+  memref.store %v, %m1[%i] : memref<10xf32>
+  memref.dealloc %m1 : memref<10xf32>
+  %m2 = memref.alloc() : memref<10xf32>
+  memref.store %v, %m2[%i] : memref<10xf32>
+  return %m2 : memref<10xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @no_reuse_much_bigger
+// CHECK:       memref.alloc() : memref<100xf32>
+// CHECK:       memref.alloc() : memref<10xf32>
+func.func @no_reuse_much_bigger(%v: f32, %i: index) {
+  %m1 = memref.alloc() : memref<100xf32>
+  memref.store %v, %m1[%i] : memref<100xf32>
+  memref.dealloc %m1 : memref<100xf32>
+  %m2 = memref.alloc() : memref<10xf32>
+  memref.store %v, %m2[%i] : memref<10xf32>
+  memref.dealloc %m2 : memref<10xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @hoist_loop
+// CHECK-SAME:  (%[[D:.*]]: index, %{{.*}}: f32)
+// CHECK:       %[[M:.*]] = memref.alloc(%[[D]]) : memref<?xf32>
+// CHECK-NEXT:  scf.for
+// CHECK-NEXT:    memref.store %{{.*}}, %[[M]][%{{.*}}] : memref<?xf32>
+// CHECK-NEXT:    %[[V:.*]] = memref.load %[[M]][%{{.*}}] : memref<?xf32>
+// CHECK-NEXT:    "test.test"(%[[V]]) : (f32) -> ()
+// CHECK-NEXT:  }
+// CHECK-NEXT:  memref.dealloc %[[M]] : memref<?xf32>
+// CHECK-NEXT:  return
+func.func @hoist_loop(%d: index, %v: f32) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  scf.for %i = %c0 to %c10 step %c1 {
+    %m = memref.alloc(%d) : memref<?xf32>
+    memref.store %v, %m[%i] : memref<?xf32>
+    %v1 = memref.load %m[%i] : memref<?xf32>
+    "test.test"(%v1) : (f32) -> ()
+    memref.dealloc %m : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_hoist_variant_size
+// CHECK:       scf.for %[[I:.*]] = %{{.*}} to %{{.*}} step %{{.*}} {
+// CHECK-NEXT:    memref.alloc(%[[I]]) : memref<?xf32>
+func.func @no_hoist_variant_size(%v: f32) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  scf.for %i = %c0 to %c10 step %c1 {
+    %m = memref.alloc(%i) : memref<?xf32>
+    memref.store %v, %m[%c0] : memref<?xf32>
+    %v1 = memref.load %m[%c0] : memref<?xf32>
+    "test.test"(%v1) : (f32) -> ()
+    memref.dealloc %m : memref<?xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_hoist_parallel
+// CHECK:       scf.parallel
+// CHECK-NEXT:    memref.alloc() : memref<10xf32>
+func.func @no_hoist_parallel(%v: f32) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  scf.parallel (%i) = (%c0) to (%c10) step (%c1) {
+    %m = memref.alloc() : memref<10xf32>
+    memref.store %v, %m[%i] : memref<10xf32>
+    %v1 = memref.load %m[%i] : memref<10xf32>
+    "test.test"(%v1) : (f32) -> ()
+    memref.dealloc %m : memref<10xf32>
+    scf.yield
+  }
+  return
+}
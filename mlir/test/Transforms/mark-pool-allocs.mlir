@@ -0,0 +1,83 @@
+// RUN: numba-mlir-opt -allow-unregistered-dialect -pass-pipeline='builtin.module(numba-mark-pool-allocs)' --split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func @mark_local
+// CHECK:       %[[M:.*]] = memref.alloc() {numba.pool_alloc} : memref<3xf64>
+// CHECK:       memref.dealloc %[[M]] {numba.pool_alloc} : memref<3xf64>
+func.func @mark_local(%v: f64, %i: index) -> f64 {
+  %m = memref.alloc() : memref<3xf64>
+  memref.store %v, %m[%i] : memref<3xf64>
+  %v1 = memref.load %m[%i] : memref<3xf64>
+  memref.dealloc %m : memref<3xf64>
+  return %v1 : f64
+}
+
+// -----
+
+// CHECK-LABEL: func @mark_view_copy
+// CHECK:       %[[M:.*]] = memref.alloc(%{{.*}}) {numba.pool_alloc} : memref<?xf32>
+// CHECK:       memref.dealloc %[[M]] {numba.pool_alloc} : memref<?xf32>
+func.func @mark_view_copy(%arg: memref<?xf32>, %s: index) {
+  %c0 = arith.constant 0 : index
+  %d = memref.dim %arg, %c0 : memref<?xf32>
+  %m = memref.alloc(%d) : memref<?xf32>
+  memref.copy %arg, %m : memref<?xf32> to memref<?xf32>
+  %v = memref.subview %m[%s] [%s] [1] : memref<?xf32> to memref<?xf32, strided<[1], offset: ?>>
+  %v1 = memref.load %v[%c0] : memref<?xf32, strided<[1], offset: ?>>
+  memref.store %v1, %arg[%c0] : memref<?xf32>
+  memref.dealloc %m : memref<?xf32>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @returned
+// CHECK-NOT:   numba.pool_alloc
+func.func @returned() -> memref<3xf64> {
+  %m = memref.alloc() : memref<3xf64>
+  return %m : memref<3xf64>
+}
+
+// -----
+
+// CHECK-LABEL: func @view_escapes
+// CHECK-NOT:   numba.pool_alloc
+func.func @view_escapes(%s: index) {
+  %m = memref.alloc() : memref<8xf64>
+  %v = memref.subview %m[%s] [4] [1] : memref<8xf64> to memref<4xf64, strided<[1], offset: ?>>
+  "test.test"(%v) : (memref<4xf64, strided<[1], offset: ?>>) -> ()
+  memref.dealloc %m : memref<8xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @dealloc_other_block
+// CHECK-NOT:   numba.pool_alloc
+func.func @dealloc_other_block(%cond: i1) {
+  %m = memref.alloc() : memref<3xf64>
+  scf.if %cond {
+    memref.dealloc %m : memref<3xf64>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_dealloc
+// CHECK-NOT:   numba.pool_alloc
+func.func @no_dealloc(%v: f64, %i: index) {
+  %m = memref.alloc() : memref<3xf64>
+  memref.store %v, %m[%i] : memref<3xf64>
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @memory_space
+// CHECK-NOT:   numba.pool_alloc
+func.func @memory_space(%v: f64, %i: index) {
+  %m = memref.alloc() : memref<3xf64, 1>
+  memref.store %v, %m[%i] : memref<3xf64, 1>
+  memref.dealloc %m : memref<3xf64, 1>
+  return
+}
@@ -388,3 +388,95 @@ func.func @test(%arg: f32, %val: f32) -> f32 {
   }
   return %0 : f32
 }
+
+// -----
+
+// CHECK-LABEL: func @test_scan
+//       CHECK:  scf.for
+//       CHECK:  arith.addi
+//       CHECK:  memref.store
+//       CHECK:  } {numba.parallel_scan}
+func.func @test_scan(%src: memref<?xi64> {numba.restrict}, %dst: memref<?xi64> {numba.restrict}, %init: i64) -> i64 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %n = memref.dim %src, %c0 : memref<?xi64>
+  %0 = scf.for %i = %c0 to %n step %c1 iter_args(%acc = %init) -> (i64) {
+    %1 = memref.load %src[%i] : memref<?xi64>
+    %2 = arith.addi %acc, %1 : i64
+    memref.store %2, %dst[%i] : memref<?xi64>
+    scf.yield %2 : i64
+  }
+  return %0 : i64
+}
+
+// -----
+
+// CHECK-LABEL: func @test_scan_neg_index
+//       CHECK:  } {numba.parallel_scan}
+func.func @test_scan_neg_index(%src: memref<?xf64> {numba.restrict}, %dst: memref<?xf64> {numba.restrict}, %init: f64) -> f64 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %n = memref.dim %src, %c0 : memref<?xf64>
+  %0 = scf.for %i = %c0 to %n step %c1 iter_args(%acc = %init) -> (f64) {
+    %1 = memref.load %src[%i] : memref<?xf64>
+    %2 = arith.mulf %acc, %1 fastmath<fast> : f64
+    %3 = arith.cmpi slt, %i, %c0 : index
+    %4 = arith.addi %n, %i : index
+    %5 = arith.select %3, %4, %i : index
+    memref.store %2, %dst[%5] : memref<?xf64>
+    scf.yield %2 : f64
+  }
+  return %0 : f64
+}
+
+// -----
+
+// Float scan reassociates additions, only allowed with fastmath.
+// CHECK-LABEL: func @test_scan_no_fastmath
+//   CHECK-NOT:  numba.parallel_scan
+func.func @test_scan_no_fastmath(%src: memref<?xf64> {numba.restrict}, %dst: memref<?xf64> {numba.restrict}, %init: f64) -> f64 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %n = memref.dim %src, %c0 : memref<?xf64>
+  %0 = scf.for %i = %c0 to %n step %c1 iter_args(%acc = %init) -> (f64) {
+    %1 = memref.load %src[%i] : memref<?xf64>
+    %2 = arith.addf %acc, %1 : f64
+    memref.store %2, %dst[%i] : memref<?xf64>
+    scf.yield %2 : f64
+  }
+  return %0 : f64
+}
+
+// -----
+
+// CHECK-LABEL: func @test_scan_aliased
+//   CHECK-NOT:  numba.parallel_scan
+func.func @test_scan_aliased(%src: memref<?xi64>, %dst: memref<?xi64>, %init: i64) -> i64 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %n = memref.dim %src, %c0 : memref<?xi64>
+  %0 = scf.for %i = %c0 to %n step %c1 iter_args(%acc = %init) -> (i64) {
+    %1 = memref.load %src[%i] : memref<?xi64>
+    %2 = arith.addi %acc, %1 : i64
+    memref.store %2, %dst[%i] : memref<?xi64>
+    scf.yield %2 : i64
+  }
+  return %0 : i64
+}
+
+// -----
+
+// CHECK-LABEL: func @test_scan_invariant_index
+//   CHECK-NOT:  numba.parallel_scan
+func.func @test_scan_invariant_index(%src: memref<?xi64> {numba.restrict}, %dst: memref<?xi64> {numba.restrict}, %init: i64) -> i64 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %n = memref.dim %src, %c0 : memref<?xi64>
+  %0 = scf.for %i = %c0 to %n step %c1 iter_args(%acc = %init) -> (i64) {
+    %1 = memref.load %src[%i] : memref<?xi64>
+    %2 = arith.addi %acc, %1 : i64
+    memref.store %2, %dst[%c0] : memref<?xi64>
+    scf.yield %2 : i64
+  }
+  return %0 : i64
+}
@@ -0,0 +1,148 @@
+// RUN: numba-mlir-opt -allow-unregistered-dialect -pass-pipeline='builtin.module(numba-promote-to-stack)' --split-input-file %s | FileCheck %s
+
+// CHECK-LABEL: func @promote_static
+// CHECK-NEXT:  %[[M:.*]] = memref.alloca() {alignment = 32 : i64} : memref<3xf64>
+// CHECK-NOT:   memref.alloc
+// CHECK:       memref.store %{{.*}}, %[[M]][%{{.*}}] : memref<3xf64>
+// CHECK-NEXT:  %[[V:.*]] = memref.load %[[M]][%{{.*}}] : memref<3xf64>
+// CHECK-NOT:   memref.dealloc
+// CHECK:       return %[[V]]
+func.func @promote_static(%v: f64, %i: index) -> f64 {
+  %m = memref.alloc() : memref<3xf64>
+  memref.store %v, %m[%i] : memref<3xf64>
+  %v1 = memref.load %m[%i] : memref<3xf64>
+  memref.dealloc %m : memref<3xf64>
+  return %v1 : f64
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_from_loop
+// CHECK-NEXT:  %[[M:.*]] = memref.alloca() {alignment = 32 : i64} : memref<4xf32>
+// CHECK:       scf.for
+// CHECK-NEXT:    memref.store %{{.*}}, %[[M]][%{{.*}}] : memref<4xf32>
+// CHECK-NEXT:    memref.load %[[M]][%{{.*}}] : memref<4xf32>
+func.func @promote_from_loop(%v: f32) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  scf.for %i = %c0 to %c10 step %c1 {
+    %m = memref.alloc() : memref<4xf32>
+    memref.store %v, %m[%c0] : memref<4xf32>
+    %v1 = memref.load %m[%c0] : memref<4xf32>
+    "test.test"(%v1) : (f32) -> ()
+    memref.dealloc %m : memref<4xf32>
+  }
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_bounded
+// CHECK-SAME:  (%[[N:.*]]: index, %{{.*}}: f32)
+// CHECK-NEXT:  %[[M:.*]] = memref.alloca() {alignment = 32 : i64} : memref<8xf32>
+// CHECK:       %[[S:.*]] = arith.minsi %[[N]], %{{.*}} : index
+// CHECK-NEXT:  %[[R:.*]] = memref.reinterpret_cast %[[M]] to offset: [0], sizes: [%[[S]]], strides: [1] : memref<8xf32> to memref<?xf32>
+// CHECK-NEXT:  memref.store %{{.*}}, %[[R]][%{{.*}}] : memref<?xf32>
+func.func @promote_bounded(%n: index, %v: f32) -> f32 {
+  %c0 = arith.constant 0 : index
+  %c8 = arith.constant 8 : index
+  %s = arith.minsi %n, %c8 : index
+  %m = memref.alloc(%s) : memref<?xf32>
+  memref.store %v, %m[%c0] : memref<?xf32>
+  %v1 = memref.load %m[%c0] : memref<?xf32>
+  memref.dealloc %m : memref<?xf32>
+  return %v1 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_unbounded
+// CHECK:       memref.alloc(%{{.*}}) : memref<?xf32>
+// CHECK:       memref.dealloc
+func.func @no_promote_unbounded(%n: index, %v: f32) -> f32 {
+  %c0 = arith.constant 0 : index
+  %m = memref.alloc(%n) : memref<?xf32>
+  memref.store %v, %m[%c0] : memref<?xf32>
+  %v1 = memref.load %m[%c0] : memref<?xf32>
+  memref.dealloc %m : memref<?xf32>
+  return %v1 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_big
+// CHECK:       memref.alloc() : memref<1024xf32>
+// CHECK:       memref.dealloc
+func.func @no_promote_big(%v: f32, %i: index) -> f32 {
+  %m = memref.alloc() : memref<1024xf32>
+  memref.store %v, %m[%i] : memref<1024xf32>
+  %v1 = memref.load %m[%i] : memref<1024xf32>
+  memref.dealloc %m : memref<1024xf32>
+  return %v1 : f32
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_escaping
+// CHECK:       memref.alloc() : memref<3xf32>
+func.func @no_promote_escaping(%v: f32, %i: index) -> memref<3xf32> {
+  %m = memref.alloc() : memref<3xf32>
+  memref.store %v, %m[%i] : memref<3xf32>
+  return %m : memref<3xf32>
+}
+
+// -----
+
+// CHECK-LABEL: func @promote_parallel
+// CHECK:       "numba_util.parallel"
+// CHECK-NEXT:  ^bb0(%{{.*}}: index, %{{.*}}: index, %{{.*}}: index):
+// CHECK-NEXT:    %[[M:.*]] = memref.alloca() {alignment = 32 : i64} : memref<3xf32>
+// CHECK:         scf.for
+// CHECK-NEXT:      memref.store %{{.*}}, %[[M]][%{{.*}}] : memref<3xf32>
+func.func @promote_parallel(%v: f32) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c10 = arith.constant 10 : index
+  "numba_util.parallel"(%c0, %c10, %c1) ({
+  ^bb0(%lb: index, %ub: index, %tid: index):
+    scf.for %i = %lb to %ub step %c1 {
+      %m = memref.alloc() : memref<3xf32>
+      memref.store %v, %m[%c0] : memref<3xf32>
+      %v1 = memref.load %m[%c0] : memref<3xf32>
+      "test.test"(%v1) : (f32) -> ()
+      memref.dealloc %m : memref<3xf32>
+    }
+    "numba_util.yield"() : () -> ()
+  }) {operandSegmentSizes = array<i32: 1, 1, 1>} : (index, index, index) -> ()
+  return
+}
+
+// -----
+
+// CHECK-LABEL: func @no_promote_parallel_scan
+// CHECK:       numba_util.parallel_scan
+// CHECK:       memref.alloc() : memref<3xf32>
+// CHECK:       memref.dealloc
+func.func @no_promote_parallel_scan(%v: f32, %n: index) -> f32 {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %init = arith.constant 0.0 : f32
+  %res = numba_util.parallel_scan %c0 to %n step %c1 init(%init : f32) element {
+  ^bb0(%i: index):
+    "numba_util.yield"(%v) : (f32) -> ()
+  } combine {
+  ^bb0(%a: f32, %b: f32):
+    %s = arith.addf %a, %b : f32
+    "numba_util.yield"(%s) : (f32) -> ()
+  } body {
+  ^bb0(%i: index, %acc: f32):
+    %m = memref.alloc() : memref<3xf32>
+    memref.store %acc, %m[%c0] : memref<3xf32>
+    %v1 = memref.load %m[%c0] : memref<3xf32>
+    %s = arith.addf %v1, %v : f32
+    memref.dealloc %m : memref<3xf32>
+    "numba_util.yield"(%s) : (f32) -> ()
+  }
+  return %res : f32
+}
@@ -171,6 +171,28 @@ static mlir::PassPipelineRegistration<> memoryOpts(
     "numba-memory-opts", "Apply memory optimizations",
     [](mlir::OpPassManager &pm) { pm.addPass(numba::createMemoryOptPass()); });
 
+static mlir::PassPipelineRegistration<>
+    bufferReuse("numba-buffer-reuse",
+                "Hoist and reuse temporary buffers allocations",
+                [](mlir::OpPassManager &pm) {
+                  pm.addPass(numba::createBufferReusePass());
+                });
+
+static mlir::PassPipelineRegistration<>
+    promoteToStack("numba-promote-to-stack",
+                   "Promote small temporary allocations to stack",
+                   [](mlir::OpPassManager &pm) {
+                     pm.addPass(numba::createPromoteToStackPass());
+                   });
+
+static mlir::PassPipelineRegistration<>
+    markPoolAllocs("numba-mark-pool-allocs",
+                   "Mark non-escaping allocations to use pool allocator",
+                   [](mlir::OpPassManager &pm) {
+                     pm.addNestedPass<mlir::func::FuncOp>(
+                         numba::createMarkPoolAllocsPass());
+                   });
+
 static mlir::PassPipelineRegistration<> canonicalizeReductions(
     "numba-canonicalize-reductions",
     "Tries to promote loads/stores in scf.for to loop-carried variables",
@@ -5,6 +5,7 @@
 from .decorators import *
 
 from .mlir.settings import DPNP_AVAILABLE
+from .mlir.runtime import set_num_threads, get_num_threads
 
 from . import _version
 
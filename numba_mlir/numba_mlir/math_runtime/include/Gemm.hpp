@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <cstdint>
+
+/// Computes `c = alpha * a * b + beta * c`, where `a` is `m x k`, `b` is
+/// `k x n` and `c` is `m x n` matrix. Strides are in elements and can be
+/// arbitrary, including zero and negative. If `beta` is zero `c` is not read.
+///
+/// Used when math runtime is built without MKL.
+template <typename T>
+void nativeGemm(int64_t m, int64_t n, int64_t k, T alpha, const T *a,
+                int64_t rsA, int64_t csA, const T *b, int64_t rsB, int64_t csB,
+                T beta, T *c, int64_t rsC, int64_t csC);
+
+/// Computes `c[i] = alpha * a[i] * b[i] + beta * c[i]` for `batch` matrices,
+/// `bs*` are batch strides. Zero batch stride can be used to broadcast the
+/// same matrix.
+template <typename T>
+void nativeGemmBatch(int64_t batch, int64_t m, int64_t n, int64_t k, T alpha,
+                     const T *a, int64_t bsA, int64_t rsA, int64_t csA,
+                     const T *b, int64_t bsB, int64_t rsB, int64_t csB, T beta,
+                     T *c, int64_t bsC, int64_t rsC, int64_t csC);
+
+/// Computes `y = alpha * a * x + beta * y`, where `a` is `m x n` matrix.
+/// Transposed product can be computed by swapping `a` dims and strides. If
+/// `beta` is zero `y` is not read.
+template <typename T>
+void nativeGemv(int64_t m, int64_t n, T alpha, const T *a, int64_t rsA,
+                int64_t csA, const T *x, int64_t incX, T beta, T *y,
+                int64_t incY);
+
+#define GEMM_EXTERN_TEMPLATE(T)                                                \
+  extern template void nativeGemm<T>(int64_t, int64_t, int64_t, T, const T *,  \
+                                     int64_t, int64_t, const T *, int64_t,     \
+                                     int64_t, T, T *, int64_t, int64_t);       \
+  extern template void nativeGemmBatch<T>(                                     \
+      int64_t, int64_t, int64_t, int64_t, T, const T *, int64_t, int64_t,      \
+      int64_t, const T *, int64_t, int64_t, int64_t, T, T *, int64_t, int64_t, \
+      int64_t);                                                                \
+  extern template void nativeGemv<T>(int64_t, int64_t, T, const T *, int64_t,  \
+                                     int64_t, const T *, int64_t, T, T *,      \
+                                     int64_t);
+
+GEMM_EXTERN_TEMPLATE(float)
+GEMM_EXTERN_TEMPLATE(double)
+
+#undef GEMM_EXTERN_TEMPLATE
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <cstdint>
+
+using MathParallelRangeFptr = void (*)(int64_t begin, int64_t end, void *ctx);
+using MathParallelScanFptr = void (*)(int64_t begin, int64_t end,
+                                      const void *carry, void *total,
+                                      void *ctx);
+using MathScanCombineFptr = void (*)(void *acc, const void *val, void *ctx);
+
+/// Set `nmrtParallelFor` entry point from the core runtime, math runtime
+/// doesn't link to it directly.
+void setMathParallelFor(void *parallelFor);
+
+/// Set `nmrtParallelScan` entry point from the core runtime.
+void setMathParallelScan(void *parallelScan);
+
+/// Split [0, count) into chunks and run `func` on them using core runtime
+/// thread pool. Executes `func(0, count, ctx)` serially if parallel runtime
+/// wasn't provided.
+void mathParallelRange(int64_t count, MathParallelRangeFptr func, void *ctx);
+
+/// Computes inclusive scan over [0, count) using core runtime two-pass blocked
+/// scan, see `nmrtParallelScan` for callbacks semantics. Executes
+/// `scanFunc(0, count, nullptr, nullptr, ctx)` serially if parallel runtime
+/// wasn't provided.
+void mathParallelScan(int64_t count, int64_t elemSize,
+                      MathParallelScanFptr reduceFunc,
+                      MathParallelScanFptr scanFunc,
+                      MathScanCombineFptr combineFunc, void *ctx);
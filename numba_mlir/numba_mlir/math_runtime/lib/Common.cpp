@@ -2,15 +2,92 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <atomic>
+#include <cstddef>
+
 #include "Common.hpp"
+#include "Parallel.hpp"
 #include "numba-mlir-math-runtime_export.h"
 
+namespace {
+// Must be kept in sync with numba-mlir-runtime nmrtParallelFor.
+struct InputRange {
+  int64_t lower;
+  int64_t upper;
+  int64_t step;
+};
+
+struct Range {
+  int64_t lower;
+  int64_t upper;
+};
+
+using ParallelForFptr = void (*)(const Range *, size_t, void *);
+using ParallelForEntry = void (*)(const InputRange *, size_t, ParallelForFptr,
+                                  void *, int32_t, size_t);
+
+// Must be kept in sync with numba-mlir-runtime nmrtParallelScan.
+using ParallelScanEntry = void (*)(int64_t, int64_t, MathParallelScanFptr,
+                                   MathParallelScanFptr, MathScanCombineFptr,
+                                   void *);
+
+struct RangeContext {
+  MathParallelRangeFptr func;
+  void *ctx;
+};
+} // namespace
+
+static std::atomic<ParallelForEntry> parallelForEntry{nullptr};
+static std::atomic<ParallelScanEntry> parallelScanEntry{nullptr};
+
+void setMathParallelFor(void *parallelFor) {
+  parallelForEntry.store(reinterpret_cast<ParallelForEntry>(parallelFor),
+                         std::memory_order_release);
+}
+
+void setMathParallelScan(void *parallelScan) {
+  parallelScanEntry.store(reinterpret_cast<ParallelScanEntry>(parallelScan),
+                          std::memory_order_release);
+}
+
+void mathParallelRange(int64_t count, MathParallelRangeFptr func, void *ctx) {
+  auto entry = parallelForEntry.load(std::memory_order_acquire);
+  if (!entry || count <= 1) {
+    func(0, count, ctx);
+    return;
+  }
+
+  RangeContext rangeCtx{func, ctx};
+  auto body = [](const Range *ranges, size_t /*threadIndex*/, void *data) {
+    auto rangeCtx = static_cast<RangeContext *>(data);
+    rangeCtx->func(ranges[0].lower, ranges[0].upper, rangeCtx->ctx);
+  };
+  InputRange range{0, count, 1};
+  entry(&range, 1, body, &rangeCtx, /*scheduleKind*/ 0, /*grainSize*/ 1);
+}
+
+void mathParallelScan(int64_t count, int64_t elemSize,
+                      MathParallelScanFptr reduceFunc,
+                      MathParallelScanFptr scanFunc,
+                      MathScanCombineFptr combineFunc, void *ctx) {
+  auto entry = parallelScanEntry.load(std::memory_order_acquire);
+  if (!entry) {
+    scanFunc(0, count, nullptr, nullptr, ctx);
+    return;
+  }
+
+  entry(count, elemSize, reduceFunc, scanFunc, combineFunc, ctx);
+}
+
 extern "C" {
-NUMBA_MLIR_MATH_RUNTIME_EXPORT void nmrtMathRuntimeInit() {
-  // Nothing
+NUMBA_MLIR_MATH_RUNTIME_EXPORT void nmrtMathRuntimeInit(void *parallelFor,
+                                                        void *parallelScan) {
+  setMathParallelFor(parallelFor);
+  setMathParallelScan(parallelScan);
 }
 
 NUMBA_MLIR_MATH_RUNTIME_EXPORT void nmrtMathRuntimeFinalize() {
-  // Nothing
+  setMathParallelFor(nullptr);
+  setMathParallelScan(nullptr);
 }
 }
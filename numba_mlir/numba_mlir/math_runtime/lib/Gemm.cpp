@@ -0,0 +1,407 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "Gemm.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "Parallel.hpp"
+
+// Goto/BLIS style gemm: `c` is split into `kMC x kNC` tiles, processed in
+// parallel. For each `kKC` slice of the reduction dimension, tile operands are
+// packed into contiguous panels and multiplied by the `kMR x kNR`
+// register-blocked micro-kernel. Packing handles arbitrary strides, so the
+// micro-kernel only sees unit-stride data.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) &&         \
+    !defined(_WIN32) && !defined(__APPLE__)
+// Compile micro-kernel for several ISAs and dispatch at load time.
+#define NMRT_GEMM_KERNEL_ATTRS                                                 \
+  __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define NMRT_GEMM_KERNEL_ATTRS
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NMRT_GEMM_VECTOR_EXT
+#endif
+
+namespace {
+template <typename T> struct GemmParams;
+
+template <> struct GemmParams<float> {
+  static constexpr int64_t kMR = 4;
+  static constexpr int64_t kNR = 16;
+};
+
+template <> struct GemmParams<double> {
+  static constexpr int64_t kMR = 4;
+  static constexpr int64_t kNR = 8;
+};
+
+constexpr int64_t kMC = 96;
+constexpr int64_t kKC = 256;
+constexpr int64_t kNC = 256;
+
+// Don't bother with threading for small matrices.
+constexpr int64_t kMinParallelWork = 64 * 64 * 64;
+
+template <typename T> struct GemmArgs {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  T alpha;
+  const T *a;
+  int64_t rsA;
+  int64_t csA;
+  const T *b;
+  int64_t rsB;
+  int64_t csB;
+  T beta;
+  T *c;
+  int64_t rsC;
+  int64_t csC;
+};
+
+/// Pack `mc x kc` block of `a` into `kMR` rows panels, padded with zeros.
+template <typename T>
+static void packA(const GemmArgs<T> &args, int64_t ic, int64_t pc, int64_t mc,
+                  int64_t kc, T *dst) {
+  constexpr auto MR = GemmParams<T>::kMR;
+  for (int64_t ir = 0; ir < mc; ir += MR) {
+    auto mr = std::min(MR, mc - ir);
+    auto src = args.a + (ic + ir) * args.rsA + pc * args.csA;
+    for (int64_t p = 0; p < kc; ++p) {
+      for (int64_t i = 0; i < mr; ++i)
+        dst[i] = src[i * args.rsA + p * args.csA];
+
+      for (int64_t i = mr; i < MR; ++i)
+        dst[i] = T(0);
+
+      dst += MR;
+    }
+  }
+}
+
+/// Pack `kc x nc` block of `b` into `kNR` columns panels, padded with zeros.
+template <typename T>
+static void packB(const GemmArgs<T> &args, int64_t pc, int64_t jc, int64_t kc,
+                  int64_t nc, T *dst) {
+  constexpr auto NR = GemmParams<T>::kNR;
+  for (int64_t jr = 0; jr < nc; jr += NR) {
+    auto nr = std::min(NR, nc - jr);
+    auto src = args.b + pc * args.rsB + (jc + jr) * args.csB;
+    for (int64_t p = 0; p < kc; ++p) {
+      auto row = src + p * args.rsB;
+      if (args.csB == 1 && nr == NR) {
+        std::copy(row, row + NR, dst);
+      } else {
+        for (int64_t j = 0; j < nr; ++j)
+          dst[j] = row[j * args.csB];
+
+        for (int64_t j = nr; j < NR; ++j)
+          dst[j] = T(0);
+      }
+      dst += NR;
+    }
+  }
+}
+
+/// `acc = a * b` for packed `kMR x kc` and `kc x kNR` panels.
+template <typename T>
+NMRT_GEMM_KERNEL_ATTRS static void
+microKernel(int64_t kc, const T *__restrict a, const T *__restrict b,
+            T *__restrict acc) {
+  constexpr auto MR = GemmParams<T>::kMR;
+  constexpr auto NR = GemmParams<T>::kNR;
+#ifdef NMRT_GEMM_VECTOR_EXT
+  // Autovectorizer is not reliable enough at keeping accumulators in
+  // registers, use explicit vectors of the full panel width.
+  typedef T Vec __attribute__((vector_size(NR * sizeof(T))));
+  Vec res[MR] = {};
+  for (int64_t p = 0; p < kc; ++p) {
+    Vec bv;
+    memcpy(&bv, b, sizeof(bv));
+    for (int64_t i = 0; i < MR; ++i)
+      res[i] += a[i] * bv;
+
+    a += MR;
+    b += NR;
+  }
+
+  for (int64_t i = 0; i < MR; ++i)
+    memcpy(acc + i * NR, &res[i], sizeof(Vec));
+#else
+  T res[MR][NR] = {};
+  for (int64_t p = 0; p < kc; ++p) {
+    for (int64_t i = 0; i < MR; ++i) {
+      auto av = a[i];
+      for (int64_t j = 0; j < NR; ++j)
+        res[i][j] += av * b[j];
+    }
+    a += MR;
+    b += NR;
+  }
+
+  for (int64_t i = 0; i < MR; ++i)
+    for (int64_t j = 0; j < NR; ++j)
+      acc[i * NR + j] = res[i][j];
+#endif
+}
+
+/// Store `mr x nr` part of the accumulator to `c`. First reduction slice
+/// applies `beta`, subsequent ones accumulate.
+template <typename T>
+static void storeTile(const GemmArgs<T> &args, const T *acc, int64_t i0,
+                      int64_t j0, int64_t mr, int64_t nr, bool first) {
+  constexpr auto NR = GemmParams<T>::kNR;
+  auto alpha = args.alpha;
+  auto beta = first ? args.beta : T(1);
+  for (int64_t i = 0; i < mr; ++i) {
+    auto dst = args.c + (i0 + i) * args.rsC + j0 * args.csC;
+    auto src = acc + i * NR;
+    if (beta == T(0)) {
+      for (int64_t j = 0; j < nr; ++j)
+        dst[j * args.csC] = alpha * src[j];
+    } else {
+      for (int64_t j = 0; j < nr; ++j)
+        dst[j * args.csC] = alpha * src[j] + beta * dst[j * args.csC];
+    }
+  }
+}
+
+template <typename T> struct PackBuffers {
+  std::vector<T> a;
+  std::vector<T> b;
+};
+
+template <typename T> static PackBuffers<T> &getPackBuffers() {
+  static thread_local PackBuffers<T> buffers;
+  return buffers;
+}
+
+template <typename T>
+static void computeTile(const GemmArgs<T> &args, int64_t ic, int64_t jc) {
+  constexpr auto MR = GemmParams<T>::kMR;
+  constexpr auto NR = GemmParams<T>::kNR;
+  auto mc = std::min(kMC, args.m - ic);
+  auto nc = std::min(kNC, args.n - jc);
+
+  auto &buffers = getPackBuffers<T>();
+  buffers.a.resize(static_cast<size_t>(kMC * kKC));
+  buffers.b.resize(static_cast<size_t>(kKC * kNC));
+  auto packedA = buffers.a.data();
+  auto packedB = buffers.b.data();
+
+  T acc[MR * NR];
+  for (int64_t pc = 0; pc < args.k; pc += kKC) {
+    auto kc = std::min(kKC, args.k - pc);
+    packA(args, ic, pc, mc, kc, packedA);
+    packB(args, pc, jc, kc, nc, packedB);
+    for (int64_t jr = 0; jr < nc; jr += NR) {
+      auto nr = std::min(NR, nc - jr);
+      auto panelB = packedB + jr * kc;
+      for (int64_t ir = 0; ir < mc; ir += MR) {
+        auto mr = std::min(MR, mc - ir);
+        microKernel(kc, packedA + ir * kc, panelB, acc);
+        storeTile(args, acc, ic + ir, jc + jr, mr, nr, pc == 0);
+      }
+    }
+  }
+}
+
+template <typename T> static void scaleC(const GemmArgs<T> &args) {
+  for (int64_t i = 0; i < args.m; ++i) {
+    for (int64_t j = 0; j < args.n; ++j) {
+      auto &val = args.c[i * args.rsC + j * args.csC];
+      val = (args.beta == T(0) ? T(0) : args.beta * val);
+    }
+  }
+}
+
+template <typename T> static void gemmImpl(GemmArgs<T> args, bool parallel) {
+  if (args.m <= 0 || args.n <= 0)
+    return;
+
+  if (args.k <= 0 || args.alpha == T(0)) {
+    scaleC(args);
+    return;
+  }
+
+  auto tilesM = (args.m + kMC - 1) / kMC;
+  auto tilesN = (args.n + kNC - 1) / kNC;
+  auto body = [](int64_t begin, int64_t end, void *ctx) {
+    auto &args = *static_cast<const GemmArgs<T> *>(ctx);
+    auto tilesN = (args.n + kNC - 1) / kNC;
+    for (auto tile = begin; tile < end; ++tile)
+      computeTile(args, (tile / tilesN) * kMC, (tile % tilesN) * kNC);
+  };
+
+  auto numTiles = tilesM * tilesN;
+  if (!parallel || numTiles == 1 ||
+      args.m * args.n * args.k < kMinParallelWork) {
+    body(0, numTiles, &args);
+  } else {
+    mathParallelRange(numTiles, body, &args);
+  }
+}
+
+constexpr int64_t kGemvRows = 64;
+constexpr int64_t kGemvParallelWork = 64 * 1024;
+
+template <typename T> struct GemvArgs {
+  int64_t m;
+  int64_t n;
+  T alpha;
+  const T *a;
+  int64_t rsA;
+  int64_t csA;
+  const T *x;
+  int64_t incX;
+  T beta;
+  T *y;
+  int64_t incY;
+};
+
+/// Dot product of `n` elements, with several independent accumulators so
+/// compiler can vectorize it without reassociating.
+template <typename T> static T dotUnit(int64_t n, const T *a, const T *x) {
+  constexpr int64_t kLanes = 8;
+  T part[kLanes] = {};
+  int64_t j = 0;
+  for (; j + kLanes <= n; j += kLanes)
+    for (int64_t l = 0; l < kLanes; ++l)
+      part[l] += a[j + l] * x[j + l];
+
+  T res = 0;
+  for (; j < n; ++j)
+    res += a[j] * x[j];
+
+  for (int64_t l = 0; l < kLanes; ++l)
+    res += part[l];
+
+  return res;
+}
+
+/// Compute `kGemvRows` block of `y` starting from `i0`.
+template <typename T>
+static void gemvBlock(const GemvArgs<T> &args, int64_t i0) {
+  auto rows = std::min(kGemvRows, args.m - i0);
+  T acc[kGemvRows] = {};
+  if (args.csA == 1 && args.incX == 1) {
+    for (int64_t i = 0; i < rows; ++i)
+      acc[i] = dotUnit(args.n, args.a + (i0 + i) * args.rsA, args.x);
+  } else {
+    // Column-wise accumulation, contiguous for column-major `a`.
+    for (int64_t j = 0; j < args.n; ++j) {
+      auto xv = args.x[j * args.incX];
+      auto col = args.a + i0 * args.rsA + j * args.csA;
+      for (int64_t i = 0; i < rows; ++i)
+        acc[i] += col[i * args.rsA] * xv;
+    }
+  }
+
+  for (int64_t i = 0; i < rows; ++i) {
+    auto &dst = args.y[(i0 + i) * args.incY];
+    dst = args.alpha * acc[i] + (args.beta == T(0) ? T(0) : args.beta * dst);
+  }
+}
+} // namespace
+
+template <typename T>
+void nativeGemm(int64_t m, int64_t n, int64_t k, T alpha, const T *a,
+                int64_t rsA, int64_t csA, const T *b, int64_t rsB, int64_t csB,
+                T beta, T *c, int64_t rsC, int64_t csC) {
+  GemmArgs<T> args{m, n, k, alpha, a, rsA, csA, b, rsB, csB, beta, c, rsC, csC};
+  gemmImpl(args, /*parallel*/ true);
+}
+
+template <typename T>
+void nativeGemmBatch(int64_t batch, int64_t m, int64_t n, int64_t k, T alpha,
+                     const T *a, int64_t bsA, int64_t rsA, int64_t csA,
+                     const T *b, int64_t bsB, int64_t rsB, int64_t csB, T beta,
+                     T *c, int64_t bsC, int64_t rsC, int64_t csC) {
+  if (batch <= 0)
+    return;
+
+  struct BatchArgs {
+    GemmArgs<T> args;
+    int64_t bsA;
+    int64_t bsB;
+    int64_t bsC;
+
+    GemmArgs<T> get(int64_t i) const {
+      auto ret = args;
+      ret.a += i * bsA;
+      ret.b += i * bsB;
+      ret.c += i * bsC;
+      return ret;
+    }
+  };
+  BatchArgs batchArgs{
+      {m, n, k, alpha, a, rsA, csA, b, rsB, csB, beta, c, rsC, csC},
+      bsA,
+      bsB,
+      bsC};
+
+  // Large matrices are parallelized internally, many small ones are
+  // distributed between threads whole.
+  if (batch == 1 || m * n * k >= kMinParallelWork) {
+    for (int64_t i = 0; i < batch; ++i)
+      gemmImpl(batchArgs.get(i), /*parallel*/ true);
+
+    return;
+  }
+
+  auto body = [](int64_t begin, int64_t end, void *ctx) {
+    auto &batchArgs = *static_cast<const BatchArgs *>(ctx);
+    for (auto i = begin; i < end; ++i)
+      gemmImpl(batchArgs.get(i), /*parallel*/ false);
+  };
+  if (batch * m * n * k < kMinParallelWork) {
+    body(0, batch, &batchArgs);
+  } else {
+    mathParallelRange(batch, body, &batchArgs);
+  }
+}
+
+template <typename T>
+void nativeGemv(int64_t m, int64_t n, T alpha, const T *a, int64_t rsA,
+                int64_t csA, const T *x, int64_t incX, T beta, T *y,
+                int64_t incY) {
+  if (m <= 0)
+    return;
+
+  GemvArgs<T> args{m, n, alpha, a, rsA, csA, x, incX, beta, y, incY};
+  auto body = [](int64_t begin, int64_t end, void *ctx) {
+    auto &args = *static_cast<const GemvArgs<T> *>(ctx);
+    for (auto block = begin; block < end; ++block)
+      gemvBlock(args, block * kGemvRows);
+  };
+
+  auto numBlocks = (m + kGemvRows - 1) / kGemvRows;
+  if (numBlocks == 1 || m * n < kGemvParallelWork) {
+    body(0, numBlocks, &args);
+  } else {
+    mathParallelRange(numBlocks, body, &args);
+  }
+}
+
+#define GEMM_INSTANTIATE(T)                                                    \
+  template void nativeGemm<T>(int64_t, int64_t, int64_t, T, const T *,         \
+                              int64_t, int64_t, const T *, int64_t, int64_t,   \
+                              T, T *, int64_t, int64_t);                       \
+  template void nativeGemmBatch<T>(                                            \
+      int64_t, int64_t, int64_t, int64_t, T, const T *, int64_t, int64_t,      \
+      int64_t, const T *, int64_t, int64_t, int64_t, T, T *, int64_t, int64_t, \
+      int64_t);                                                                \
+  template void nativeGemv<T>(int64_t, int64_t, T, const T *, int64_t,         \
+                              int64_t, const T *, int64_t, T, T *, int64_t);
+
+GEMM_INSTANTIATE(float)
+GEMM_INSTANTIATE(double)
+
+#undef GEMM_INSTANTIATE
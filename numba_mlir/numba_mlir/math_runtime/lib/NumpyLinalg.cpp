@@ -2,10 +2,14 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <algorithm>
+#include <cstdint>
 #include <stdio.h>
 #include <string_view>
+#include <utility>
 
 #include "Common.hpp"
+#include "Gemm.hpp"
 #include "numba-mlir-math-runtime_export.h"
 
 #ifdef NUMBA_MLIR_USE_DPNP
@@ -112,6 +116,182 @@ static void cpuGemm(GemmFunc<T> Gemm, const Memref<2, T> *a,
 }
 
 #endif
+
+// Memref dims and strides are stored unsigned, but strides can be negative.
+template <size_t N, typename T>
+static int64_t getDim(const Memref<N, T> *arr, size_t dim) {
+  return static_cast<int64_t>(arr->dims[dim]);
+}
+
+template <size_t N, typename T>
+static int64_t getStride(const Memref<N, T> *arr, size_t dim) {
+  return static_cast<int64_t>(arr->strides[dim]);
+}
+
+template <typename T>
+static void nativeGemmImpl(const Memref<2, T> *a, const Memref<2, T> *b,
+                           Memref<2, T> *c, T alpha, T beta) {
+  auto m = getDim(a, 0);
+  auto n = getDim(b, 1);
+  auto k = getDim(a, 1);
+  nativeGemm(m, n, k, alpha, getMemrefData(a), getStride(a, 0),
+             getStride(a, 1), getMemrefData(b), getStride(b, 0),
+             getStride(b, 1), beta, getMemrefData(c), getStride(c, 0),
+             getStride(c, 1));
+}
+
+#ifdef NUMBA_MLIR_USE_MKL
+/// Checks if matrix can be passed to BLAS directly, returns its layout and
+/// leading dimension.
+static bool getBlasLayout(int64_t rows, int64_t cols, int64_t rs, int64_t cs,
+                          bool &rowMajor, MKL_INT &ld) {
+  if (cs == 1 && rs >= std::max<int64_t>(cols, 1)) {
+    rowMajor = true;
+    ld = static_cast<MKL_INT>(rs);
+    return true;
+  }
+  if (rs == 1 && cs >= std::max<int64_t>(rows, 1)) {
+    rowMajor = false;
+    ld = static_cast<MKL_INT>(cs);
+    return true;
+  }
+  return false;
+}
+
+static void mklGemv(const CBLAS_LAYOUT layout, MKL_INT m, MKL_INT n,
+                    float alpha, const float *a, MKL_INT lda, const float *x,
+                    MKL_INT incX, float beta, float *y, MKL_INT incY) {
+  cblas_sgemv(layout, CblasNoTrans, m, n, alpha, a, lda, x, incX, beta, y,
+              incY);
+}
+
+static void mklGemv(const CBLAS_LAYOUT layout, MKL_INT m, MKL_INT n,
+                    double alpha, const double *a, MKL_INT lda,
+                    const double *x, MKL_INT incX, double beta, double *y,
+                    MKL_INT incY) {
+  cblas_dgemv(layout, CblasNoTrans, m, n, alpha, a, lda, x, incX, beta, y,
+              incY);
+}
+
+static void mklGemmBatch(const CBLAS_LAYOUT layout,
+                         const CBLAS_TRANSPOSE transA,
+                         const CBLAS_TRANSPOSE transB, MKL_INT m, MKL_INT n,
+                         MKL_INT k, float alpha, const float *a, MKL_INT lda,
+                         MKL_INT bsA, const float *b, MKL_INT ldb, MKL_INT bsB,
+                         float beta, float *c, MKL_INT ldc, MKL_INT bsC,
+                         MKL_INT batch) {
+  cblas_sgemm_batch_strided(layout, transA, transB, m, n, k, alpha, a, lda,
+                            bsA, b, ldb, bsB, beta, c, ldc, bsC, batch);
+}
+
+static void mklGemmBatch(const CBLAS_LAYOUT layout,
+                         const CBLAS_TRANSPOSE transA,
+                         const CBLAS_TRANSPOSE transB, MKL_INT m, MKL_INT n,
+                         MKL_INT k, double alpha, const double *a, MKL_INT lda,
+                         MKL_INT bsA, const double *b, MKL_INT ldb,
+                         MKL_INT bsB, double beta, double *c, MKL_INT ldc,
+                         MKL_INT bsC, MKL_INT batch) {
+  cblas_dgemm_batch_strided(layout, transA, transB, m, n, k, alpha, a, lda,
+                            bsA, b, ldb, bsB, beta, c, ldc, bsC, batch);
+}
+#endif
+
+template <typename T>
+static void gemvImpl(const Memref<2, T> *a, const Memref<1, T> *x,
+                     int32_t trans, T alpha, T beta, Memref<1, T> *y) {
+  auto m = getDim(a, 0);
+  auto n = getDim(a, 1);
+  auto rsA = getStride(a, 0);
+  auto csA = getStride(a, 1);
+  if (trans) {
+    std::swap(m, n);
+    std::swap(rsA, csA);
+  }
+
+  if (getDim(x, 0) != n || getDim(y, 0) != m)
+    fatal_failure("gemv: incompatible shapes (%d, %d), (%d) and (%d)\n",
+                  int(m), int(n), int(getDim(x, 0)), int(getDim(y, 0)));
+
+  auto aData = getMemrefData(a);
+  auto xData = getMemrefData(x);
+  auto yData = getMemrefData(y);
+  auto incX = getStride(x, 0);
+  auto incY = getStride(y, 0);
+
+#ifdef NUMBA_MLIR_USE_MKL
+  bool rowMajor;
+  MKL_INT lda;
+  if (m > 0 && n > 0 && incX > 0 && incY > 0 &&
+      getBlasLayout(m, n, rsA, csA, rowMajor, lda)) {
+    mklGemv(rowMajor ? CblasRowMajor : CblasColMajor, static_cast<MKL_INT>(m),
+            static_cast<MKL_INT>(n), alpha, aData, lda, xData,
+            static_cast<MKL_INT>(incX), beta, yData,
+            static_cast<MKL_INT>(incY));
+    return;
+  }
+#endif
+
+  nativeGemv(m, n, alpha, aData, rsA, csA, xData, incX, beta, yData, incY);
+}
+
+template <typename T>
+static void gemmBatchImpl(const Memref<3, T> *a, const Memref<3, T> *b,
+                          T alpha, T beta, Memref<3, T> *c) {
+  auto batch = getDim(c, 0);
+  auto m = getDim(a, 1);
+  auto n = getDim(b, 2);
+  auto k = getDim(a, 2);
+  if (getDim(b, 1) != k || getDim(c, 1) != m || getDim(c, 2) != n)
+    fatal_failure("gemm_batch: incompatible shapes (%d, %d), (%d, %d) and "
+                  "(%d, %d)\n",
+                  int(m), int(k), int(getDim(b, 1)), int(n), int(getDim(c, 1)),
+                  int(getDim(c, 2)));
+
+  // Batch of size 1 is broadcasted.
+  auto getBatchStride = [&](const Memref<3, T> *arr, char arrName) {
+    auto size = getDim(arr, 0);
+    if (size == 1)
+      return int64_t(0);
+
+    if (size != batch)
+      fatal_failure("gemm_batch: '%c' batch size %d doesn't match %d\n",
+                    arrName, int(size), int(batch));
+
+    return getStride(arr, 0);
+  };
+  auto bsA = getBatchStride(a, 'a');
+  auto bsB = getBatchStride(b, 'b');
+  auto bsC = getStride(c, 0);
+
+  auto aData = getMemrefData(a);
+  auto bData = getMemrefData(b);
+  auto cData = getMemrefData(c);
+
+#ifdef NUMBA_MLIR_USE_MKL
+  bool rowA, rowB, rowC;
+  MKL_INT lda, ldb, ldc;
+  if (batch > 1 && m > 0 && n > 0 && k > 0 && bsC > 0 && bsA >= 0 &&
+      bsB >= 0 &&
+      getBlasLayout(m, k, getStride(a, 1), getStride(a, 2), rowA, lda) &&
+      getBlasLayout(k, n, getStride(b, 1), getStride(b, 2), rowB, ldb) &&
+      getBlasLayout(m, n, getStride(c, 1), getStride(c, 2), rowC, ldc)) {
+    mklGemmBatch(rowC ? CblasRowMajor : CblasColMajor,
+                 rowA == rowC ? CblasNoTrans : CblasTrans,
+                 rowB == rowC ? CblasNoTrans : CblasTrans,
+                 static_cast<MKL_INT>(m), static_cast<MKL_INT>(n),
+                 static_cast<MKL_INT>(k), alpha, aData, lda,
+                 static_cast<MKL_INT>(bsA), bData, ldb,
+                 static_cast<MKL_INT>(bsB), beta, cData, ldc,
+                 static_cast<MKL_INT>(bsC), static_cast<MKL_INT>(batch));
+    return;
+  }
+#endif
+
+  nativeGemmBatch(batch, m, n, k, alpha, aData, bsA, getStride(a, 1),
+                  getStride(a, 2), bData, bsB, getStride(b, 1),
+                  getStride(b, 2), beta, cData, bsC, getStride(c, 1),
+                  getStride(c, 2));
+}
 } // namespace
 
 extern "C" {
@@ -150,4 +330,42 @@ GEMM_VARIANT(double, d, float64)
 
 #undef GEMM_VARIANT
 #undef MKL_CALL
+
+#define NATIVE_GEMM_VARIANT(T, Suff)                                           \
+  NUMBA_MLIR_MATH_RUNTIME_EXPORT void native_gemm_##Suff(                      \
+      const Memref<2, T> *a, const Memref<2, T> *b, T alpha, T beta,           \
+      Memref<2, T> *c) {                                                       \
+    nativeGemmImpl<T>(a, b, c, alpha, beta);                                   \
+  }
+
+NATIVE_GEMM_VARIANT(float, float32)
+NATIVE_GEMM_VARIANT(double, float64)
+
+#undef NATIVE_GEMM_VARIANT
+
+// BLAS-like entry points, use MKL if available and operands layout allows it,
+// native implementation otherwise.
+#define GEMV_VARIANT(T, Suff)                                                  \
+  NUMBA_MLIR_MATH_RUNTIME_EXPORT void linalg_gemv_##Suff(                      \
+      const Memref<2, T> *a, const Memref<1, T> *x, int32_t trans, T alpha,    \
+      T beta, Memref<1, T> *y) {                                               \
+    gemvImpl<T>(a, x, trans, alpha, beta, y);                                  \
+  }
+
+GEMV_VARIANT(float, float32)
+GEMV_VARIANT(double, float64)
+
+#undef GEMV_VARIANT
+
+#define GEMM_BATCH_VARIANT(T, Suff)                                            \
+  NUMBA_MLIR_MATH_RUNTIME_EXPORT void linalg_gemm_batch_##Suff(                \
+      const Memref<3, T> *a, const Memref<3, T> *b, T alpha, T beta,           \
+      Memref<3, T> *c) {                                                       \
+    gemmBatchImpl<T>(a, b, alpha, beta, c);                                    \
+  }
+
+GEMM_BATCH_VARIANT(float, float32)
+GEMM_BATCH_VARIANT(double, float64)
+
+#undef GEMM_BATCH_VARIANT
 }
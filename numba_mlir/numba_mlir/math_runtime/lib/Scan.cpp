@@ -0,0 +1,168 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstdint>
+
+#include "Common.hpp"
+#include "Parallel.hpp"
+#include "numba-mlir-math-runtime_export.h"
+
+// Scans are computed along the middle dimension of `outer x len x inner`
+// arrays, so any scan axis can be passed by reshaping the source array.
+// Scanned element is a row of `inner` values, which allows to vectorize the
+// innermost loop. If there are enough independent rows they are processed in
+// parallel, otherwise each row is scanned using core runtime parallel scan.
+
+namespace {
+constexpr int64_t kMinParallelWork = 64 * 1024;
+constexpr int64_t kMinParallelRows = 8;
+
+struct SumOp {
+  template <typename T> static T apply(T a, T b) { return a + b; }
+};
+
+struct ProdOp {
+  template <typename T> static T apply(T a, T b) { return a * b; }
+};
+
+template <typename T> struct ScanArgs {
+  const T *src;
+  int64_t srcStride;
+  int64_t srcInnerStride;
+  T *dst;
+  int64_t dstStride;
+  int64_t dstInnerStride;
+  int64_t inner;
+};
+
+template <typename Op, typename T>
+static void scanReduce(int64_t begin, int64_t end, const void * /*carry*/,
+                       void *total, void *ctx) {
+  auto &args = *static_cast<const ScanArgs<T> *>(ctx);
+  auto res = static_cast<T *>(total);
+  for (int64_t k = 0; k < args.inner; ++k)
+    res[k] = args.src[begin * args.srcStride + k * args.srcInnerStride];
+
+  for (auto i = begin + 1; i < end; ++i) {
+    auto src = args.src + i * args.srcStride;
+    for (int64_t k = 0; k < args.inner; ++k)
+      res[k] = Op::apply(res[k], src[k * args.srcInnerStride]);
+  }
+}
+
+template <typename Op, typename T>
+static void scanBlock(int64_t begin, int64_t end, const void *carry,
+                      void *total, void *ctx) {
+  auto &args = *static_cast<const ScanArgs<T> *>(ctx);
+  auto first = args.dst + begin * args.dstStride;
+  auto firstSrc = args.src + begin * args.srcStride;
+  auto carryData = static_cast<const T *>(carry);
+  for (int64_t k = 0; k < args.inner; ++k) {
+    auto val = firstSrc[k * args.srcInnerStride];
+    first[k * args.dstInnerStride] =
+        (carryData ? Op::apply(carryData[k], val) : val);
+  }
+
+  for (auto i = begin + 1; i < end; ++i) {
+    auto prev = args.dst + (i - 1) * args.dstStride;
+    auto dst = args.dst + i * args.dstStride;
+    auto src = args.src + i * args.srcStride;
+    for (int64_t k = 0; k < args.inner; ++k)
+      dst[k * args.dstInnerStride] = Op::apply(prev[k * args.dstInnerStride],
+                                               src[k * args.srcInnerStride]);
+  }
+
+  if (total) {
+    auto last = args.dst + (end - 1) * args.dstStride;
+    auto res = static_cast<T *>(total);
+    for (int64_t k = 0; k < args.inner; ++k)
+      res[k] = last[k * args.dstInnerStride];
+  }
+}
+
+template <typename Op, typename T>
+static void scanCombine(void *acc, const void *val, void *ctx) {
+  auto &args = *static_cast<const ScanArgs<T> *>(ctx);
+  auto accData = static_cast<T *>(acc);
+  auto valData = static_cast<const T *>(val);
+  for (int64_t k = 0; k < args.inner; ++k)
+    accData[k] = Op::apply(accData[k], valData[k]);
+}
+
+template <typename T> struct ScanRowsArgs {
+  const Memref<3, const T> *src;
+  Memref<3, T> *dst;
+};
+
+template <typename T>
+static ScanArgs<T> getRowArgs(const Memref<3, const T> *src, Memref<3, T> *dst,
+                              int64_t row) {
+  auto srcStrides = src->strides;
+  auto dstStrides = dst->strides;
+  auto srcData = getMemrefData(src) + row * static_cast<int64_t>(srcStrides[0]);
+  auto dstData = getMemrefData(dst) + row * static_cast<int64_t>(dstStrides[0]);
+  return ScanArgs<T>{srcData,
+                     static_cast<int64_t>(srcStrides[1]),
+                     static_cast<int64_t>(srcStrides[2]),
+                     dstData,
+                     static_cast<int64_t>(dstStrides[1]),
+                     static_cast<int64_t>(dstStrides[2]),
+                     static_cast<int64_t>(src->dims[2])};
+}
+
+template <typename Op, typename T>
+static void scanImpl(const Memref<3, const T> *src, Memref<3, T> *dst) {
+  auto outer = static_cast<int64_t>(src->dims[0]);
+  auto len = static_cast<int64_t>(src->dims[1]);
+  auto inner = static_cast<int64_t>(src->dims[2]);
+  if (outer <= 0 || len <= 0 || inner <= 0)
+    return;
+
+  auto work = outer * len * inner;
+  if (outer < kMinParallelRows && work >= kMinParallelWork) {
+    for (int64_t row = 0; row < outer; ++row) {
+      auto args = getRowArgs(src, dst, row);
+      mathParallelScan(len, inner * static_cast<int64_t>(sizeof(T)),
+                       &scanReduce<Op, T>, &scanBlock<Op, T>,
+                       &scanCombine<Op, T>, &args);
+    }
+    return;
+  }
+
+  ScanRowsArgs<T> rowsArgs{src, dst};
+  auto body = [](int64_t begin, int64_t end, void *ctx) {
+    auto &rowsArgs = *static_cast<const ScanRowsArgs<T> *>(ctx);
+    auto len = static_cast<int64_t>(rowsArgs.src->dims[1]);
+    for (auto row = begin; row < end; ++row) {
+      auto args = getRowArgs(rowsArgs.src, rowsArgs.dst, row);
+      scanBlock<Op, T>(0, len, nullptr, nullptr, &args);
+    }
+  };
+
+  if (work < kMinParallelWork) {
+    body(0, outer, &rowsArgs);
+  } else {
+    mathParallelRange(outer, body, &rowsArgs);
+  }
+}
+} // namespace
+
+extern "C" {
+
+#define SCAN_VARIANT(T, Suff)                                                  \
+  NUMBA_MLIR_MATH_RUNTIME_EXPORT void numpy_cumsum_##Suff(                     \
+      const Memref<3, const T> *src, Memref<3, T> *dst) {                      \
+    scanImpl<SumOp, T>(src, dst);                                              \
+  }                                                                            \
+  NUMBA_MLIR_MATH_RUNTIME_EXPORT void numpy_cumprod_##Suff(                    \
+      const Memref<3, const T> *src, Memref<3, T> *dst) {                      \
+    scanImpl<ProdOp, T>(src, dst);                                             \
+  }
+
+SCAN_VARIANT(int64_t, int64)
+SCAN_VARIANT(float, float32)
+SCAN_VARIANT(double, float64)
+
+#undef SCAN_VARIANT
+}
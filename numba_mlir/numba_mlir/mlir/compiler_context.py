@@ -2,7 +2,20 @@
 #
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-from .settings import DEBUG_TYPE, DUMP_LLVM, DUMP_OPTIMIZED, DUMP_ASSEMBLY
+from .settings import (
+    DEBUG_TYPE,
+    DUMP_LLVM,
+    DUMP_OPTIMIZED,
+    DUMP_ASSEMBLY,
+    OBJECT_CACHE_DIR,
+    OBJECT_CACHE_MAX_SIZE_MB,
+    OBJECT_CACHE_PRUNE_INTERVAL,
+    OBJECT_CACHE_EXPIRATION_DAYS,
+    LAZY_COMPILATION,
+    JIT_COMPILE_THREADS,
+    TIERED_COMPILATION,
+    TIER_UP_THRESHOLD,
+)
 from .. import mlir_compiler
 
 
@@ -18,6 +31,14 @@ def _init_compiler():
     settings["llvm_printer"] = _get_printer(DUMP_LLVM)
     settings["optimized_printer"] = _get_printer(DUMP_OPTIMIZED)
     settings["asm_printer"] = _get_printer(DUMP_ASSEMBLY)
+    settings["object_cache_dir"] = OBJECT_CACHE_DIR if OBJECT_CACHE_DIR else None
+    settings["object_cache_max_size"] = OBJECT_CACHE_MAX_SIZE_MB * 1024 * 1024
+    settings["object_cache_prune_interval"] = OBJECT_CACHE_PRUNE_INTERVAL
+    settings["object_cache_expiration"] = OBJECT_CACHE_EXPIRATION_DAYS * 24 * 3600
+    settings["lazy_compilation"] = bool(LAZY_COMPILATION)
+    settings["jit_compile_threads"] = JIT_COMPILE_THREADS
+    settings["tiered_compilation"] = bool(TIERED_COMPILATION)
+    settings["tier_up_threshold"] = TIER_UP_THRESHOLD
     return mlir_compiler.init_compiler(settings)
 
 
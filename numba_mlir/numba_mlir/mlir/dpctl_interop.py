@@ -28,6 +28,7 @@ except ImportError:
     _is_dpctl_available = False
 
 if _is_dpctl_available:
+    import ctypes
     import numba
     import numpy as np
     from llvmlite import ir
@@ -212,10 +213,42 @@ if _is_dpctl_available:
         assert pyapi.context.enable_nrt
         fnty = ir.FunctionType(ir.IntType(32), [pyapi.pyobj, pyapi.voidptr])
         fn = pyapi._get_function(fnty, name="nmrtUnboxSyclInterface")
-        fn.args[0].add_attribute("nocapture")
+        # Array object is captured by the meminfo.
         fn.args[1].add_attribute("nocapture")
         return pyapi.builder.call(fn, (ary, ptr))
 
+    def _register_usm_array_api():
+        # Allow runtime to read usm_ndarray fields directly instead of parsing
+        # __sycl_usm_array_interface__ dict on each call.
+        from dpctl.tensor import _usmarray
+        from .python_rt import runtime_lib
+
+        capi = getattr(_usmarray, "__pyx_capi__", {})
+        names = [
+            "UsmNDArray_GetData",
+            "UsmNDArray_GetNDim",
+            "UsmNDArray_GetShape",
+            "UsmNDArray_GetStrides",
+            "UsmNDArray_GetElementSize",
+        ]
+        if not all(name in capi for name in names):
+            return
+
+        get_name = ctypes.pythonapi.PyCapsule_GetName
+        get_name.restype = ctypes.c_char_p
+        get_name.argtypes = [ctypes.py_object]
+        get_pointer = ctypes.pythonapi.PyCapsule_GetPointer
+        get_pointer.restype = ctypes.c_void_p
+        get_pointer.argtypes = [ctypes.py_object, ctypes.c_char_p]
+
+        funcs = [get_pointer(capi[name], get_name(capi[name])) for name in names]
+
+        set_api = runtime_lib.nmrtSetUsmArrayApi
+        set_api.argtypes = [ctypes.py_object] + [ctypes.c_void_p] * len(names)
+        set_api(usm_ndarray, *funcs)
+
+    _register_usm_array_api()
+
     @unbox(USMNdArrayType)
     def unbox_array(typ, obj, c):
         nativearycls = c.context.make_array(typ)
@@ -4,9 +4,11 @@
 
 
 import inspect
+from contextlib import contextmanager
 
 _mlir_func_names = {}
 _active_funcs_stack = []
+_active_funcs_recorders = []
 
 
 def add_func(func, name):
@@ -42,6 +44,23 @@ def add_active_funcs(name, func, flags):
     arg_has_default = list(map(lambda p: p.default is not empty, param_values))
     arg_defaults = list(map(lambda p: p.default, param_values))
     top[name] = (func, flags, arg_names, arg_has_default, arg_defaults)
+    for frame, recorded in _active_funcs_recorders:
+        if frame is top:
+            recorded.append((name, func, flags))
+
+
+@contextmanager
+def record_active_funcs():
+    """Collect funcs added to the current stack frame, so they can be replayed
+    via `add_active_funcs` later."""
+    global _active_funcs_recorders
+    frame = _active_funcs_stack[-1] if _active_funcs_stack else None
+    recorded = []
+    _active_funcs_recorders.append((frame, recorded))
+    try:
+        yield recorded
+    finally:
+        _active_funcs_recorders.pop()
 
 
 def find_active_func(name):
@@ -2,6 +2,9 @@
 #
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+import itertools
+import weakref
+
 from numba.core.untyped_passes import ReconstructSSA
 from numba.core.typed_passes import NopythonTypeInference
 from numba.core.compiler import (
@@ -13,8 +16,15 @@ from numba.core.compiler import (
 from numba.core.compiler_machinery import PassManager
 from numba.core import typing, cpu
 
-from numba_mlir.mlir.passes import MlirBackendInner, get_mlir_func
+from numba_mlir.mlir.passes import (
+    MlirBackendInner,
+    get_mlir_func,
+    store_mlir_func,
+    load_mlir_func,
+)
 
+from . import func_registry
+from .settings import LOWERED_FUNCS_CACHE
 from .target import numba_mlir_target
 
 
@@ -55,6 +65,55 @@ def _compile_isolated(func, args, return_type=None, flags=DEFAULT_FLAGS, locals=
     )
 
 
+# Lowered callees are cached in the compiler session and cloned into the new
+# modules instead of running numba typing and lowering again. Python side maps
+# function and signature to the session cache token and to the funcs, which
+# were registered during lowering and must be visible to the caller module.
+_lowered_funcs = weakref.WeakKeyDictionary()
+_lowered_funcs_tokens = itertools.count()
+
+
+def _get_lowered_funcs_entries(func):
+    if not LOWERED_FUNCS_CACHE:
+        return None
+
+    try:
+        return _lowered_funcs.setdefault(func, {})
+    except TypeError:
+        # Not weakly referenceable.
+        return None
+
+
+def _get_flags_key(flags):
+    return (
+        flags.get_mangle_string(),
+        getattr(flags, "gpu_fp64_truncate", False),
+        getattr(flags, "gpu_use_64bit_index", False),
+    )
+
+
 def compile_func(func, args, flags=DEFAULT_FLAGS):
-    _compile_isolated(func, args, flags=flags)
-    return get_mlir_func()
+    entries = _get_lowered_funcs_entries(func)
+    if entries is None:
+        _compile_isolated(func, args, flags=flags)
+        return get_mlir_func()
+
+    key = (tuple(args), _get_flags_key(flags))
+    entry = entries.get(key)
+    if entry is not None:
+        token, active_funcs = entry
+        res = load_mlir_func(token)
+        if res is not None:
+            for name, active_func, active_flags in active_funcs:
+                func_registry.add_active_funcs(name, active_func, active_flags)
+
+            return res
+
+    with func_registry.record_active_funcs() as active_funcs:
+        _compile_isolated(func, args, flags=flags)
+
+    res = get_mlir_func()
+    token = next(_lowered_funcs_tokens)
+    store_mlir_func(res, token)
+    entries[key] = (token, active_funcs)
+    return res
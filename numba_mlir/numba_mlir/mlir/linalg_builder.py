@@ -193,6 +193,9 @@ class Builder:
     def force_copy(self, arr):
         return self._force_copy(self._context, arr)
 
+    def is_gpu(self, *arrays):
+        return self._is_gpu(self._context, arrays)
+
     def array_type(self, dims, dtype):
         return self._array_type(self._context, dims, dtype)
 
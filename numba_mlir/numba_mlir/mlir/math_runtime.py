@@ -6,12 +6,18 @@ import ctypes
 import atexit
 from .utils import load_lib, mlir_func_name, register_cfunc
 from .settings import MKL_AVAILABLE, SYCL_MKL_AVAILABLE
+from .runtime import runtime_lib as core_runtime_lib
 
 runtime_lib = load_lib("numba-mlir-math-runtime")
 runtime_sycl_lib = load_lib("numba-mlir-math-sycl-runtime")
 
+# Native kernels use core runtime thread pool.
 _init_func = runtime_lib.nmrtMathRuntimeInit
-_init_func()
+_init_func.argtypes = [ctypes.c_void_p, ctypes.c_void_p]
+_init_func(
+    ctypes.cast(core_runtime_lib.nmrtParallelFor, ctypes.c_void_p),
+    ctypes.cast(core_runtime_lib.nmrtParallelScan, ctypes.c_void_p),
+)
 
 _init_sycl_func = runtime_sycl_lib.nmrtMathRuntimeInit
 _init_sycl_func()
@@ -28,6 +34,11 @@ def load_function_variants(runtime_lib, func_name, suffixes):
 load_function_variants(runtime_lib, "dpnp_linalg_eig_%s", ["float32", "float64"])
 if MKL_AVAILABLE:
     load_function_variants(runtime_lib, "mkl_gemm_%s", ["float32", "float64"])
+load_function_variants(runtime_lib, "native_gemm_%s", ["float32", "float64"])
+load_function_variants(runtime_lib, "linalg_gemv_%s", ["float32", "float64"])
+load_function_variants(runtime_lib, "linalg_gemm_batch_%s", ["float32", "float64"])
+load_function_variants(runtime_lib, "numpy_cumsum_%s", ["int64", "float32", "float64"])
+load_function_variants(runtime_lib, "numpy_cumprod_%s", ["int64", "float32", "float64"])
 if SYCL_MKL_AVAILABLE:
     load_function_variants(
         runtime_sycl_lib, "mkl_gemm_%s_device", ["float32", "float64"]
@@ -211,6 +211,78 @@ def prod_impl(builder, arg, dtype=None, axis=None, keepdims=False):
     )
 
 
+def _get_scan_dtype(builder, dtype):
+    # Small integers are accumulated in 64 bits, keeping signedness.
+    if dtype in [builder.bool, builder.int8, builder.int16, builder.int32]:
+        return builder.int64
+
+    if dtype in [builder.uint8, builder.uint16, builder.uint32]:
+        return builder.uint64
+
+    return dtype
+
+
+def _array_scan(builder, arg, axis, dtype, func_name):
+    axis = literal(axis)
+    if axis is not None and not isinstance(axis, int):
+        return
+
+    # Scans are computed by runtime, which doesn't have device variants.
+    if builder.is_gpu(arg):
+        return
+
+    res_dtype = _get_scan_dtype(builder, arg.dtype) if dtype is None else dtype
+
+    # Runtime only supports 64 bit integers, integer sums and products wrap
+    # around, so result can be computed in int64 and then truncated.
+    if is_int(res_dtype, builder) and res_dtype != builder.bool:
+        dtype = builder.int64
+    elif res_dtype in [builder.float32, builder.float64]:
+        dtype = res_dtype
+    else:
+        return
+
+    shape = arg.shape
+    if axis is None:
+        arg = flatten_impl(builder, arg)
+        res_shape = arg.shape
+        axis = 0
+    else:
+        res_shape = shape
+        axis = _fix_axis(axis, len(shape))
+
+    arg = convert_array(builder, arg, dtype)
+
+    # Runtime scans the middle dimension of 3D array.
+    outer = 1
+    for i in range(axis):
+        outer = outer * res_shape[i]
+
+    inner = 1
+    for i in range(axis + 1, len(res_shape)):
+        inner = inner * res_shape[i]
+
+    scan_shape = (outer, res_shape[axis], inner)
+    src = builder.reshape(arg, scan_shape)
+    res = builder.init_tensor(scan_shape, dtype)
+    func_name = f"{func_name}_{dtype_str(builder, dtype)}"
+    res = builder.external_call(func_name, src, res)
+    res = builder.reshape(res, res_shape)
+    return convert_array(builder, res, res_dtype)
+
+
+@register_func("array.cumsum")
+@register_func("numpy.cumsum", numpy.cumsum)
+def cumsum_impl(builder, arg, axis=None, dtype=None):
+    return _array_scan(builder, arg, axis, dtype, "numpy_cumsum")
+
+
+@register_func("array.cumprod")
+@register_func("numpy.cumprod", numpy.cumprod)
+def cumprod_impl(builder, arg, axis=None, dtype=None):
+    return _array_scan(builder, arg, axis, dtype, "numpy_cumprod")
+
+
 @register_func("numpy.flip", numpy.flip)
 def flip_impl(builder, arg, axis=None):
     shape = arg.shape
@@ -709,6 +781,24 @@ def _mkl_gemm(builder, a, b, alpha, beta, shape1, shape2):
     )
 
 
+def _native_gemm(builder, a, b, alpha, beta, shape1, shape2):
+    dtype = a.dtype
+    func_name = f"native_gemm_{dtype_str(builder, dtype)}"
+
+    res_shape = (shape1[0], shape2[1])
+    c = builder.init_tensor(res_shape, dtype)
+
+    alpha = builder.cast(alpha, dtype)
+    beta = builder.cast(beta, dtype)
+
+    return builder.external_call(func_name, (a, b, alpha, beta), c)
+
+
+def _is_blas_supported(builder, a, b):
+    dtype = a.dtype
+    return dtype == b.dtype and (dtype == builder.float32 or dtype == builder.float64)
+
+
 def _linalg_matmul2d(builder, a, b, shape1, shape2):
     iterators = ["parallel", "parallel", "reduction"]
     expr1 = "(d0,d1,d2) -> (d0,d2)"
@@ -732,6 +822,9 @@ def _matmul2d(builder, a, b, shape1, shape2):
         and not is_complex(b.dtype, builder)
     ):
         return _mkl_gemm(builder, a, b, 1, 0, shape1, shape2)
+    elif _is_blas_supported(builder, a, b) and not builder.is_gpu(a, b):
+        # Native gemm has no device variant.
+        return _native_gemm(builder, a, b, 1, 0, shape1, shape2)
     else:
         return _linalg_matmul2d(builder, a, b, shape1, shape2)
 
@@ -787,6 +880,66 @@ def _dot_broadcasted(builder, a, b, shape1, shape2):
     return res
 
 
+def _gemv(builder, a, x, trans):
+    dtype = a.dtype
+    func_name = f"linalg_gemv_{dtype_str(builder, dtype)}"
+
+    shape = a.shape
+    y = builder.init_tensor((shape[1] if trans else shape[0],), dtype)
+
+    trans = builder.cast(1 if trans else 0, builder.int32)
+    alpha = builder.cast(1, dtype)
+    beta = builder.cast(0, dtype)
+
+    return builder.external_call(func_name, (a, x, trans, alpha, beta), y)
+
+
+def _matvec(builder, a, b, shape1, shape2):
+    if _is_blas_supported(builder, a, b) and not builder.is_gpu(a, b):
+        if len(shape2) == 1:
+            return _gemv(builder, a, b, False)
+        else:
+            # x @ A == A.T @ x
+            return _gemv(builder, b, a, True)
+
+    return _dot_broadcasted(builder, a, b, shape1, shape2)
+
+
+def _gemm_batch(builder, a, b, shape1, shape2):
+    dtype = a.dtype
+    func_name = f"linalg_gemm_batch_{dtype_str(builder, dtype)}"
+
+    # 2D operands are broadcasted over batch, runtime handles batch of size 1.
+    if len(shape1) == 2:
+        a = builder.reshape(a, (1, shape1[0], shape1[1]))
+        batch = shape2[0]
+    elif len(shape2) == 2:
+        b = builder.reshape(b, (1, shape2[0], shape2[1]))
+        batch = shape1[0]
+    else:
+        batch1 = literal(shape1[0])
+        batch2 = literal(shape2[0])
+        if (
+            is_literal(batch1)
+            and is_literal(batch2)
+            and batch1 != batch2
+            and batch1 != 1
+            and batch2 != 1
+        ):
+            raise ValueError(
+                f"matmul: Input operand batch size {batch1} doesn't match {batch2}"
+            )
+
+        batch = builder.select(shape1[0] == 1, shape2[0], shape1[0])
+
+    c = builder.init_tensor((batch, shape1[-2], shape2[-1]), dtype)
+
+    alpha = builder.cast(1, dtype)
+    beta = builder.cast(0, dtype)
+
+    return builder.external_call(func_name, (a, b, alpha, beta), c)
+
+
 @register_func("numpy.dot", numpy.dot, out="out")
 def dot_impl(builder, a, b):
     shape1 = a.shape
@@ -797,6 +950,8 @@ def dot_impl(builder, a, b):
         return _dot1d(builder, a, b)
     if dim1 == 2 and dim2 == 2:
         return _matmul2d(builder, a, b, shape1, shape2)
+    if (dim1, dim2) in ((2, 1), (1, 2)):
+        return _matvec(builder, a, b, shape1, shape2)
 
 
 @register_func("operator.matmul")
@@ -805,14 +960,26 @@ def matmul_impl(builder, a, b):
     shape2 = b.shape
     dim1 = len(shape1)
     dim2 = len(shape2)
-    if dim1 > 2 or dim2 > 2:
+    if dim1 > 3 or dim2 > 3:
         return
 
+    if dim1 == 3 or dim2 == 3:
+        # gemm_batch has no device variant.
+        if (
+            dim1 < 2
+            or dim2 < 2
+            or not _is_blas_supported(builder, a, b)
+            or builder.is_gpu(a, b)
+        ):
+            return
+
+        return _gemm_batch(builder, a, b, shape1, shape2)
+
     if dim1 == 1 and dim2 == 1:
         return _dot1d(builder, a, b)
 
     if dim1 == 1 or dim2 == 1:
-        return _dot_broadcasted(builder, a, b, shape1, shape2)
+        return _matvec(builder, a, b, shape1, shape2)
 
     return _matmul2d(builder, a, b, shape1, shape2)
 
@@ -3,6 +3,7 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 import numpy as np
+import operator
 
 from numba.core import types
 from numba.core.typing import npydecl
@@ -163,6 +164,49 @@ class TransposeId(get_abstract_template(_transpose_pattern)):
             return signature(res_type, arr, axes)
 
 
+def _scan_pattern(a, axis=None, dtype=None):
+    return a, axis, dtype
+
+
+class ScanId(get_abstract_template(_scan_pattern)):
+    prefer_literal = True
+
+    def generic_impl(self, arr, axis, dtype):
+        if not isinstance(arr, Array):
+            return
+
+        if not is_type_or_none(axis, Integer):
+            return
+
+        if arr.dtype in types.complex_domain:
+            return
+
+        if not is_none(dtype):
+            res_dtype = npydecl.parse_dtype(dtype)
+        elif arr.dtype == types.boolean or arr.dtype in types.signed_domain:
+            res_dtype = types.int64
+        elif arr.dtype in types.unsigned_domain:
+            res_dtype = types.uint64
+        else:
+            res_dtype = arr.dtype
+
+        # Must match types supported by _array_scan.
+        if res_dtype not in types.integer_domain and res_dtype not in (
+            types.float32,
+            types.float64,
+        ):
+            return
+
+        ndim = 1 if is_none(axis) else arr.ndim
+        res_type = Array(dtype=res_dtype, ndim=ndim, layout="C")
+        args = tuple(a for a in (arr, axis, dtype) if not is_none(a))
+        return signature(res_type, *args)
+
+
+for func in [np.cumsum, np.cumprod]:
+    _replace_global(typing_registry, func, ScanId)
+
+
 def _dot_pattern(a, b, out=None):
     return a, b, out
 
@@ -201,6 +245,31 @@ class DotId(get_abstract_template(_dot_pattern)):
             return signature(return_type, a, b, out)
 
 
+def _matmul_pattern(a, b):
+    return a, b
+
+
+@infer_global(operator.matmul)
+class MatmulId(get_abstract_template(_matmul_pattern)):
+    prefer_literal = True
+
+    def generic_impl(self, a, b):
+        if not isinstance(a, Array) or not isinstance(b, Array):
+            return
+
+        # Numba only supports 1D and 2D operands, add batched 3D case, which
+        # is lowered to batched gemm runtime call.
+        ndims = (a.ndim, b.ndim)
+        if ndims not in ((3, 3), (3, 2), (2, 3)):
+            return
+
+        dtype = a.dtype
+        if dtype != b.dtype or dtype not in (types.float32, types.float64):
+            return
+
+        return signature(Array(dtype, 3, "C"), a, b)
+
+
 def is_array_or_scalar(t):
     return isinstance(t, (Array, Integer, Float))
 
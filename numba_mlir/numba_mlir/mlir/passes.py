@@ -3,6 +3,9 @@
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 import functools
+import itertools
+import os
+import re
 
 import llvmlite.ir
 from numba.core import types, cgutils
@@ -16,7 +19,19 @@ import numba.core.ir as ir
 from numba.core.ir_utils import mk_unique_var
 from contextlib import contextmanager
 
-from .settings import DUMP_IR, OPT_LEVEL, DUMP_DIAGNOSTICS
+from .settings import (
+    DUMP_IR,
+    OPT_LEVEL,
+    DUMP_DIAGNOSTICS,
+    COMPILE_THREADS,
+    COMPILE_PROFILE_DIR,
+    PARALLEL_SCHEDULE,
+    PARALLEL_GRAIN_SIZE,
+    L1_CACHE_SIZE,
+    L2_CACHE_SIZE,
+    VECTORIZE,
+    VECTOR_WIDTH,
+)
 from . import func_registry
 from .. import mlir_compiler
 from .compiler_context import global_compiler_context
@@ -32,6 +47,19 @@ def write_print_buffer(text):
     _print_buffer += text
 
 
+_profile_counter = itertools.count()
+
+
+def _get_compile_profile_file(func_id):
+    if not COMPILE_PROFILE_DIR:
+        return None
+
+    os.makedirs(COMPILE_PROFILE_DIR, exist_ok=True)
+    name = re.sub(r"[^\w.]", "_", func_id.func_qualname)
+    name = f"{os.getpid()}_{next(_profile_counter)}_{name}.json"
+    return os.path.join(COMPILE_PROFILE_DIR, name)
+
+
 def get_print_buffer():
     global _print_buffer
     if len(_print_buffer) == 0:
@@ -183,6 +211,7 @@ class MlirBackendBase(FunctionPass):
             "print_before": _print_before,
             "print_after": _print_after,
             "print_callback": write_print_buffer,
+            "compile_profile": _get_compile_profile_file(state.func_ir.func_id),
         }
         ctx["typemap"] = lambda op: state.typemap[op.name]
         ctx["fnargs"] = lambda: state.args
@@ -202,8 +231,22 @@ class MlirBackendBase(FunctionPass):
 
         if flags.auto_parallel.enabled:
             func_attrs["numba.max_concurrency"] = get_thread_count()
+            if PARALLEL_SCHEDULE:
+                func_attrs["numba.parallel_schedule"] = PARALLEL_SCHEDULE
+            if PARALLEL_GRAIN_SIZE > 0:
+                func_attrs["numba.parallel_grain_size"] = PARALLEL_GRAIN_SIZE
 
         func_attrs["numba.opt_level"] = OPT_LEVEL
+        if L1_CACHE_SIZE > 0:
+            func_attrs["numba.l1_cache_size"] = L1_CACHE_SIZE
+        if L2_CACHE_SIZE > 0:
+            func_attrs["numba.l2_cache_size"] = L2_CACHE_SIZE
+        if _get_flag(flags, "tile_sizes", None):
+            func_attrs["numba.tile_sizes"] = flags.tile_sizes
+        if not VECTORIZE:
+            func_attrs["numba.vector_width"] = 0
+        elif VECTOR_WIDTH > 0:
+            func_attrs["numba.vector_width"] = VECTOR_WIDTH
 
         if _get_flag(flags, "gpu_fp64_truncate", "auto") != "auto":
             func_attrs["gpu_runtime.fp64_truncate"] = flags.gpu_fp64_truncate
@@ -224,7 +267,7 @@ class MlirDumpPlier(MlirBackendBase):
         MlirBackendBase.__init__(self, push_func_stack=True)
 
     def run_pass(self, state):
-        module = mlir_compiler.create_module()
+        module = mlir_compiler.create_module(global_compiler_context, {})
         ctx = self._get_func_context(state)
         mlir_compiler.lower_function(ctx, module, state.func_ir)
         print(mlir_compiler.module_str(module))
@@ -236,6 +279,16 @@ def get_mlir_func():
     return _mlir_last_compiled_func
 
 
+def store_mlir_func(func, token):
+    global _mlir_active_module
+    mlir_compiler.store_function(_mlir_active_module, func, token)
+
+
+def load_mlir_func(token):
+    global _mlir_active_module
+    return mlir_compiler.load_function(_mlir_active_module, token)
+
+
 @register_pass(mutates_CFG=True, analysis_only=False)
 class MlirBackend(MlirBackendBase):
     _name = "mlir_backend"
@@ -248,8 +301,11 @@ class MlirBackend(MlirBackendBase):
         old_module = _mlir_active_module
 
         try:
-            mod_settings = {"enable_gpu_pipeline": state.flags.enable_gpu_pipeline}
-            module = mlir_compiler.create_module(mod_settings)
+            mod_settings = {
+                "enable_gpu_pipeline": state.flags.enable_gpu_pipeline,
+                "compile_threads": COMPILE_THREADS,
+            }
+            module = mlir_compiler.create_module(global_compiler_context, mod_settings)
             _mlir_active_module = module
             global _mlir_last_compiled_func
             ctx = self._get_func_context(state)
@@ -351,8 +407,13 @@ class MlirReplaceParfors(MlirBackendBase):
                 self._reconstruct_parfor_ssa(inst, typemap)
 
                 if module is None:
-                    mod_settings = {"enable_gpu_pipeline": True}
-                    module = mlir_compiler.create_module(mod_settings)
+                    mod_settings = {
+                        "enable_gpu_pipeline": True,
+                        "compile_threads": COMPILE_THREADS,
+                    }
+                    module = mlir_compiler.create_module(
+                        global_compiler_context, mod_settings
+                    )
 
                 fn_name = f"parfor_impl{inst.id}"
                 arg_types = self._get_parfor_args_types(typemap, inst)
@@ -15,14 +15,40 @@ _init_func(get_thread_count())
 
 _finalize_func = runtime_lib.nmrtParallelFinalize
 
+_set_num_threads_func = runtime_lib.nmrtParallelSetNumThreads
+_set_num_threads_func.argtypes = [ctypes.c_int]
+
+_get_num_threads_func = runtime_lib.nmrtParallelGetNumThreads
+_get_num_threads_func.restype = ctypes.c_int
+
+
+def set_num_threads(n):
+    """
+    Set number of threads, used by parallel regions, launched from the current
+    thread. Value can't exceed initial threads count, 0 resets it to default.
+    """
+    _set_num_threads_func(int(n))
+
+
+def get_num_threads():
+    """
+    Get number of threads, used by parallel regions, launched from the current
+    thread.
+    """
+    return _get_num_threads_func()
+
+
 _funcs = [
     "memrefCopy",
     "nmrtParallelFor",
+    "nmrtParallelScan",
     "nmrtPurgeContext",
     "nmrtReleaseContext",
     "nmrtTakeContext",
     "nmrtCreateAllocToken",
     "nmrtDestroyAllocToken",
+    "nmrtPoolAlloc",
+    "nmrtPoolFree",
 ]
 
 for name in _funcs:
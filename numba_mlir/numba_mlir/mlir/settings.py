@@ -21,3 +21,23 @@ DPNP_AVAILABLE = (
 MKL_AVAILABLE = is_mkl_supported()
 SYCL_MKL_AVAILABLE = is_sycl_mkl_supported()
 OPT_LEVEL = readenv("NUMBA_MLIR_OPT_LEVEL", int, 3)
+OBJECT_CACHE_DIR = readenv("NUMBA_MLIR_OBJECT_CACHE_DIR", str, "")
+OBJECT_CACHE_MAX_SIZE_MB = readenv("NUMBA_MLIR_OBJECT_CACHE_MAX_SIZE_MB", int, 1024)
+OBJECT_CACHE_PRUNE_INTERVAL = readenv("NUMBA_MLIR_OBJECT_CACHE_PRUNE_INTERVAL", int, 60)
+OBJECT_CACHE_EXPIRATION_DAYS = readenv(
+    "NUMBA_MLIR_OBJECT_CACHE_EXPIRATION_DAYS", int, 30
+)
+COMPILE_THREADS = readenv("NUMBA_MLIR_COMPILE_THREADS", int, 0)
+LAZY_COMPILATION = readenv("NUMBA_MLIR_LAZY_COMPILATION", int, 0)
+JIT_COMPILE_THREADS = readenv("NUMBA_MLIR_JIT_COMPILE_THREADS", int, 0)
+TIERED_COMPILATION = readenv("NUMBA_MLIR_TIERED_COMPILATION", int, 0)
+TIER_UP_THRESHOLD = readenv("NUMBA_MLIR_TIER_UP_THRESHOLD", int, 100)
+COMPILE_PROFILE_DIR = readenv("NUMBA_MLIR_COMPILE_PROFILE_DIR", str, "")
+PARALLEL_SCHEDULE = readenv("NUMBA_MLIR_PARALLEL_SCHEDULE", str, "")
+PARALLEL_GRAIN_SIZE = readenv("NUMBA_MLIR_PARALLEL_GRAIN_SIZE", int, 0)
+L1_CACHE_SIZE = readenv("NUMBA_MLIR_L1_CACHE_SIZE", int, 0)
+L2_CACHE_SIZE = readenv("NUMBA_MLIR_L2_CACHE_SIZE", int, 0)
+VECTORIZE = readenv("NUMBA_MLIR_VECTORIZE", int, 1)
+VECTOR_WIDTH = readenv("NUMBA_MLIR_VECTOR_WIDTH", int, 0)
+DISPATCH_CACHE = readenv("NUMBA_MLIR_DISPATCH_CACHE", int, 1)
+LOWERED_FUNCS_CACHE = readenv("NUMBA_MLIR_LOWERED_FUNCS_CACHE", int, 1)
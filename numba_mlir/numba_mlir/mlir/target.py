@@ -23,6 +23,9 @@ from numba.core.target_extension import (
     CPU,
 )
 
+from .. import mlir_compiler
+from .settings import DISPATCH_CACHE
+
 
 def typeof(val, purpose=Purpose.argument):
     """
@@ -150,12 +153,14 @@ class NumbaMLIRTargetOptions(cpu.CPUTargetOptions):
     gpu_fp64_truncate = _option_mapping("gpu_fp64_truncate", _map_f64truncate)
     gpu_use_64bit_index = _option_mapping("gpu_use_64bit_index")
     enable_gpu_pipeline = _option_mapping("enable_gpu_pipeline")
+    tile_sizes = _option_mapping("tile_sizes")
 
     def finalize(self, flags, options):
         super().finalize(flags, options)
         _set_option(flags, "gpu_fp64_truncate", options, False)
         _set_option(flags, "gpu_use_64bit_index", options, True)
         _set_option(flags, "enable_gpu_pipeline", options, True)
+        _set_option(flags, "tile_sizes", options, None)
         assert flags.gpu_fp64_truncate in [
             True,
             False,
@@ -169,6 +174,10 @@ class NumbaMLIRTargetOptions(cpu.CPUTargetOptions):
             True,
             False,
         ], "enable_gpu_pipeline supported values are True/False"
+        assert flags.tile_sizes is None or (
+            isinstance(flags.tile_sizes, tuple)
+            and all(isinstance(t, int) and t >= 0 for t in flags.tile_sizes)
+        ), "tile_sizes must be a tuple of non-negative ints"
 
 
 class NumbaMLIRTarget(CPUTarget):
@@ -226,6 +235,50 @@ class NumbaMLIRDispatcher(Dispatcher):
             py_func, self.targetdescr, targetoptions, locals, dummy_compiler_pipeline
         )
 
+        self._dispatch_cache = None
+        if DISPATCH_CACHE:
+            params = self._compiler.pysig.parameters.values()
+            num_positional = sum(
+                p.kind in (p.POSITIONAL_ONLY, p.POSITIONAL_OR_KEYWORD) for p in params
+            )
+            has_varargs = any(p.kind == p.VAR_POSITIONAL for p in params)
+            self._dispatch_cache = mlir_compiler.DispatchCache(
+                num_positional, has_varargs
+            )
+
+    # Regular numba dispatch, bypassing dispatch cache.
+    _call_uncached = Dispatcher.__call__
+
+    def _call_miss(self, *args):
+        """
+        Called from C++ `__call__` hook if dispatch cache doesn't have entry
+        point for *args*, compile and cache new overload if possible.
+        """
+        cache = self._dispatch_cache
+        if not self._can_compile or is_nested_compile() or not cache.is_cacheable(args):
+            return self._call_uncached(*args)
+
+        # Numba typecode cache doesn't know about FixedArray dims and can
+        # select wrong overload, resolve types via our typeof instead.
+        # This returns existing overload if it was already compiled.
+        folded = cache.fold_args(args)
+        entry = self._compile_for_args(*folded)
+
+        # Don't cache overloads specialized on literal values.
+        tys = tuple(typeof(a, Purpose.argument) for a in folded)
+        cres = self.overloads.get(tys)
+        if cres is not None and cres.entry_point is entry:
+            cache.insert(args, entry)
+
+        return entry(*folded)
+
+    def _reset_overloads(self):
+        super()._reset_overloads()
+        # Can be called from base class constructor.
+        cache = getattr(self, "_dispatch_cache", None)
+        if cache is not None:
+            cache.clear()
+
     def typeof_pyval(self, val):
         """
         Resolve the Numba type of Python value *val*.
@@ -260,6 +313,12 @@ class NumbaMLIRDispatcher(Dispatcher):
             self._compiler = old_compiler
 
 
+if DISPATCH_CACHE:
+    # Dispatch cache lookup is done by C++ `__call__` to avoid Python frame on
+    # every call, cache misses go through `_call_miss`.
+    mlir_compiler.set_dispatcher_call(NumbaMLIRDispatcher)
+
+
 dispatcher_registry[target_registry[target_name]] = NumbaMLIRDispatcher
 
 
@@ -5,7 +5,9 @@
 import numba
 
 # from numba_mlir import njit
+import inspect
 import math
+import re
 import sys
 from numpy.testing import assert_equal, assert_allclose
 from numba_mlir.mlir.passes import print_pass_ir, get_print_buffer
@@ -14,6 +16,7 @@ import pytest
 import itertools
 
 from .utils import parametrize_function_variants
+from .utils import run_isolated
 from .utils import njit_cached as njit
 
 
@@ -852,6 +855,262 @@ def test_prange_reduce3():
     assert_equal(py_func(10), jit_func(10))
 
 
+@pytest.mark.parametrize("num_threads", [0, 1, 2])
+def test_prange_num_threads(num_threads):
+    from numba_mlir import set_num_threads, get_num_threads
+
+    def py_func(a):
+        res = 0
+        for i in numba.prange(a):
+            res = res + i
+        return res
+
+    jit_func = njit(py_func, parallel=True)
+    old_num_threads = get_num_threads()
+    try:
+        set_num_threads(num_threads)
+        assert get_num_threads() <= old_num_threads
+        assert_equal(py_func(1000), jit_func(1000))
+    finally:
+        set_num_threads(0)
+
+
+_PRANGE_REDUCE_LAYOUT_CODE = """
+import re
+import numba
+from numba_mlir.mlir.passes import print_pass_ir, get_print_buffer
+
+def py_func(a):
+    res = a[0] - a[0]
+    for i in numba.prange(a.shape[0]):
+        res += a[i]
+    return res
+
+res = []
+expected = []
+types = []
+accesses = []
+for dtype in [np.int8, np.int32, np.float32, np.float64]:
+    # Odd size, so chunks don't split evenly between threads.
+    a = (np.arange(1001) % 7 - 3).astype(dtype)
+    with print_pass_ir([], ["ParallelToTbbPass"]):
+        jit_func = njit(py_func, parallel=True)
+        res.append(float(jit_func(a)))
+        ir = get_print_buffer()
+
+    expected.append(float(py_func(a)))
+    types.append(re.findall(r"memref.alloca\\(\\) (.*) : memref<4x(\\d+)x(\\w+)>", ir))
+    accesses.append(re.findall(r"\\[([^\\]]*)\\] : memref<4x\\d+x\\w+>", ir))
+
+def py_func_complex(a):
+    res = 0j
+    for i in numba.prange(a.shape[0]):
+        res += a[i]
+    return res
+
+a = np.arange(1001) * (1 + 0.5j)
+jit_func = njit(py_func_complex, parallel=True)
+res += [jit_func(a).real, jit_func(a).imag]
+expected += [py_func_complex(a).real, py_func_complex(a).imag]
+
+print(json.dumps({"res": res, "expected": expected, "types": types,
+                  "accesses": accesses}))
+"""
+
+
+def test_prange_reduce_layout():
+    # Parallel loops are only lowered to runtime calls for more than 1 thread.
+    res = run_isolated(_PRANGE_REDUCE_LAYOUT_CODE, NUMBA_NUM_THREADS="4")
+    assert_allclose(res["res"], res["expected"], rtol=1e-5)
+
+    # Per-thread reduction slots are padded to 64 bytes and only the first
+    # element of each slot is used.
+    elem_sizes = {"i8": 1, "i16": 2, "i32": 4, "i64": 8, "f32": 4, "f64": 8}
+    for types, accesses in zip(res["types"], res["accesses"]):
+        assert types, res
+        for attrs, slot_size, type in types:
+            assert "alignment = 64" in attrs, res
+            assert int(slot_size) * elem_sizes[type] == 64, res
+
+        assert accesses, res
+        for indices in accesses:
+            assert re.fullmatch(r"%arg\d+, %c0(_\d+)?", indices), res
+
+
+_PRANGE_STACK_ALLOC_CODE = """
+import numba
+from numba_mlir.mlir.passes import print_pass_ir, get_print_buffer
+
+def py_func(n):
+    res = np.empty(n)
+    for i in numba.prange(n):
+        t = np.empty(3)
+        for j in range(3):
+            t[j] = i + j
+        res[i] = t[i % 3]
+    return res
+
+with print_pass_ir([], ["LowerParallelToCFGPass"]):
+    jit_func = njit(py_func, parallel=True)
+    res = jit_func(1000).tolist()
+    ir = get_print_buffer()
+
+print(json.dumps({"res": res, "expected": py_func(1000).tolist(), "ir": ir}))
+"""
+
+
+def test_prange_stack_alloc():
+    # Parallel loops are only lowered to runtime calls for more than 1 thread.
+    res = run_isolated(_PRANGE_STACK_ALLOC_CODE, NUMBA_NUM_THREADS="4")
+    assert_equal(res["res"], res["expected"])
+
+    # Temporary must be promoted to stack and placed into the entry block of
+    # the outlined body function, before the branch to the body.
+    funcs = [f for f in res["ir"].split("func.func") if "memref.alloca" in f]
+    assert funcs, res["ir"]
+    for func in funcs:
+        entry = func.split("^bb")[0]
+        assert "memref.alloca" in entry, res["ir"]
+
+
+_PRANGE_SCHEDULE_CODE = """
+import re
+import numba
+from numba_mlir.mlir.passes import print_pass_ir, get_print_buffer
+
+def py_func1(n):
+    res = 0
+    for i in numba.prange(n):
+        res = res + i
+    return res
+
+def py_func2(a):
+    return a * 2 + 1
+
+def py_func3(n):
+    res = np.empty(n, np.int64)
+    for i in numba.prange(n):
+        j = 0
+        k = i
+        while k > 0:
+            k = k // 2
+            j += 1
+        res[i] = j
+    return res
+
+args = [
+    (py_func1, 1000),
+    (py_func2, np.arange(300 * 200).reshape(300, 200)),
+    (py_func2, np.arange(4 * 5 * 6 * 7).reshape(4, 5, 6, 7)),
+    (py_func3, 1000),
+]
+
+res = []
+expected = []
+schedules = []
+grains = []
+for py_func, arg in args:
+    with print_pass_ir([], ["ParallelToTbbPass"]):
+        jit_func = njit(py_func, parallel=True)
+        # Run twice, affinity schedule reuses partitioner state between calls.
+        jit_func(arg)
+        res.append(np.asarray(jit_func(arg)).tolist())
+        ir = get_print_buffer()
+
+    expected.append(np.asarray(py_func(arg)).tolist())
+    schedules.append([int(s) for s in re.findall(r"schedule = (\\d+)", ir)])
+    grains.append([int(s) for s in re.findall(r"grainSize = (\\d+)", ir)])
+
+print(json.dumps({"res": res, "expected": expected, "schedules": schedules,
+                  "grains": grains}))
+"""
+
+
+@pytest.mark.parametrize("schedule", ["", "static", "dynamic", "affinity"])
+@pytest.mark.parametrize("grain", [0, 7])
+def test_prange_schedule(schedule, grain):
+    # Parallel loops are only lowered to runtime calls for more than 1 thread.
+    res = run_isolated(
+        _PRANGE_SCHEDULE_CODE,
+        NUMBA_NUM_THREADS="4",
+        NUMBA_MLIR_PARALLEL_SCHEDULE=schedule,
+        NUMBA_MLIR_PARALLEL_GRAIN_SIZE=str(grain),
+    )
+    assert res["res"] == res["expected"]
+
+    kinds = {"": 0, "static": 1, "dynamic": 2, "affinity": 3}
+    for i, (schedules, grains) in enumerate(zip(res["schedules"], res["grains"])):
+        assert len(schedules) > 0, res
+
+        expected_kind = kinds[schedule]
+        if not schedule and i == len(res["schedules"]) - 1:
+            # Loops with data-dependent trip count default to dynamic.
+            expected_kind = kinds["dynamic"]
+
+        assert all(s == expected_kind for s in schedules), res
+        if grain > 0:
+            assert grains and all(g == grain for g in grains), res
+        elif not schedule:
+            assert grains and all(g > 0 for g in grains), res
+
+
+_PARALLEL_SCAN_CODE = """
+from numpy.testing import assert_allclose
+from numba_mlir.mlir.passes import print_pass_ir, get_print_buffer
+
+def py_func1(a):
+    res = np.empty_like(a)
+    acc = 0
+    for i in range(a.shape[0]):
+        acc += a[i]
+        res[i] = acc
+    return res
+
+def py_func2(a):
+    res = np.empty_like(a)
+    acc = 1.0
+    for i in range(a.shape[0]):
+        acc *= a[i]
+        res[i] = acc
+    return res
+
+# Large enough to be split into multiple blocks by the runtime.
+rng = np.random.default_rng(42)
+args = [
+    (py_func1, np.arange(64 * 1024) % 13, {}),
+    (py_func2, rng.uniform(0.99, 1.01, 64 * 1024), {"fastmath": True}),
+]
+
+res = []
+expected = []
+scans = []
+for py_func, arg, kwargs in args:
+    with print_pass_ir([], ["ParallelToTbbPass"]):
+        jit_func = njit(py_func, parallel=True, **kwargs)
+        res.append(jit_func(arg).tolist())
+        ir = get_print_buffer()
+
+    expected.append(py_func(arg).tolist())
+    scans.append(ir.count("numba_util.parallel_scan"))
+
+print(json.dumps({"res": res, "expected": expected, "scans": scans}))
+"""
+
+
+def test_parallel_scan():
+    # Scan loops are only lowered to runtime calls for more than 1 thread.
+    res = run_isolated(_PARALLEL_SCAN_CODE, NUMBA_NUM_THREADS="4")
+    assert all(s > 0 for s in res["scans"]), res["scans"]
+
+    int_res, float_res = res["res"]
+    int_expected, float_expected = res["expected"]
+    assert_equal(int_res, int_expected)
+
+    # Float scan is reassociated with fastmath, rounding error of the product is
+    # proportional to the array size.
+    assert_allclose(float_res, float_expected, rtol=1e-10)
+
+
 def test_func_call1():
     def py_func1(b):
         return b + 3
@@ -880,6 +1139,30 @@ def test_func_call2():
     assert_equal(py_func2(10), jit_func2(10))
 
 
+def test_func_call_multiple_callers():
+    def py_func1(b):
+        return b + 3
+
+    jit_func1 = njit(py_func1)
+
+    def py_func2(b):
+        return jit_func1(b) * 2
+
+    jit_func2 = njit(py_func2)
+
+    def py_func3(a):
+        return jit_func2(a) - jit_func1(a)
+
+    def py_func4(a):
+        return jit_func2(a) + jit_func2(a + 1)
+
+    # Callees lowered for the first caller are reused by the following ones.
+    for py_func in (py_func3, py_func4, py_func3):
+        jit_func = njit(py_func)
+        assert_equal(py_func(10), jit_func(10))
+        assert_equal(py_func(1.5), jit_func(1.5))
+
+
 def test_omitted_args_int():
     def py_func(a=3, b=7):
         return a + b
@@ -909,6 +1192,96 @@ def test_omitted_args_bool():
     assert_equal(py_func(), jit_func())
 
 
+@pytest.mark.parametrize(
+    "args",
+    [
+        (1, 2, 3),
+        (1, 2.5, 3),
+        (1.5,),
+        (1, (2, 3.5)),
+        (2, None, True),
+    ],
+)
+def test_dispatch_varargs(args):
+    def py_func(a, *args):
+        return a + len(args)
+
+    jit_func = njit(py_func)
+    for _ in range(3):
+        assert_equal(py_func(*args), jit_func(*args))
+
+
+@pytest.mark.parametrize(
+    "py_func, args_list",
+    [
+        (
+            lambda a: len(a),
+            [(1, 2), (1, 2.5), (1.5, 2), (1, (2, 3)), ((1, 2), 3), (1, 2, 3), ()],
+        ),
+        (
+            lambda a, *args: a + len(args),
+            [(1,), (1, 2), (1, 2.5), (1, (2, 3)), (1, 2, 3), (1.5, 2, 3)],
+        ),
+    ],
+)
+def test_dispatch_cache_tuples(py_func, args_list):
+    jit_func = njit(py_func)
+    if jit_func._dispatch_cache is None:
+        pytest.skip("Dispatch cache is disabled")
+
+    def call(args):
+        if py_func.__code__.co_flags & inspect.CO_VARARGS:
+            return py_func(*args), jit_func(*args)
+        return py_func(args), jit_func(args)
+
+    # Every tuple structure and varargs count must miss the cache and get its
+    # own entry, repeated calls must hit it.
+    for i, args in enumerate(args_list):
+        assert_equal(*call(args))
+        assert len(jit_func._dispatch_cache) == i + 1
+
+    for args in args_list:
+        assert_equal(*call(args))
+
+    assert len(jit_func._dispatch_cache) == len(args_list)
+
+
+def test_dispatch_cache_int_overflow():
+    def py_func(a):
+        return a // 2
+
+    jit_func = njit(py_func)
+    if jit_func._dispatch_cache is None:
+        pytest.skip("Dispatch cache is disabled")
+
+    assert_equal(py_func(4), jit_func(4))
+    assert len(jit_func._dispatch_cache) == 1
+
+    # Values outside of int64 are typed as uint64 by numba and must bypass
+    # the cache instead of reusing int64 entry.
+    assert_equal(py_func(2**63 + 4), jit_func(2**63 + 4))
+    assert len(jit_func._dispatch_cache) == 1
+    assert_equal(py_func(-4), jit_func(-4))
+
+
+def test_dispatch_changing_types():
+    def py_func(a, b):
+        return a + b
+
+    jit_func = njit(py_func)
+    for args in [(1, 2), (1.5, 2), (1, 2), (1 + 2j, 3), (1.5, 2), (2**40, 1)]:
+        assert_equal(py_func(*args), jit_func(*args))
+
+
+def test_dispatch_kwargs():
+    def py_func(a, b=2):
+        return a - b
+
+    jit_func = njit(py_func)
+    for args, kwargs in [((5,), {}), ((5,), {"b": 3}), ((), {"a": 1, "b": 2.5})]:
+        assert_equal(py_func(*args, **kwargs), jit_func(*args, **kwargs))
+
+
 def test_omitted_args_none():
     def py_func1(a=None):
         return a
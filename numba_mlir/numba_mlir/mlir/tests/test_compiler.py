@@ -0,0 +1,118 @@
+# SPDX-FileCopyrightText: 2022 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import json
+import pytest
+
+from .utils import run_isolated
+
+
+_COMPILE_IR_CODE = """
+import contextlib
+import io
+
+def py_func1(a):
+    return np.sum(a * 2)
+
+def py_func2(a, b):
+    return np.where(a > b, a, b).sum()
+
+jit_func1 = njit(py_func1)
+jit_func2 = njit(py_func2)
+
+def py_func(a, b):
+    res = 0
+    for i in range(a.shape[0]):
+        res += jit_func1(a[i]) + jit_func2(a[i], b)
+    return res
+
+buf = io.StringIO()
+with contextlib.redirect_stdout(buf):
+    a = np.arange(12.0).reshape(3, 4)
+    b = np.ones(4)
+    res = njit(py_func)(a, b)
+
+print(json.dumps({"res": res, "ir": buf.getvalue()}))
+"""
+
+
+def test_multithreaded_compile_ir():
+    env = {"NUMBA_MLIR_DUMP_LLVM": "1"}
+    serial = run_isolated(_COMPILE_IR_CODE, NUMBA_MLIR_COMPILE_THREADS="1", **env)
+    parallel = run_isolated(_COMPILE_IR_CODE, NUMBA_MLIR_COMPILE_THREADS="8", **env)
+    assert serial["res"] == parallel["res"]
+    assert len(serial["ir"]) > 0
+    assert serial["ir"] == parallel["ir"]
+
+
+_SESSION_REUSE_CODE = """
+def get_compiler_stats():
+    return mlir_compiler.get_compiler_stats(global_compiler_context)
+
+def py_func1(a):
+    return a + 1
+
+def py_func2(a, b):
+    return a * b - 0.5
+
+res1 = njit(py_func1)(1)
+stats1 = get_compiler_stats()
+
+res2 = njit(py_func2)(1.5, 3)
+stats2 = get_compiler_stats()
+
+print(json.dumps({"res": [res1, res2], "stats": [stats1, stats2]}))
+"""
+
+
+def test_session_reuse():
+    res = run_isolated(_SESSION_REUSE_CODE)
+    assert res["res"] == [2, 4.0]
+
+    # Second compilation must reuse context and pass managers created by the
+    # first one.
+    stats1, stats2 = res["stats"]
+    assert stats1["sessions"] == 1
+    assert stats1["compilers"] > 0
+    assert stats2 == stats1
+
+
+_COMPILE_PROFILE_CODE = """
+def py_func1(a):
+    return a + 1
+
+def py_func2(a):
+    return np.sum(a * 2)
+
+res = [njit(py_func1)(1), njit(py_func2)(np.arange(10.0))]
+print(json.dumps({"res": res}))
+"""
+
+
+@pytest.mark.parametrize("jit_threads", ["0", "4"])
+def test_compile_profile(tmp_path, jit_threads):
+    profile_dir = tmp_path / "profile"
+    res = run_isolated(
+        _COMPILE_PROFILE_CODE,
+        NUMBA_MLIR_COMPILE_PROFILE_DIR=str(profile_dir),
+        NUMBA_MLIR_JIT_COMPILE_THREADS=jit_threads,
+    )
+    assert res["res"] == [2, 90.0]
+
+    files = sorted(profile_dir.iterdir())
+    for name in ["py_func1", "py_func2"]:
+        traces = [f for f in files if f.name.endswith(f"_{name}.json")]
+        assert len(traces) == 1, files
+
+        with open(traces[0]) as f:
+            events = json.load(f)["traceEvents"]
+
+        categories = {e["cat"] for e in events}
+        assert {"stage", "pass", "llvm"} <= categories, categories
+
+        # Each trace must only contain events of its own compilation, even if
+        # LLVM compilation happens on the JIT threads.
+        llvm_events = [e["name"] for e in events if e["cat"] == "llvm"]
+        assert llvm_events.count("translate") == 1, llvm_events
+        assert llvm_events.count("codegen") == 1, llvm_events
@@ -0,0 +1,180 @@
+# SPDX-FileCopyrightText: 2022 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import os
+import pytest
+
+from .utils import run_isolated
+
+
+_OBJECT_CACHE_CODE = """
+def py_func(a, b):
+    return a * b + 3
+
+res = njit(py_func)(2, 5)
+print(json.dumps({"res": res, **get_stats()}))
+"""
+
+
+def test_object_cache_roundtrip(tmp_path):
+    cache_dir = str(tmp_path / "cache")
+    env = {"NUMBA_MLIR_OBJECT_CACHE_DIR": cache_dir}
+
+    first = run_isolated(_OBJECT_CACHE_CODE, **env)
+    assert first["res"] == 13
+    assert first["object_cache_hits"] == 0
+    assert first["object_cache_misses"] > 0
+    entries = sorted(os.listdir(cache_dir))
+    assert any(e.startswith("llvmcache-") for e in entries), entries
+
+    second = run_isolated(_OBJECT_CACHE_CODE, **env)
+    assert second["res"] == 13
+    assert second["object_cache_hits"] == first["object_cache_misses"]
+    assert second["object_cache_misses"] == 0
+    assert sorted(os.listdir(cache_dir)) == entries
+
+
+def test_object_cache_max_size(tmp_path):
+    cache_dir = tmp_path / "cache"
+    cache_dir.mkdir()
+
+    # Stale entry, which must be evicted first.
+    stale = cache_dir / "llvmcache-stale.o"
+    stale.write_bytes(b"\0" * (2 * 1024 * 1024))
+    os.utime(stale, (0, 0))
+
+    env = {
+        "NUMBA_MLIR_OBJECT_CACHE_DIR": str(cache_dir),
+        "NUMBA_MLIR_OBJECT_CACHE_MAX_SIZE_MB": "1",
+    }
+    res = run_isolated(_OBJECT_CACHE_CODE, **env)
+    assert res["res"] == 13
+    assert not stale.exists()
+    assert any(e.name.startswith("llvmcache-") for e in cache_dir.iterdir())
+
+
+def test_object_cache_expiration(tmp_path):
+    cache_dir = tmp_path / "cache"
+    cache_dir.mkdir()
+
+    stale = cache_dir / "llvmcache-stale.o"
+    stale.write_bytes(b"\0" * 16)
+    os.utime(stale, (0, 0))
+
+    env = {
+        "NUMBA_MLIR_OBJECT_CACHE_DIR": str(cache_dir),
+        "NUMBA_MLIR_OBJECT_CACHE_EXPIRATION_DAYS": "1",
+    }
+    res = run_isolated(_OBJECT_CACHE_CODE, **env)
+    assert res["res"] == 13
+    assert not stale.exists()
+
+
+_OBJECT_CACHE_CODE2 = """
+def py_func(a, b):
+    return a * b + 5
+
+res = njit(py_func)(2, 5)
+print(json.dumps({"res": res, **get_stats()}))
+"""
+
+
+def test_object_cache_prune_interval(tmp_path):
+    cache_dir = tmp_path / "cache"
+    env = {
+        "NUMBA_MLIR_OBJECT_CACHE_DIR": str(cache_dir),
+        "NUMBA_MLIR_OBJECT_CACHE_MAX_SIZE_MB": "1",
+        "NUMBA_MLIR_OBJECT_CACHE_PRUNE_INTERVAL": "3600",
+    }
+    res = run_isolated(_OBJECT_CACHE_CODE, **env)
+    assert res["res"] == 13
+    assert (cache_dir / "llvmcache.timestamp").exists()
+
+    # Directory was scanned less than interval ago, new entries must not
+    # trigger another scan.
+    stale = cache_dir / "llvmcache-stale.o"
+    stale.write_bytes(b"\0" * (2 * 1024 * 1024))
+    os.utime(stale, (0, 0))
+
+    res = run_isolated(_OBJECT_CACHE_CODE2, **env)
+    assert res["res"] == 15
+    assert res["object_cache_misses"] > 0
+    assert stale.exists()
+
+
+_COMPILATION_MODES_CODE = """
+def py_func1(a):
+    return a * 2 + 1
+
+def py_func2(a, b):
+    return np.sum(a * b)
+
+jit_func1 = njit(py_func1)
+jit_func2 = njit(py_func2)
+
+def py_func3(a, b):
+    return jit_func1(a.shape[0]) + jit_func2(a, b)
+
+jit_func3 = njit(py_func3)
+
+a = np.arange(10.0)
+b = np.ones(10)
+res = [jit_func1(5), jit_func2(a, b), jit_func3(a, b), jit_func1(7.5)]
+expected = [py_func1(5), py_func2(a, b), py_func3(a, b), py_func1(7.5)]
+print(json.dumps({"res": res, "expected": expected}))
+"""
+
+
+@pytest.mark.parametrize(
+    "env",
+    [
+        {"NUMBA_MLIR_LAZY_COMPILATION": "1"},
+        {"NUMBA_MLIR_JIT_COMPILE_THREADS": "4"},
+        {"NUMBA_MLIR_LAZY_COMPILATION": "1", "NUMBA_MLIR_JIT_COMPILE_THREADS": "4"},
+    ],
+    ids=["lazy", "concurrent", "lazy_concurrent"],
+)
+def test_compilation_modes(env):
+    res = run_isolated(_COMPILATION_MODES_CODE, **env)
+    assert res["res"] == res["expected"]
+
+
+_TIERED_COMPILATION_CODE = """
+import time
+
+def py_func(a, b):
+    return np.sum(a * b) + 1
+
+jit_func = njit(py_func)
+
+a = np.arange(100.0)
+b = np.ones(100)
+before = [jit_func(a, b) for _ in range(3)]
+stats_before = get_stats()
+
+# Recompilation runs in background, keep calling until stubs are switched.
+deadline = time.time() + 60
+while get_stats()["tier_ups"] == 0 and time.time() < deadline:
+    jit_func(a, b)
+    time.sleep(0.01)
+
+after = [jit_func(a, b) for _ in range(3)]
+print(json.dumps({"before": before, "after": after, "expected": py_func(a, b),
+                  "stats_before": stats_before, "stats_after": get_stats()}))
+"""
+
+
+def test_tiered_compilation():
+    res = run_isolated(
+        _TIERED_COMPILATION_CODE,
+        NUMBA_MLIR_TIERED_COMPILATION="1",
+        NUMBA_MLIR_TIER_UP_THRESHOLD="5",
+    )
+    expected = res["expected"]
+    assert res["before"] == [expected] * 3
+    assert res["after"] == [expected] * 3
+
+    # Below threshold calls must stay on tier 0.
+    assert res["stats_before"]["tier_ups"] == 0
+    assert res["stats_after"]["tier_ups"] > 0
@@ -1350,6 +1350,40 @@ def test_parfor_simple1():
     assert_equal(gpu_res, sim_res)
 
 
+@require_dpctl
+@pytest.mark.parametrize(
+    "slice_func",
+    [
+        lambda a: a,
+        lambda a: a[3:],
+        lambda a: a[1:-2:3],
+        lambda a: a[::-1],
+        lambda a: a.reshape(32, 32)[5:, 7],
+    ],
+)
+def test_parfor_usm_views(slice_func):
+    def py_func(a, c):
+        for i in numba.prange(len(a)):
+            c[i] = a[i] * 2
+
+    gpu_func = njit(py_func)
+
+    a = slice_func(np.arange(1024, dtype=np.float32))
+    sim_res = np.zeros(a.shape, a.dtype)
+    py_func(a, sim_res)
+
+    da = slice_func(_from_host(np.arange(1024, dtype=np.float32), buffer="device"))
+    gpu_res = np.zeros(a.shape, a.dtype)
+    dgpu_res = _from_host(gpu_res, buffer="device")
+
+    # Call twice to check cached unboxing state.
+    for _ in range(2):
+        gpu_func(da, dgpu_res)
+
+    _to_host(dgpu_res, gpu_res)
+    assert_equal(gpu_res, sim_res)
+
+
 @require_dpctl
 @pytest.mark.parametrize("val", _test_values)
 def test_parfor_scalar(val):
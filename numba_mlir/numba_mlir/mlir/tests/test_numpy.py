@@ -683,6 +683,81 @@ def test_flip2(py_func, arr):
     assert_equal(py_func(arr), jit_func(arr))
 
 
+@parametrize_function_variants(
+    "py_func",
+    [
+        "lambda a: np.cumsum(a)",
+        "lambda a: np.cumsum(a, axis=0)",
+        "lambda a: np.cumsum(a, axis=-1)",
+        "lambda a: np.cumsum(a, dtype=np.float64)",
+        "lambda a: np.cumprod(a)",
+        "lambda a: np.cumprod(a, axis=0)",
+        "lambda a: np.cumprod(a, axis=-1)",
+        "lambda a: a.cumsum()",
+        "lambda a: a.cumprod()",
+    ],
+)
+@pytest.mark.parametrize(
+    "arr",
+    [
+        np.array([1, 2, 3, 4, 5, 6], dtype=np.int32),
+        np.array([[1, 2, 3], [4, 5, 6]], dtype=np.int32),
+        np.array([[[1, 2, 3], [4, 5, 6]]], dtype=np.float32),
+        np.array([[1, 2], [3, 4], [5, 6]], dtype=np.float64).T,
+    ],
+)
+def test_scan(py_func, arr):
+    jit_func = njit(py_func)
+    assert_allclose(py_func(arr), jit_func(arr), rtol=1e-5)
+
+
+@pytest.mark.parametrize("dtype", [np.int64, np.float64])
+def test_scan_large(dtype):
+    def py_func(a):
+        return np.cumsum(a), np.cumsum(a.reshape(4, -1), axis=1)
+
+    jit_func = njit(py_func)
+    arr = np.arange(1024 * 64, dtype=dtype) % 7
+    assert_equal(py_func(arr), jit_func(arr))
+
+
+@parametrize_function_variants(
+    "py_func",
+    [
+        "lambda a: np.cumsum(a)",
+        "lambda a: np.cumsum(a, dtype=np.int32)",
+        "lambda a: np.cumprod(a)",
+        "lambda a: np.cumprod(a, dtype=np.uint32)",
+    ],
+)
+@pytest.mark.parametrize("dtype", [np.bool_, np.int8, np.int32, np.uint8, np.uint64])
+def test_scan_dtype(py_func, dtype):
+    jit_func = njit(py_func)
+    arr = np.array([1, 0, 3, 2, 1, 5], dtype=dtype)
+    expected = py_func(arr)
+    res = jit_func(arr)
+    assert_equal(res, expected)
+    assert res.dtype == expected.dtype
+
+
+@parametrize_function_variants(
+    "py_func",
+    [
+        "lambda a: np.cumsum(a)",
+        "lambda a: np.cumprod(a)",
+    ],
+)
+@pytest.mark.parametrize("dtype, rtol", [(np.float32, 1e-3), (np.float64, 1e-10)])
+def test_scan_random(py_func, dtype, rtol):
+    # Runtime scans large arrays by blocks in parallel, which reassociates
+    # float operations, so results only match up to the accumulated rounding
+    # error, which is roughly proportional to the array size.
+    jit_func = njit(py_func)
+    rng = np.random.default_rng(42)
+    arr = rng.uniform(0.99, 1.01, 1024 * 64).astype(dtype)
+    assert_allclose(py_func(arr), jit_func(arr), rtol=rtol)
+
+
 def test_sum_add():
     def py_func(a, b):
         return np.add(a, b).sum()
@@ -972,6 +1047,34 @@ def test_loop_fusion3():
         assert ir.count("memref.load") == 2, ir
 
 
+def test_stencil_fusion():
+    def py_func(a):
+        b = a * 2
+        return b[1:] + b[:-1]
+
+    jit_func = njit(py_func)
+    a = np.arange(13)
+
+    with print_pass_ir([], ["PostLinalgOptPass"]):
+        assert_equal(py_func(a), jit_func(a))
+        ir = get_print_buffer()
+        assert ir.count("scf.parallel") == 1, ir
+
+
+def test_reduction_fusion():
+    def py_func(a):
+        b = a * 2
+        return b[1:].sum()
+
+    jit_func = njit(py_func)
+    a = np.arange(13)
+
+    with print_pass_ir([], ["PostLinalgOptPass"]):
+        assert_equal(py_func(a), jit_func(a))
+        ir = get_print_buffer()
+        assert ir.count("scf.parallel") == 1, ir
+
+
 def test_copy_fusion():
     def py_func(a, b):
         a = a + 1
@@ -1622,6 +1725,137 @@ def test_fortran_layout(arr):
     assert_equal(py_func(arr), jit_func(arr))
 
 
+@parametrize_function_variants(
+    "py_func",
+    [
+        "lambda a: a + a.T",
+        "lambda a: np.sum(a, axis=0)",
+        "lambda a: a[1:-1, 1:-1] + a[:-2, 1:-1] + a[2:, 1:-1]",
+    ],
+)
+@pytest.mark.parametrize("parallel", [False, True])
+def test_cache_tiling(py_func, parallel):
+    arr = np.arange(301 * 301, dtype=np.float64).reshape(301, 301)
+    with print_pass_ir([], ["TileLinalgForCachePass"]):
+        jit_func = njit(py_func, parallel=parallel)
+        assert_allclose(py_func(arr), jit_func(arr), rtol=1e-10)
+        ir = get_print_buffer()
+
+        # Linalg is not yet converted to loops at this point, so loops can
+        # only come from the L2 (parallel) and L1 (sequential) tiling.
+        assert ir.count("scf.parallel") > 0, ir
+        assert ir.count("scf.for") > 0, ir
+
+
+def test_cache_tiling_hint():
+    def py_func(a, b):
+        return a + b
+
+    arr = np.arange(301 * 301, dtype=np.float64).reshape(301, 301)
+    for tile_sizes, tiled in [(None, False), ((32, 0), True), ((32,), False)]:
+        with print_pass_ir([], ["TileLinalgForCachePass"]):
+            # Contiguous elementwise op is not tiled by default, explicit tile
+            # sizes are used as is, if their count matches loops count.
+            kwargs = {} if tile_sizes is None else {"tile_sizes": tile_sizes}
+            jit_func = njit(py_func, **kwargs)
+            assert_equal(py_func(arr, arr + 1), jit_func(arr, arr + 1))
+            ir = get_print_buffer()
+            assert (ir.count("scf.parallel") > 0) == tiled, ir
+
+
+@pytest.mark.parametrize("tile_sizes", [None, (32, 32)])
+def test_cache_tiling_aliased(tile_sizes):
+    def py_func(a):
+        a += a.T
+        return a
+
+    # Tiling changes iteration order, generics writing to their own inputs
+    # must not be tiled, even if explicitly requested.
+    arr = np.arange(301 * 301, dtype=np.float64).reshape(301, 301)
+    kwargs = {} if tile_sizes is None else {"tile_sizes": tile_sizes}
+    jit_func = njit(py_func, **kwargs)
+    assert_equal(py_func(arr.copy()), jit_func(arr.copy()))
+
+
+@parametrize_function_variants(
+    "py_func",
+    [
+        "lambda a, b: a + b",
+        "lambda a, b: a * b[0]",
+        "lambda a, b: np.where(a > b, a, b - 1)",
+        "lambda a, b: np.sum(a * b, axis=-1)",
+    ],
+)
+@pytest.mark.parametrize("shape", [(7,), (3, 37), (5, 4, 19)])
+@pytest.mark.parametrize("parallel", [False, True])
+def test_vectorize_linalg(py_func, shape, parallel):
+    jit_func = njit(py_func, parallel=parallel)
+
+    a = np.arange(math.prod(shape), dtype=np.float64).reshape(shape)
+    b = np.flip(a).copy()
+    assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-10)
+
+
+def test_vectorize_linalg_ir():
+    def py_func(a, b):
+        return a + b
+
+    jit_func = njit(py_func)
+
+    a = np.arange(100, dtype=np.float32)
+    b = np.arange(100, dtype=np.float32)
+    with print_pass_ir([], ["VectorizeLinalgPass"]):
+        assert_equal(py_func(a, b), jit_func(a, b))
+        ir = get_print_buffer()
+        assert ir.count("vector.transfer_read") > 0, ir
+
+
+@pytest.mark.parametrize("size", [1, 13, 101])
+def test_vectorize_linalg_tail_ir(size):
+    def py_func(a, b):
+        return a + b
+
+    jit_func = njit(py_func)
+
+    # Size is not a multiple of any vector length, vectorized main loop must
+    # be followed by the peeled scalar remainder.
+    a = np.arange(size, dtype=np.float32)
+    b = np.arange(size, dtype=np.float32) + 1
+    with print_pass_ir([], ["VectorizeLinalgPass"]):
+        assert_equal(py_func(a, b), jit_func(a, b))
+        ir = get_print_buffer()
+        assert ir.count("vector.transfer_read") > 0, ir
+        assert ir.count("vector.transfer_write") > 0, ir
+        assert ir.count("scf.for") >= 2, ir
+        assert ir.count("linalg.generic") > 0, ir
+
+
+@pytest.mark.parametrize(
+    "dtype, fastmath, vectorized",
+    [
+        (np.float32, False, False),
+        (np.float32, True, True),
+        (np.int32, False, True),
+    ],
+)
+def test_vectorize_linalg_reduction_ir(dtype, fastmath, vectorized):
+    def py_func(a):
+        return np.sum(a, axis=-1)
+
+    jit_func = njit(py_func, fastmath=fastmath)
+
+    # Vectorized float reduction reassociates the sum, only allowed with
+    # fastmath.
+    a = np.arange(4 * 100, dtype=dtype).reshape(4, 100)
+    with print_pass_ir([], ["VectorizeLinalgPass"]):
+        assert_allclose(py_func(a), jit_func(a), rtol=1e-5)
+        ir = get_print_buffer()
+        assert (ir.count("vector.transfer_read") > 0) == vectorized, ir
+        if not vectorized:
+            assert ir.count("vector.") == 0, ir
+            assert ir.count("linalg.generic") > 0, ir
+
+
 def test_contigious_layout_opt1():
     def py_func(a):
         return a[0, 1]
@@ -2097,6 +2331,69 @@ def test_array_loop1(arr):
         assert ir.count("scf.for") > 0, ir
 
 
+def test_dispatch_fixed_dims():
+    def py_func(a):
+        return a.sum()
+
+    jit_func = njit(py_func)
+    arrays = [
+        np.ones((1, 3)),
+        np.arange(15.0).reshape(5, 3),
+        np.ones((1, 3)),
+        np.arange(15.0).reshape(3, 5).T,
+        np.ones((5, 1)),
+    ]
+    for arr in arrays:
+        assert_equal(py_func(arr), jit_func(arr))
+
+
+def _readonly(a):
+    a = a.copy()
+    a.flags.writeable = False
+    return a
+
+
+_dispatch_base = np.arange(48, dtype=np.int64).reshape(6, 8)
+
+
+@pytest.mark.parametrize(
+    "arrays",
+    [
+        # dtype
+        [_dispatch_base, _dispatch_base.astype(np.float64)],
+        [_dispatch_base, _dispatch_base.astype(np.complex128)],
+        # integer width and signedness
+        [_dispatch_base.astype(t) for t in [np.int8, np.int16, np.int32, np.int64]],
+        [_dispatch_base.astype(np.int32), _dispatch_base.astype(np.uint32)],
+        # layout
+        [_dispatch_base, _dispatch_base.T, _dispatch_base[:, ::2]],
+        # writeable flag
+        [_dispatch_base, _readonly(_dispatch_base)],
+        [_dispatch_base.T, _readonly(_dispatch_base.T)],
+    ],
+)
+def test_dispatch_cache_miss(arrays):
+    def py_func(a):
+        return a[1, 1] + a.sum()
+
+    jit_func = njit(py_func)
+    if jit_func._dispatch_cache is None:
+        pytest.skip("Dispatch cache is disabled")
+
+    # Each array type must get its own overload and cache entry, calling with
+    # the same arrays again must hit the cache.
+    for i, arr in enumerate(arrays):
+        assert_equal(py_func(arr), jit_func(arr))
+        assert len(jit_func.overloads) == i + 1
+        assert len(jit_func._dispatch_cache) == i + 1
+
+    for arr in reversed(arrays):
+        assert_equal(py_func(arr), jit_func(arr))
+
+    assert len(jit_func.overloads) == len(arrays)
+    assert len(jit_func._dispatch_cache) == len(arrays)
+
+
 @pytest.mark.parametrize(
     "arr", [np.arange(12).reshape(3, 4), np.arange(60).reshape(3, 4, 5)]
 )
@@ -2164,6 +2461,46 @@ def test_copy_self_alias():
     assert_equal(py_func(N), jit_func(N))
 
 
+_copy_views = [
+    "lambda a: a",
+    "lambda a: a[::2]",
+    "lambda a: a[1:, 2:5]",
+    "lambda a: a[:, ::-1]",
+    "lambda a: a[::-2, :, ::3]",
+    "lambda a: a.T",
+    "lambda a: a[:0]",
+]
+
+
+def _copy_to(a, b):
+    b[:] = a
+    return b
+
+
+@parametrize_function_variants(
+    "py_func", ["lambda a, b: a.copy()", "lambda a, b: np.copy(a)", "_copy_to"]
+)
+@parametrize_function_variants("view", _copy_views)
+@pytest.mark.parametrize(
+    "dtype", [np.int8, np.int16, np.int32, np.int64, np.float32, np.float64]
+)
+def test_copy_views(py_func, view, dtype):
+    jit_func = njit(py_func)
+    a = view(np.arange(6 * 7 * 8).astype(dtype).reshape(6, 7, 8))
+    assert_equal(py_func(a, np.zeros_like(a)), jit_func(a, np.zeros_like(a)))
+
+
+@parametrize_function_variants("py_func", ["lambda a, b: a.copy()", "_copy_to"])
+@parametrize_function_variants(
+    "view", ["lambda a: a", "lambda a: a[:, ::2]", "lambda a: a[::-1]"]
+)
+def test_copy_views_large(py_func, view):
+    # Copies of 4MiB and above are split between threads.
+    jit_func = njit(py_func)
+    a = view(np.arange(1024 * 1024, dtype=np.float64).reshape(1024, 1024))
+    assert_equal(py_func(a, np.zeros_like(a)), jit_func(a, np.zeros_like(a)))
+
+
 def _cov(m, y=None, rowvar=True, bias=False, ddof=None):
     return np.cov(m, y, rowvar, bias, ddof)
 
@@ -2416,6 +2753,55 @@ def test_matmul2(py_func, a, b, dtype):
     assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-4, atol=1e-7)
 
 
+def _matmul_arange(dtype, *shape):
+    return (np.arange(np.prod(shape)) % 7).astype(dtype).reshape(shape)
+
+
+# Views are created after dtype conversion to keep their strides.
+@pytest.mark.parametrize(
+    "get_args",
+    [
+        lambda f: (f(97, 300), f(300, 261)),
+        lambda f: (f(300, 97).T, f(300, 261)),
+        lambda f: (f(200, 300)[::2, ::-1], f(261, 300).T),
+        lambda f: (f(5, 600), f(600, 3)),
+    ],
+)
+@pytest.mark.parametrize("dtype", [np.float32, np.float64])
+@pytest.mark.parametrize("parallel", [False, True])
+def test_matmul_large(get_args, dtype, parallel):
+    def py_func(a, b):
+        return a @ b
+
+    a, b = get_args(partial(_matmul_arange, dtype))
+    jit_func = njit(py_func, parallel=parallel)
+    assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-4, atol=1e-7)
+
+
+@pytest.mark.parametrize(
+    "get_args",
+    [
+        lambda f: (f(300, 97), f(97)),
+        lambda f: (f(97, 300).T, f(97)),
+        lambda f: (f(97), f(97, 300)),
+        lambda f: (f(200, 300)[::2, ::-1], f(600)[::2]),
+        lambda f: (f(4, 30, 20), f(4, 20, 10)),
+        lambda f: (f(4, 20, 30).transpose(0, 2, 1), f(20, 10)),
+        lambda f: (f(30, 20), f(3, 20, 10)),
+        lambda f: (f(1, 30, 20), f(3, 20, 10)),
+    ],
+)
+@pytest.mark.parametrize("dtype", [np.float32, np.float64])
+@pytest.mark.parametrize("parallel", [False, True])
+def test_matmul_gemv_batch(get_args, dtype, parallel):
+    def py_func(a, b):
+        return a @ b
+
+    a, b = get_args(partial(_matmul_arange, dtype))
+    jit_func = njit(py_func, parallel=parallel)
+    assert_allclose(py_func(a, b), jit_func(a, b), rtol=1e-4, atol=1e-7)
+
+
 def test_batchnorm():
     def py_func(x, eps=1e-5):
         # mean = np.mean(x, axis=0, keepdims=True)
@@ -0,0 +1,480 @@
+# SPDX-FileCopyrightText: 2023 Intel Corporation
+#
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import ctypes
+import itertools
+import threading
+import time
+import numpy as np
+import pytest
+from numpy.testing import assert_equal
+
+from numba_mlir.mlir.runtime import runtime_lib
+from .utils import njit_cached as njit
+
+
+_pool_alloc = runtime_lib.nmrtPoolAlloc
+_pool_alloc.argtypes = [ctypes.c_size_t, ctypes.c_uint32]
+_pool_alloc.restype = ctypes.c_void_p
+
+_pool_free = runtime_lib.nmrtPoolFree
+_pool_free.argtypes = [ctypes.c_void_p]
+
+_pool_cached_size = runtime_lib.nmrtPoolGetCachedSize
+_pool_cached_size.restype = ctypes.c_size_t
+
+
+class _MemInfo(ctypes.Structure):
+    _fields_ = [
+        ("refcnt", ctypes.c_size_t),
+        ("dtor", ctypes.c_void_p),
+        ("dtor_info", ctypes.c_void_p),
+        ("data", ctypes.c_void_p),
+        ("size", ctypes.c_size_t),
+        ("external_allocator", ctypes.c_void_p),
+    ]
+
+
+def _get_meminfo(ptr):
+    return _MemInfo.from_address(ptr)
+
+
+@pytest.mark.parametrize("align", [0, 1, 8, 64, 128, 4096, 24])
+@pytest.mark.parametrize("size", [0, 1, 100, 4096, 2 * 1024 * 1024])
+def test_pool_alloc(size, align):
+    ptr = _pool_alloc(size, align)
+    assert ptr
+    try:
+        meminfo = _get_meminfo(ptr)
+        assert meminfo.refcnt == 1
+        assert meminfo.size == size
+        if align > 0:
+            assert meminfo.data % align == 0
+
+        ctypes.memset(meminfo.data, 0x5A, size)
+    finally:
+        _pool_free(ptr)
+
+
+def test_pool_reuse():
+    ptr1 = _pool_alloc(100, 8)
+    data1 = _get_meminfo(ptr1).data
+    _pool_free(ptr1)
+    cached = _pool_cached_size()
+    assert cached > 0
+
+    ptr2 = _pool_alloc(100, 8)
+    assert ptr2 == ptr1
+    assert _get_meminfo(ptr2).data == data1
+    assert _pool_cached_size() < cached
+    _pool_free(ptr2)
+
+
+def test_pool_retention_limit():
+    # Sizes in all classes from 64KB to 1MB, 4MB each, freed all at once must
+    # not be retained entirely.
+    ptrs = []
+    for shift in range(16, 21):
+        block = 1 << shift
+        ptrs += [_pool_alloc(block - 64, 8) for _ in range((4 << 20) // block)]
+
+    assert all(ptrs)
+    for ptr in ptrs:
+        _pool_free(ptr)
+
+    assert 0 < _pool_cached_size() <= 16 << 20
+
+
+def test_pool_temporaries():
+    def py_func(a):
+        res = 0.0
+        for i in range(a.shape[0]):
+            t = a * i
+            res += t.sum()
+        return res
+
+    jit_func = njit(py_func)
+    a = np.arange(100.0)
+    for _ in range(3):
+        assert_equal(py_func(a), jit_func(a))
+
+
+_create_token = runtime_lib.nmrtCreateAllocToken
+_create_token.restype = ctypes.c_void_p
+
+_destroy_token = runtime_lib.nmrtDestroyAllocToken
+_destroy_token.argtypes = [ctypes.c_void_p]
+
+_token_cached_count = runtime_lib.nmrtAllocTokenGetCachedCount
+_token_cached_count.restype = ctypes.c_size_t
+
+_token_pool_count = runtime_lib.nmrtAllocTokenGetPoolCount
+_token_pool_count.restype = ctypes.c_size_t
+
+
+def _run_in_thread(func):
+    res = []
+    thread = threading.Thread(target=lambda: res.append(func()))
+    thread.start()
+    thread.join()
+    return res[0]
+
+
+def test_alloc_token_reuse():
+    def thread_func():
+        token1 = _create_token()
+        _destroy_token(token1)
+        token2 = _create_token()
+        _destroy_token(token2)
+        return token1, token2
+
+    token1, token2 = _run_in_thread(thread_func)
+    assert token1
+    assert token1 == token2
+
+
+def test_alloc_token_cache_limit():
+    def thread_func():
+        tokens = [_create_token() for _ in range(2000)]
+        assert len(set(tokens)) == len(tokens)
+        for token in tokens:
+            _destroy_token(token)
+
+        return _token_cached_count()
+
+    # Per-thread cache is capped at 2 batches of 256 tokens.
+    assert 0 < _run_in_thread(thread_func) <= 512
+
+
+def test_alloc_token_thread_exit():
+    cached = []
+    freed = []
+    can_exit = threading.Event()
+    done = threading.Event()
+
+    def thread_func():
+        tokens = [_create_token() for _ in range(100)]
+        for token in tokens:
+            _destroy_token(token)
+
+        freed.extend(tokens)
+        cached.append(_token_cached_count())
+        done.set()
+        can_exit.wait()
+
+    thread = threading.Thread(target=thread_func)
+    thread.start()
+    done.wait()
+    pool_count = _token_pool_count()
+    can_exit.set()
+    thread.join()
+
+    # Exiting thread returns its cache to the global pool and the next thread
+    # picks up the same tokens.
+    assert cached[0] >= len(freed)
+    assert _token_pool_count() == pool_count + cached[0]
+
+    def thread_func2():
+        token = _create_token()
+        _destroy_token(token)
+        return token
+
+    assert _run_in_thread(thread_func2) in freed
+
+
+@pytest.mark.parametrize("num_threads", [1, 8])
+def test_alloc_token_unique(num_threads):
+    lock = threading.Lock()
+    live = set()
+    handoff = []
+    errors = []
+
+    def thread_func(seed):
+        rnd = np.random.RandomState(seed)
+        for _ in range(50):
+            tokens = [_create_token() for _ in range(rnd.randint(1, 700))]
+            with lock:
+                for token in tokens:
+                    if not token:
+                        errors.append("Null token")
+                    elif token in live:
+                        errors.append(f"Token {token} is handed out twice")
+                    live.add(token)
+
+                # Pass half of tokens to other threads, so they are destroyed
+                # on a different thread they were created.
+                handoff.extend(tokens[::2])
+                tokens = tokens[1::2]
+                count = min(len(handoff), rnd.randint(0, 700))
+                tokens += handoff[:count]
+                del handoff[:count]
+                live.difference_update(tokens)
+
+            for token in tokens:
+                _destroy_token(token)
+
+        # Threads exit with cached tokens and tokens pending in handoff.
+
+    threads = [
+        threading.Thread(target=thread_func, args=(i,)) for i in range(num_threads)
+    ]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    for token in handoff:
+        _destroy_token(token)
+
+    assert not errors, errors[:10]
+
+
+_context_func_type = ctypes.CFUNCTYPE(None, ctypes.c_void_p)
+
+_take_context = runtime_lib.nmrtTakeContext
+_take_context.argtypes = [
+    ctypes.POINTER(ctypes.c_void_p),
+    ctypes.c_size_t,
+    _context_func_type,
+    _context_func_type,
+]
+_take_context.restype = ctypes.c_void_p
+
+_release_context = runtime_lib.nmrtReleaseContext
+_release_context.argtypes = [ctypes.c_void_p]
+
+_purge_context = runtime_lib.nmrtPurgeContext
+_purge_context.argtypes = [ctypes.POINTER(ctypes.c_void_p)]
+
+
+@pytest.mark.parametrize("num_threads", [1, 8])
+def test_context_pool(num_threads):
+    lock = threading.Lock()
+    initialized = set()
+    released = []
+    in_use = set()
+    errors = []
+
+    @_context_func_type
+    def init(ptr):
+        with lock:
+            initialized.add(ptr)
+
+    @_context_func_type
+    def deinit(ptr):
+        with lock:
+            released.append(ptr)
+
+    handle = ctypes.c_void_p(0)
+
+    def thread_func():
+        for _ in range(200):
+            ctx = _take_context(ctypes.byref(handle), 16, init, deinit)
+            with lock:
+                if ctx not in initialized:
+                    errors.append(f"Uninitialized context {ctx}")
+                if ctx in in_use:
+                    errors.append(f"Context {ctx} is shared")
+                in_use.add(ctx)
+
+            time.sleep(0)
+            with lock:
+                in_use.remove(ctx)
+            _release_context(ctx)
+
+    threads = [threading.Thread(target=thread_func) for _ in range(num_threads)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    assert not errors, errors[:10]
+    assert 0 < len(initialized) <= num_threads
+    assert released == []
+
+    # Contexts are only deinitialized on purge, each exactly once.
+    _purge_context(ctypes.byref(handle))
+    assert handle.value is None
+    assert sorted(released) == sorted(initialized)
+
+
+class _InputRange(ctypes.Structure):
+    _fields_ = [
+        ("lower", ctypes.c_ssize_t),
+        ("upper", ctypes.c_ssize_t),
+        ("step", ctypes.c_ssize_t),
+    ]
+
+
+class _Range(ctypes.Structure):
+    _fields_ = [
+        ("lower", ctypes.c_ssize_t),
+        ("upper", ctypes.c_ssize_t),
+    ]
+
+
+_parallel_for_func_type = ctypes.CFUNCTYPE(
+    None, ctypes.POINTER(_Range), ctypes.c_size_t, ctypes.c_void_p
+)
+
+_parallel_for = runtime_lib.nmrtParallelFor
+_parallel_for.argtypes = [
+    ctypes.POINTER(_InputRange),
+    ctypes.c_size_t,
+    _parallel_for_func_type,
+    ctypes.c_void_p,
+    ctypes.c_int32,
+    ctypes.c_size_t,
+]
+
+
+@pytest.mark.parametrize(
+    "loops",
+    [
+        [(0, 100, 7)],
+        [(0, 9, 2), (1, 50, 3)],
+        [(-4, 5, 3), (0, 7, 1), (2, 19, 4)],
+        [(0, 7, 1), (1, 10, 3), (-5, 4, 2), (2, 3, 1)],
+        [(0, 5, 2), (3, 17, 4), (0, 2, 1), (-3, 8, 5), (1, 12, 3)],
+        [(0, 3, 1), (0, 1, 1), (0, 4, 3), (5, 6, 1), (0, 13, 6), (1, 3, 1)],
+    ],
+    ids=["1d", "2d", "3d", "4d", "5d", "6d"],
+)
+@pytest.mark.parametrize("grain", [0, 1, 5])
+@pytest.mark.parametrize("schedule", [0, 1, 2, 3])
+def test_parallel_for(loops, schedule, grain):
+    visited = []
+    errors = []
+
+    # Chunks must be rectangular sub-ranges starting at the loop steps, and
+    # together visit every iteration exactly once. Upper bound may be either
+    # aligned to the step or the original loop bound.
+    @_parallel_for_func_type
+    def body(ranges, thread_index, ctx):
+        chunk = []
+        for i, (lower, upper, step) in enumerate(loops):
+            r = ranges[i]
+            if r.lower >= r.upper or r.lower < lower or r.lower >= upper:
+                errors.append(f"Invalid range {i}: {(r.lower, r.upper)}")
+                return
+            if (r.lower - lower) % step != 0:
+                errors.append(f"Unaligned range {i}: {(r.lower, r.upper)}")
+                return
+            if r.upper - step >= upper:
+                errors.append(f"Range {i} out of bounds: {(r.lower, r.upper)}")
+                return
+
+            chunk.append(range(r.lower, r.upper, step))
+
+        visited.extend(itertools.product(*chunk))
+
+    inputs = (_InputRange * len(loops))(*loops)
+    _parallel_for(inputs, len(loops), body, None, schedule, grain)
+
+    assert not errors, errors[:10]
+    expected = list(itertools.product(*(range(*l) for l in loops)))
+    assert sorted(visited) == expected
+
+
+class _UnrankedMemRef(ctypes.Structure):
+    _fields_ = [
+        ("rank", ctypes.c_int64),
+        ("descriptor", ctypes.c_void_p),
+    ]
+
+
+def _get_memref_desc(arr):
+    rank = arr.ndim
+
+    class MemRefDesc(ctypes.Structure):
+        _fields_ = [
+            ("allocated", ctypes.c_void_p),
+            ("aligned", ctypes.c_void_p),
+            ("offset", ctypes.c_int64),
+            ("sizes", ctypes.c_int64 * rank),
+            ("strides", ctypes.c_int64 * rank),
+        ]
+
+    data = arr.__array_interface__["data"][0]
+    strides = [s // arr.itemsize for s in arr.strides]
+    desc = MemRefDesc(data, data, 0, tuple(arr.shape), tuple(strides))
+    return _UnrankedMemRef(rank, ctypes.addressof(desc)), desc
+
+
+_memref_copy = runtime_lib.memrefCopy
+_memref_copy.argtypes = [
+    ctypes.c_int64,
+    ctypes.POINTER(_UnrankedMemRef),
+    ctypes.POINTER(_UnrankedMemRef),
+]
+
+
+def _copy_memref(src, dst):
+    assert src.shape == dst.shape and src.dtype == dst.dtype
+    # Descriptors must stay alive until the call returns.
+    src_memref, src_desc = _get_memref_desc(src)
+    dst_memref, dst_desc = _get_memref_desc(dst)
+    _memref_copy(src.itemsize, ctypes.byref(src_memref), ctypes.byref(dst_memref))
+
+
+def _make_array(shape, dtype):
+    return np.arange(1, np.prod(shape, dtype=np.int64) + 1).astype(dtype).reshape(shape)
+
+
+def _flip(a):
+    # Trailing ellipsis keeps 0-d result an array instead of a scalar.
+    return a[(slice(None, None, -1),) * a.ndim + (Ellipsis,)]
+
+
+_copy_src_views = {
+    "scalar": ((), lambda a: a),
+    "contiguous_1d": ((17,), lambda a: a),
+    "contiguous_3d": ((4, 5, 6), lambda a: a),
+    "collapse_inner": ((4, 5, 6), lambda a: a[::2]),
+    "collapse_inner_offset": ((4, 5, 6), lambda a: a[1:, 1:4]),
+    "unit_dim": ((4, 1, 6), lambda a: a[::-1]),
+    "negative_1d": ((17,), lambda a: a[::-1]),
+    "strided_1d": ((17,), lambda a: a[::3]),
+    "negative_strided_2d": ((6, 7), lambda a: a[::-2, ::3]),
+    "transposed": ((6, 7), lambda a: a.T),
+    "empty_outer": ((0, 5), lambda a: a),
+    "empty_inner": ((5, 0), lambda a: a[::-1]),
+}
+
+_copy_dst_views = {
+    "c_order": lambda shape, dtype: np.zeros(shape, dtype),
+    "f_order": lambda shape, dtype: np.zeros(shape[::-1], dtype).T,
+    "negative": lambda shape, dtype: _flip(np.zeros(shape, dtype)),
+}
+
+
+@pytest.mark.parametrize(
+    "dtype", [np.int8, np.int16, np.float32, np.int64, np.complex128, "S3"]
+)
+@pytest.mark.parametrize(
+    "dst_view", list(_copy_dst_views.values()), ids=list(_copy_dst_views.keys())
+)
+@pytest.mark.parametrize(
+    "src_view", list(_copy_src_views.values()), ids=list(_copy_src_views.keys())
+)
+def test_memref_copy(src_view, dst_view, dtype):
+    shape, view = src_view
+    src = view(_make_array(shape, dtype))
+    dst = dst_view(src.shape, src.dtype)
+    _copy_memref(src, dst)
+    assert_equal(dst, src)
+
+
+@pytest.mark.parametrize(
+    "view",
+    [lambda a: a, lambda a: a[:, ::2], lambda a: a[::-1], lambda a: a.T],
+    ids=["contiguous", "strided", "negative", "transposed"],
+)
+def test_memref_copy_parallel(view):
+    # Copies of 4MiB and above are split between threads.
+    src = view(_make_array((1024, 1024), np.float64))
+    assert src.nbytes >= 4 << 20
+    dst = np.zeros_like(src)
+    _copy_memref(src, dst)
+    assert_equal(dst, src)
@@ -4,7 +4,12 @@
 
 from numba_mlir import njit
 import inspect
+import json
+import os
 import pytest
+import subprocess
+import sys
+import textwrap
 
 
 def parametrize_function_variants(name, strings):
@@ -34,3 +39,30 @@ class JitfuncCache:
 
 njit_cache = JitfuncCache(njit)
 njit_cached = njit_cache.cached_decorator
+
+
+def run_isolated(code, **env):
+    # Execution engine settings are read once at the import time, run each
+    # configuration in the separate interpreter.
+    script = textwrap.dedent(
+        """
+        import json
+        import numpy as np
+        from numba_mlir import njit
+        from numba_mlir import mlir_compiler
+        from numba_mlir.mlir.compiler_context import global_compiler_context
+
+        def get_stats():
+            return mlir_compiler.get_execution_engine_stats(global_compiler_context)
+
+        """
+    )
+    script += textwrap.dedent(code)
+    res = subprocess.run(
+        [sys.executable, "-c", script],
+        env={**os.environ, **env},
+        capture_output=True,
+        text=True,
+    )
+    assert res.returncode == 0, res.stderr
+    return json.loads(res.stdout.strip().splitlines()[-1])
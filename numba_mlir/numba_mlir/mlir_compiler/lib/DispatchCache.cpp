@@ -0,0 +1,297 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "DispatchCache.hpp"
+
+#include <pybind11/pybind11.h>
+
+#include <string>
+#include <unordered_map>
+
+#define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
+
+#include <numpy/arrayobject.h>
+
+namespace py = pybind11;
+
+// Numba dispatcher resolves argument types through process-wide typecode
+// caches, keyed by array dtype, ndim and layout, and calls Python `typeof` for
+// everything else. Our array types additionally depend on size 0 and 1
+// dimensions (`FixedArray`), and Python fallback is slow, so dispatcher keeps
+// its own table of compiled entry points, keyed by compact argument
+// fingerprint computed here.
+//
+// Fingerprint must uniquely determine `typeof(arg, Purpose.argument)` type.
+// If any argument cannot be fingerprinted, cache is bypassed and call goes
+// through the regular numba dispatch.
+
+namespace {
+enum : char {
+  FpNone = 'n',
+  FpBool = 'b',
+  FpInt = 'i',
+  FpFloat = 'f',
+  FpComplex = 'c',
+  FpTupleBegin = '(',
+  FpTupleEnd = ')',
+  FpArray = 'a',
+  FpLayoutC = 'C',
+  FpLayoutF = 'F',
+  FpLayoutA = 'A',
+  FpReadonly = 'r',
+  FpWritable = 'w',
+  FpDimZero = '0',
+  FpDimOne = '1',
+  FpDimAny = 'x',
+};
+
+static bool initNumpy() {
+  static bool init = []() -> bool {
+    import_array1(false);
+    return true;
+  }();
+
+  return init;
+}
+
+static bool isSupportedDtype(PyArray_Descr *descr) {
+  if (!PyArray_ISNBO(descr->byteorder))
+    return false;
+
+  switch (descr->type_num) {
+  case NPY_BOOL:
+  case NPY_BYTE:
+  case NPY_UBYTE:
+  case NPY_SHORT:
+  case NPY_USHORT:
+  case NPY_INT:
+  case NPY_UINT:
+  case NPY_LONG:
+  case NPY_ULONG:
+  case NPY_LONGLONG:
+  case NPY_ULONGLONG:
+  case NPY_FLOAT:
+  case NPY_DOUBLE:
+  case NPY_CFLOAT:
+  case NPY_CDOUBLE:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static bool fingerprintArray(PyArrayObject *arr, std::string &out) {
+  auto descr = PyArray_DESCR(arr);
+  if (!isSupportedDtype(descr))
+    return false;
+
+  out += FpArray;
+  out += static_cast<char>(descr->type_num);
+
+  // Must match `numpy_support.map_layout`.
+  if (PyArray_IS_C_CONTIGUOUS(arr)) {
+    out += FpLayoutC;
+  } else if (PyArray_IS_F_CONTIGUOUS(arr)) {
+    out += FpLayoutF;
+  } else {
+    out += FpLayoutA;
+  }
+
+  out += PyArray_ISWRITEABLE(arr) ? FpWritable : FpReadonly;
+
+  // Must match `array_type.get_fixed_dims`, ndim is encoded implicitly.
+  auto ndim = PyArray_NDIM(arr);
+  auto shape = PyArray_DIMS(arr);
+  for (int i = 0; i < ndim; ++i) {
+    auto dim = shape[i];
+    out += (dim == 0 ? FpDimZero : (dim == 1 ? FpDimOne : FpDimAny));
+  }
+  out += FpTupleEnd;
+  return true;
+}
+
+static bool fingerprint(PyObject *obj, std::string &out) {
+  if (obj == Py_None) {
+    out += FpNone;
+    return true;
+  }
+
+  // Bool is a subclass of int, so must be checked first.
+  if (PyBool_Check(obj)) {
+    out += FpBool;
+    return true;
+  }
+
+  if (PyLong_CheckExact(obj)) {
+    // Large values are typed as uint64 or rejected, leave them to numba.
+    int overflow = 0;
+    auto val = PyLong_AsLongLongAndOverflow(obj, &overflow);
+    if (overflow != 0 || (val == -1 && PyErr_Occurred())) {
+      PyErr_Clear();
+      return false;
+    }
+
+    out += FpInt;
+    return true;
+  }
+
+  if (PyFloat_CheckExact(obj)) {
+    out += FpFloat;
+    return true;
+  }
+
+  if (PyComplex_CheckExact(obj)) {
+    out += FpComplex;
+    return true;
+  }
+
+  if (PyTuple_CheckExact(obj)) {
+    out += FpTupleBegin;
+    auto size = PyTuple_GET_SIZE(obj);
+    for (Py_ssize_t i = 0; i < size; ++i)
+      if (!fingerprint(PyTuple_GET_ITEM(obj, i), out))
+        return false;
+
+    out += FpTupleEnd;
+    return true;
+  }
+
+  // Subclasses and other array-like objects have their own typeof handlers.
+  if (PyArray_CheckExact(obj))
+    return fingerprintArray(reinterpret_cast<PyArrayObject *>(obj), out);
+
+  return false;
+}
+
+static py::handle getMissTag() {
+  // Intentionally leaked, can be accessed during interpreter shutdown.
+  static auto *tag = new py::object(
+      py::module_::import("builtins").attr("object")());
+  return *tag;
+}
+
+class DispatchCache {
+public:
+  DispatchCache(Py_ssize_t numPositional, bool hasVarargs)
+      : numPositional(numPositional), hasVarargs(hasVarargs) {}
+
+  /// Call cached entry point for `args`. Returns miss tag if args cannot be
+  /// fingerprinted or there is no entry point for them yet.
+  py::object call(const py::tuple &args) {
+    std::string key;
+    if (!getKey(args, key))
+      return py::reinterpret_borrow<py::object>(getMissTag());
+
+    auto it = entries.find(key);
+    if (it == entries.end())
+      return py::reinterpret_borrow<py::object>(getMissTag());
+
+    // Keep entry alive in case it is cleared by the callee.
+    auto entry = it->second;
+    auto callArgs = foldArgs(args);
+    auto res = PyObject_Call(entry.ptr(), callArgs.ptr(), nullptr);
+    if (!res)
+      throw py::error_already_set();
+
+    return py::reinterpret_steal<py::object>(res);
+  }
+
+  bool isCacheable(const py::tuple &args) const {
+    std::string key;
+    return getKey(args, key);
+  }
+
+  /// Associate compiled entry point with arguments fingerprint. Returns false
+  /// if args cannot be fingerprinted.
+  bool insert(const py::tuple &args, py::object entry) {
+    std::string key;
+    if (!getKey(args, key))
+      return false;
+
+    entries.insert_or_assign(std::move(key), std::move(entry));
+    return true;
+  }
+
+  void clear() { entries.clear(); }
+
+  /// Pack varargs into tuple, as expected by compiled entry points.
+  py::tuple foldArgs(const py::tuple &args) const {
+    if (!hasVarargs)
+      return args;
+
+    auto count = static_cast<size_t>(numPositional);
+    py::tuple ret(count + 1);
+    for (size_t i = 0; i < count; ++i)
+      ret[i] = args[i];
+
+    py::tuple varargs(args.size() - count);
+    for (size_t i = count; i < args.size(); ++i)
+      varargs[i - count] = args[i];
+
+    ret[count] = std::move(varargs);
+    return ret;
+  }
+
+  size_t size() const { return entries.size(); }
+
+private:
+  Py_ssize_t numPositional;
+  bool hasVarargs;
+  std::unordered_map<std::string, py::object> entries;
+
+  bool getKey(const py::tuple &args, std::string &key) const {
+    // Omitted args are filled with defaults and extra args are error unless
+    // function has varargs, leave both cases to numba.
+    auto size = static_cast<Py_ssize_t>(args.size());
+    if (size < numPositional || (!hasVarargs && size != numPositional))
+      return false;
+
+    if (!initNumpy()) {
+      PyErr_Clear();
+      return false;
+    }
+
+    for (auto arg : args)
+      if (!fingerprint(arg.ptr(), key))
+        return false;
+
+    return true;
+  }
+};
+
+/// `NumbaMLIRDispatcher.__call__` implementation. Cache hits are handled
+/// without entering Python code, everything else is forwarded to the
+/// dispatcher `_call_miss` or `_call_uncached` methods.
+static py::object dispatcherCall(py::handle self, py::args args,
+                                 py::kwargs kwargs) {
+  if (!kwargs.empty())
+    return self.attr("_call_uncached")(*args, **kwargs);
+
+  auto cacheObj = self.attr("_dispatch_cache");
+  if (cacheObj.is_none())
+    return self.attr("_call_uncached")(*args);
+
+  auto res = cacheObj.cast<DispatchCache &>().call(args);
+  if (!res.is(getMissTag()))
+    return res;
+
+  return self.attr("_call_miss")(*args);
+}
+} // namespace
+
+void registerDispatchCache(py::module_ &m) {
+  m.def("set_dispatcher_call", [](py::object cls) {
+    py::setattr(cls, "__call__",
+                py::cpp_function(&dispatcherCall, py::name("__call__"),
+                                 py::is_method(cls)));
+  });
+  py::class_<DispatchCache>(m, "DispatchCache")
+      .def(py::init<Py_ssize_t, bool>())
+      .def("call", &DispatchCache::call)
+      .def("is_cacheable", &DispatchCache::isCacheable)
+      .def("insert", &DispatchCache::insert)
+      .def("clear", &DispatchCache::clear)
+      .def("fold_args", &DispatchCache::foldArgs)
+      .def("__len__", &DispatchCache::size);
+}
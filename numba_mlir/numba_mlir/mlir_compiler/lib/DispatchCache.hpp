@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+namespace pybind11 {
+class module_;
+}
+
+/// Register `DispatchCache` class, used by `NumbaMLIRDispatcher` to call
+/// already compiled overloads without going through numba type resolution,
+/// and `set_dispatcher_call` function, which installs C++ `__call__` doing
+/// cache lookup into dispatcher class.
+void registerDispatchCache(pybind11::module_ &m);
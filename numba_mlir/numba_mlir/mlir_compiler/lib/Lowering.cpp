@@ -6,6 +6,8 @@
 
 #include <algorithm>
 #include <array>
+#include <map>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -21,11 +23,14 @@
 #include <mlir/Dialect/Func/Extensions/InlinerExtension.h>
 #include <mlir/Dialect/Func/IR/FuncOps.h>
 #include <mlir/Dialect/GPU/Transforms/BufferDeallocationOpInterfaceImpl.h>
+#include <mlir/Dialect/LLVMIR/LLVMDialect.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Dialect/SCF/Transforms/BufferDeallocationOpInterfaceImpl.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/BuiltinOps.h>
 #include <mlir/IR/BuiltinTypes.h>
+#include <mlir/IR/OwningOpRef.h>
+#include <mlir/IR/SymbolTable.h>
 
 #include <mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h>
 #include <mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h>
@@ -36,12 +41,14 @@
 #include <llvm/Support/Debug.h>
 #include <llvm/Support/ManagedStatic.h>
 #include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/ThreadPool.h>
 
 #include "numba/Dialect/gpu_runtime/IR/GpuRuntimeOps.hpp"
 #include "numba/Dialect/ntensor/IR/NTensorOps.hpp"
 #include "numba/Dialect/numba_util/Dialect.hpp"
 #include "numba/Dialect/plier/Dialect.hpp"
 
+#include "numba/Compiler/CompileProfiler.hpp"
 #include "numba/Compiler/Compiler.hpp"
 #include "numba/Compiler/PipelineRegistry.hpp"
 #include "numba/ExecutionEngine/ExecutionEngine.hpp"
@@ -294,6 +301,18 @@ static mlir::Attribute parseAttr(mlir::OpBuilder &builder, py::handle obj) {
   if (py::isinstance<py::int_>(obj))
     return builder.getI64IntegerAttr(getPyInt(obj));
 
+  if (py::isinstance<py::tuple>(obj)) {
+    llvm::SmallVector<int64_t> values;
+    for (auto item : obj.cast<py::tuple>()) {
+      if (!py::isinstance<py::int_>(item))
+        numba::reportError(llvm::Twine("Invalid attribute: ") +
+                           py::str(obj).cast<std::string>());
+
+      values.emplace_back(getPyInt(item));
+    }
+    return builder.getDenseI64ArrayAttr(values);
+  }
+
   numba::reportError(llvm::Twine("Invalid attribute: ") +
                      py::str(obj).cast<std::string>());
 }
@@ -1297,6 +1316,10 @@ numba::CompilerContext::Settings getSettings(py::handle settings,
 
 struct ModuleSettings {
   bool enableGpuPipeline = false;
+
+  /// Number of threads for MLIR pass execution, 0 means hardware concurrency
+  /// and 1 disables multithreading.
+  unsigned compileThreads = 0;
 };
 
 static void createPipeline(numba::PipelineRegistry &registry,
@@ -1346,28 +1369,123 @@ struct DialectReg {
   }
 };
 
-struct Module {
+static llvm::ThreadPool &getCompilerThreadPool(unsigned numThreads) {
+  // Pool is shared between all contexts and intentionally leaked, so it
+  // outlives any context still alive during interpreter shutdown. Threads
+  // count is defined by the first call.
+  static auto *pool =
+      new llvm::ThreadPool(llvm::hardware_concurrency(numThreads));
+  return *pool;
+}
+
+/// Compiler state which can be shared between modules with the same
+/// `ModuleSettings`: context with loaded dialects, pipelines and constructed
+/// pass managers.
+struct CompilerSession {
   DialectReg dialectReg;
   mlir::MLIRContext context;
   numba::PipelineRegistry registry;
-  mlir::ModuleOp module;
   PyTypeConverter typeConverter;
 
-  Module(const ModuleSettings &settings) : context(dialectReg.registry) {
+  /// Lowered callee functions, detached from any module and keyed by the
+  /// token assigned on the python side. Declared after `context`, so they are
+  /// destroyed first.
+  llvm::DenseMap<uint64_t, mlir::OwningOpRef<mlir::func::FuncOp>> cachedFuncs;
+
+  /// Number of modules created with this session.
+  unsigned modulesCount = 0;
+
+  /// Number of compilers constructed by `takeCompiler`.
+  unsigned compilersCount = 0;
+
+  CompilerSession(const ModuleSettings &settings)
+      : context(dialectReg.registry, mlir::MLIRContext::Threading::DISABLED) {
+    if (settings.compileThreads != 1)
+      context.setThreadPool(getCompilerThreadPool(settings.compileThreads));
+
     createPipeline(registry, typeConverter, settings);
+    mlir::registerLLVMDialectTranslation(context);
+    mlir::registerBuiltinDialectTranslation(context);
+  }
+
+  /// Get compiler for the specified settings, either cached or newly created.
+  /// Compilation can be reentrant (resolving python function can trigger
+  /// nested compilation), so compilers are taken from the pool and must be
+  /// returned via `releaseCompiler` after use.
+  numba::CompilerContext
+  takeCompiler(const numba::CompilerContext::Settings &settings) {
+    if (auto key = getCompilerKey(settings)) {
+      auto it = compilers.find(*key);
+      if (it != compilers.end() && !it->second.empty())
+        return it->second.pop_back_val();
+    }
+    ++compilersCount;
+    return numba::CompilerContext(context, settings, registry);
+  }
+
+  void releaseCompiler(const numba::CompilerContext::Settings &settings,
+                       numba::CompilerContext compiler) {
+    if (auto key = getCompilerKey(settings))
+      compilers[*key].emplace_back(std::move(compiler));
+  }
+
+private:
+  llvm::DenseMap<unsigned, llvm::SmallVector<numba::CompilerContext, 1>>
+      compilers;
+
+  static std::optional<unsigned>
+  getCompilerKey(const numba::CompilerContext::Settings &settings) {
+    // Statistics and timings are reported on pass manager destruction and
+    // IR printing references per-compilation stream, do not cache these.
+    if (settings.passStatistics || settings.passTimings || settings.irPrinting)
+      return std::nullopt;
+
+    return static_cast<unsigned>(settings.verify) |
+           (static_cast<unsigned>(settings.irDumpStderr) << 1) |
+           (static_cast<unsigned>(settings.diagDumpStderr) << 2);
   }
 };
 
+struct Module {
+  std::shared_ptr<CompilerSession> session;
+  mlir::ModuleOp module;
+
+  Module(std::shared_ptr<CompilerSession> s) : session(std::move(s)) {
+    mlir::OpBuilder builder(&session->context);
+    module = mlir::ModuleOp::create(builder.getUnknownLoc());
+  }
+
+  ~Module() {
+    // Context is shared between modules, so module must be destroyed
+    // explicitly.
+    if (module)
+      module->erase();
+  }
+};
+
+static std::optional<std::string>
+getProfileFile(const py::object &compilationContext) {
+  auto settings = compilationContext["compiler_settings"];
+  if (!settings.contains("compile_profile"))
+    return std::nullopt;
+
+  auto profileFile = settings["compile_profile"];
+  if (profileFile.is_none())
+    return std::nullopt;
+
+  return profileFile.cast<std::string>();
+}
+
 static void runCompiler(Module &mod, const py::object &compilationContext) {
-  auto &context = mod.context;
+  auto &session = *mod.session;
   auto &module = mod.module;
-  auto &registry = mod.registry;
 
   CallbackOstream printStream;
   auto settings =
       getSettings(compilationContext["compiler_settings"], printStream);
-  numba::CompilerContext compiler(context, settings, registry);
+  auto compiler = session.takeCompiler(settings);
   compiler.run(module);
+  session.releaseCompiler(settings, std::move(compiler));
 }
 
 static auto getLLModulePrinter(py::handle printer) {
@@ -1388,6 +1506,15 @@ static auto getPrinter(py::handle printer) {
   };
 }
 
+template <typename T>
+static T getDictVal(const py::dict &dict, const char *str, T def) {
+  auto key = py::str(str);
+  if (dict.contains(key))
+    return dict[key].cast<T>();
+
+  return def;
+}
+
 struct GlobalCompilerContext {
   GlobalCompilerContext(const py::dict &settings)
       : executionEngine(getOpts(settings)) {}
@@ -1396,6 +1523,34 @@ struct GlobalCompilerContext {
   llvm::SmallVector<std::pair<std::string, void *>, 0> symbolList;
   numba::ExecutionEngine executionEngine;
 
+  /// Get compiler session for the specified module settings. Sessions are
+  /// recreated periodically, as types and attributes uniqued in the context
+  /// are never freed.
+  std::shared_ptr<CompilerSession> getSession(const ModuleSettings &settings) {
+    auto &session = sessions[{settings.enableGpuPipeline,
+                              settings.compileThreads}];
+    if (!session || session->modulesCount >= kMaxModulesPerSession) {
+      session = std::make_shared<CompilerSession>(settings);
+      ++sessionsCount;
+    }
+
+    ++session->modulesCount;
+    return session;
+  }
+
+  /// Number of sessions created by `getSession`.
+  unsigned sessionsCount = 0;
+
+  /// Number of compilers constructed by the current sessions.
+  unsigned getCompilersCount() const {
+    unsigned count = 0;
+    for (auto &[key, session] : sessions)
+      if (session)
+        count += session->compilersCount;
+
+    return count;
+  }
+
 private:
   numba::ExecutionEngineOptions getOpts(const py::dict &settings) const {
     llvm::InitializeNativeTarget();
@@ -1416,6 +1571,18 @@ private:
     };
     opts.jitCodeGenOptLevel = llvm::CodeGenOptLevel::Aggressive;
 
+    auto cacheDir = settings["object_cache_dir"];
+    if (!cacheDir.is_none())
+      opts.objectCacheDir = cacheDir.cast<std::string>();
+
+    opts.objectCacheMaxSize =
+        getDictVal(settings, "object_cache_max_size", opts.objectCacheMaxSize);
+    opts.objectCachePruneInterval =
+        getDictVal(settings, "object_cache_prune_interval",
+                   opts.objectCachePruneInterval);
+    opts.objectCacheExpiration = getDictVal(
+        settings, "object_cache_expiration", opts.objectCacheExpiration);
+
     auto llvmPrinter = settings["llvm_printer"];
     if (!llvmPrinter.is_none())
       opts.transformer = getLLModulePrinter(llvmPrinter);
@@ -1428,8 +1595,26 @@ private:
     if (!asmPrinter.is_none())
       opts.asmPrinter = getPrinter(asmPrinter);
 
+    // Late printers call into python and must not be invoked from the
+    // compile threads or background tier up.
+    if (!opts.lateTransformer && !opts.asmPrinter) {
+      opts.lazyCompilation =
+          getDictVal(settings, "lazy_compilation", opts.lazyCompilation);
+      opts.numCompileThreads =
+          getDictVal(settings, "jit_compile_threads", opts.numCompileThreads);
+      opts.tieredCompilation =
+          getDictVal(settings, "tiered_compilation", opts.tieredCompilation);
+      opts.tierUpThreshold =
+          getDictVal(settings, "tier_up_threshold", opts.tierUpThreshold);
+    }
+
     return opts;
   }
+
+  static const constexpr unsigned kMaxModulesPerSession = 1024;
+
+  std::map<std::pair<bool, unsigned>, std::shared_ptr<CompilerSession>>
+      sessions;
 };
 } // namespace
 
@@ -1454,26 +1639,17 @@ py::capsule initCompiler(py::dict settings) {
   });
 }
 
-template <typename T>
-static bool getDictVal(py::dict &dict, const char *str, T &&def) {
-  auto key = py::str(str);
-  if (dict.contains(key))
-    return dict[key].cast<T>();
-
-  return def;
-}
-
-py::capsule createModule(py::dict settings) {
+py::capsule createModule(const py::capsule &compiler, py::dict settings) {
   TIME_FUNC();
+  auto context = static_cast<GlobalCompilerContext *>(compiler);
+  assert(context);
   ModuleSettings modSettings;
   modSettings.enableGpuPipeline =
       getDictVal(settings, "enable_gpu_pipeline", false);
+  modSettings.compileThreads =
+      getDictVal(settings, "compile_threads", modSettings.compileThreads);
 
-  auto mod = std::make_unique<Module>(modSettings);
-  {
-    mlir::OpBuilder builder(&mod->context);
-    mod->module = mlir::ModuleOp::create(builder.getUnknownLoc());
-  }
+  auto mod = std::make_unique<Module>(context->getSession(modSettings));
   py::capsule capsule(mod.get(),
                       [](void *ptr) { delete static_cast<Module *>(ptr); });
   mod.release();
@@ -1484,21 +1660,46 @@ py::capsule lowerFunction(const py::object &compilationContext,
                           const py::capsule &pyMod, const py::object &funcIr) {
   TIME_FUNC();
   auto mod = static_cast<Module *>(pyMod);
-  auto &context = mod->context;
+  auto &session = *mod->session;
   auto &module = mod->module;
-  auto func = PlierLowerer(context, mod->typeConverter)
+  auto func = PlierLowerer(session.context, session.typeConverter)
                   .lower(compilationContext, module, funcIr);
   return py::capsule(func.getOperation()); // no dtor, func owned by the module.
 }
 
+void storeFunction(const py::capsule &pyMod, const py::capsule &pyFunc,
+                   uint64_t token) {
+  auto mod = static_cast<Module *>(pyMod);
+  auto func =
+      mlir::cast<mlir::func::FuncOp>(static_cast<mlir::Operation *>(pyFunc));
+  mod->session->cachedFuncs[token] = func.clone();
+}
+
+py::object loadFunction(const py::capsule &pyMod, uint64_t token) {
+  TIME_FUNC();
+  auto mod = static_cast<Module *>(pyMod);
+  auto &funcs = mod->session->cachedFuncs;
+  auto it = funcs.find(token);
+  if (it == funcs.end())
+    return py::none();
+
+  auto func = it->second->clone();
+
+  // Same function can be loaded into the module multiple times, symbol table
+  // will rename it on conflict.
+  mlir::SymbolTable symbolTable(mod->module);
+  symbolTable.insert(func);
+  return py::capsule(func.getOperation()); // no dtor, func owned by the module.
+}
+
 py::capsule lowerParfor(const pybind11::object &compilationContext,
                         const pybind11::capsule &pyMod,
                         const pybind11::object &parforInst) {
   TIME_FUNC();
   auto mod = static_cast<Module *>(pyMod);
-  auto &context = mod->context;
+  auto &session = *mod->session;
   auto &module = mod->module;
-  auto func = PlierLowerer(context, mod->typeConverter)
+  auto func = PlierLowerer(session.context, session.typeConverter)
                   .lowerParfor(compilationContext, module, parforInst);
   return py::capsule(func.getOperation()); // no dtor, func owned by the module.
 }
@@ -1512,16 +1713,40 @@ py::capsule compileModule(const py::capsule &compiler,
   auto mod = static_cast<Module *>(pyMod);
   assert(mod);
 
+  // Profiler is per compilation and only activated on the current thread, so
+  // concurrent or nested compilations record into their own profilers.
+  auto profileFile = getProfileFile(compilationContext);
+  std::shared_ptr<numba::CompileProfiler> profiler;
+  if (profileFile)
+    profiler = std::make_shared<numba::CompileProfiler>();
+
+  numba::CompileProfiler::ActivationGuard profilerGuard(profiler.get());
+
   runCompiler(*mod, compilationContext);
 
-  auto &mlirCtx = *mod->module->getContext();
-  mlir::registerLLVMDialectTranslation(mlirCtx);
-  mlir::registerBuiltinDialectTranslation(mlirCtx);
-  auto res = context->executionEngine.loadModule(mod->module);
+  // JIT materializes code on the first lookup, look up all the functions
+  // eagerly to include LLVM optimization and codegen into the profile.
+  llvm::SmallVector<std::string> funcNames;
+  if (profiler)
+    for (auto func : mod->module.getOps<mlir::LLVM::LLVMFuncOp>())
+      if (!func.isExternal())
+        funcNames.emplace_back(func.getSymName());
+
+  auto res = context->executionEngine.loadModule(mod->module, profiler);
   if (!res)
     numba::reportError(llvm::Twine("Failed to load MLIR module:\n") +
                        llvm::toString(res.takeError()));
 
+  if (profiler) {
+    for (auto &name : funcNames)
+      llvm::consumeError(
+          context->executionEngine.lookup(res.get(), name).takeError());
+
+    if (!profiler->writeChromeTrace(*profileFile))
+      numba::reportError(llvm::Twine("Failed to write compile profile: ") +
+                         *profileFile);
+  }
+
   return py::capsule(static_cast<void *>(res.get()));
 }
 
@@ -1561,6 +1786,29 @@ void releaseModule(const py::capsule &compiler, const py::capsule &module) {
   context->executionEngine.releaseModule(handle);
 }
 
+py::dict getExecutionEngineStats(const py::capsule &compiler) {
+  auto context = static_cast<GlobalCompilerContext *>(compiler);
+  assert(context);
+
+  auto stats = context->executionEngine.getStatistics();
+  py::dict ret;
+  ret["object_cache_hits"] = stats.objectCacheHits;
+  ret["object_cache_misses"] = stats.objectCacheMisses;
+  ret["object_cache_skipped"] = stats.objectCacheSkipped;
+  ret["tier_ups"] = stats.tierUps;
+  return ret;
+}
+
+py::dict getCompilerStats(const py::capsule &compiler) {
+  auto context = static_cast<GlobalCompilerContext *>(compiler);
+  assert(context);
+
+  py::dict ret;
+  ret["sessions"] = context->sessionsCount;
+  ret["compilers"] = context->getCompilersCount();
+  return ret;
+}
+
 py::str moduleStr(const py::capsule &pyMod) {
   auto mod = static_cast<Module *>(pyMod);
   std::string ret;
@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <cstdint>
+
 namespace pybind11 {
 class bytes;
 class capsule;
@@ -15,12 +17,22 @@ class str;
 
 pybind11::capsule initCompiler(pybind11::dict settings);
 
-pybind11::capsule createModule(pybind11::dict settings);
+pybind11::capsule createModule(const pybind11::capsule &compiler,
+                               pybind11::dict settings);
 
 pybind11::capsule lowerFunction(const pybind11::object &compilationContext,
                                 const pybind11::capsule &pyMod,
                                 const pybind11::object &funcIr);
 
+/// Store detached copy of the lowered function in the module compiler session,
+/// so it can be loaded into subsequent modules without lowering it again.
+void storeFunction(const pybind11::capsule &pyMod,
+                   const pybind11::capsule &pyFunc, uint64_t token);
+
+/// Clone function, previously stored with `token`, into the module. Returns
+/// None if the function is not in the cache, e.g. if session was recreated.
+pybind11::object loadFunction(const pybind11::capsule &pyMod, uint64_t token);
+
 pybind11::capsule lowerParfor(const pybind11::object &compilationContext,
                               const pybind11::capsule &pyMod,
                               const pybind11::object &parforInst);
@@ -39,4 +51,10 @@ pybind11::int_ getFunctionPointer(const pybind11::capsule &compiler,
 void releaseModule(const pybind11::capsule &compiler,
                    const pybind11::capsule &module);
 
+/// Returns execution engine counters as a dict, used by the tests.
+pybind11::dict getExecutionEngineStats(const pybind11::capsule &compiler);
+
+/// Returns compiler sessions and pass managers counters, used by the tests.
+pybind11::dict getCompilerStats(const pybind11::capsule &compiler);
+
 pybind11::str moduleStr(const pybind11::capsule &pyMod);
@@ -22,6 +22,8 @@
 #include <mlir/IR/BuiltinTypes.h>
 #include <mlir/Parser/Parser.h>
 
+#include "numba/Compiler/CompileProfiler.hpp"
+#include "numba/Dialect/gpu_runtime/IR/GpuRuntimeOps.hpp"
 #include "numba/Dialect/ntensor/IR/NTensorOps.hpp"
 #include "numba/Dialect/numba_util/Dialect.hpp"
 #include "numba/Transforms/CastUtils.hpp"
@@ -1507,6 +1509,21 @@ static py::object ifopImpl(py::capsule context, py::handle cond,
   return ctx.context.createVar(context, res);
 }
 
+static py::bool_ isGpuImpl(py::capsule context, py::iterable arrays) {
+  auto &ctx = getPyContext(context);
+  auto &builder = ctx.builder;
+  auto loc = ctx.loc;
+  for (auto arr : arrays) {
+    auto val = ctx.context.unwrapVal(loc, builder, arr);
+    auto tensorType =
+        mlir::dyn_cast<numba::ntensor::NTensorType>(val.getType());
+    if (tensorType && mlir::isa_and_nonnull<gpu_runtime::GPURegionDescAttr>(
+                          tensorType.getEnvironment()))
+      return true;
+  }
+  return false;
+}
+
 static py::object arrayTypeImpl(py::capsule context, py::iterable dims,
                                 py::handle dtype) {
   auto &ctx = getPyContext(context);
@@ -1539,6 +1556,7 @@ setupPyBuilder(py::handle builder, mlir::OpBuilder &b,
   py::setattr(builder, "_force_copy", py::cpp_function(&forceCopyImpl));
   py::setattr(builder, "_select", py::cpp_function(&selectImpl));
   py::setattr(builder, "_ifop", py::cpp_function(&ifopImpl));
+  py::setattr(builder, "_is_gpu", py::cpp_function(&isGpuImpl));
 
   py::setattr(builder, "_array_type", py::cpp_function(&arrayTypeImpl));
 
@@ -1941,6 +1959,7 @@ PyLinalgResolver::rewrite(llvm::StringRef name, mlir::Location loc,
                           KWArgs kwargs) const {
   try {
     assert(!name.empty());
+    numba::CompileProfiler::Scope scope("python", name);
     if (!isCompatibleTypes(args) ||
         !isCompatibleTypes(llvm::make_second_range(kwargs)))
       return {};
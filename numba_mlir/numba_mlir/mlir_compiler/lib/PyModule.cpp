@@ -6,6 +6,7 @@
 
 #include "PyModule.hpp"
 
+#include "DispatchCache.hpp"
 #include "Lowering.hpp"
 
 static bool is_dpnp_supported() {
@@ -36,13 +37,19 @@ PYBIND11_MODULE(mlir_compiler, m) {
   m.def("init_compiler", &initCompiler, "No docs");
   m.def("create_module", &createModule, "No docs");
   m.def("lower_function", &lowerFunction, "No docs");
+  m.def("store_function", &storeFunction, "No docs");
+  m.def("load_function", &loadFunction, "No docs");
   m.def("lower_parfor", &lowerParfor, "No docs");
   m.def("compile_module", &compileModule, "No docs");
   m.def("register_symbol", &registerSymbol, "No docs");
   m.def("get_function_pointer", &getFunctionPointer, "No docs");
   m.def("release_module", &releaseModule, "No docs");
   m.def("module_str", &moduleStr, "No docs");
+  m.def("get_execution_engine_stats", &getExecutionEngineStats, "No docs");
+  m.def("get_compiler_stats", &getCompilerStats, "No docs");
   m.def("is_dpnp_supported", &is_dpnp_supported, "No docs");
   m.def("is_mkl_supported", &is_mkl_supported, "No docs");
   m.def("is_sycl_mkl_supported", &is_sycl_mkl_supported, "No docs");
+
+  registerDispatchCache(m);
 }
@@ -872,28 +872,17 @@ struct GenerateOutlineContextPass
     if (body.empty())
       return;
 
-    if (!llvm::hasSingleElement(body)) {
-      func.emitError("Only strucutred control flow is supported");
-      signalPassFailure();
-      return;
-    }
-
     mlir::OpBuilder builder(&getContext());
     auto initAttr = builder.getStringAttr(kOutlinedInitAttr);
     auto deinitAttr = builder.getStringAttr(kOutlinedDeinitAttr);
 
     mlir::func::CallOp init;
     mlir::func::CallOp deinit;
-    for (auto &op : body.front()) {
-      auto call = mlir::dyn_cast<mlir::func::CallOp>(op);
-      if (!call)
-        continue;
-
+    auto res = func.walk([&](mlir::func::CallOp call) -> mlir::WalkResult {
       if (call->hasAttr(initAttr)) {
         if (init) {
           call.emitError("More than one init function");
-          signalPassFailure();
-          return;
+          return mlir::WalkResult::interrupt();
         }
         init = call;
       }
@@ -901,22 +890,30 @@ struct GenerateOutlineContextPass
       if (call->hasAttr(deinitAttr)) {
         if (call->getNumResults() != 0) {
           call.emitError("deinit function mus have zero results");
-          signalPassFailure();
-          return;
+          return mlir::WalkResult::interrupt();
         }
 
         if (deinit) {
           call.emitError("More than one deinit function");
-          signalPassFailure();
-          return;
+          return mlir::WalkResult::interrupt();
         }
         deinit = call;
       }
-    }
+      return mlir::WalkResult::advance();
+    });
+    if (res.wasInterrupted())
+      return signalPassFailure();
 
     if (!init)
       return;
 
+    // Context is released before each return, so it must be taken on every
+    // path leading to them.
+    if (init->getBlock() != &body.front()) {
+      init.emitError("init function must be called from the entry block");
+      return signalPassFailure();
+    }
+
     mlir::SymbolRefAttr initSym = init.getCalleeAttr();
     mlir::SymbolRefAttr deinitSym = (deinit ? deinit.getCalleeAttr() : nullptr);
 
@@ -928,15 +925,16 @@ struct GenerateOutlineContextPass
     init->replaceAllUsesWith(resValues);
     init->erase();
 
-    if (deinit) {
-      builder.setInsertionPoint(deinit);
-      builder.create<numba::util::ReleaseContextOp>(deinit->getLoc(), ctx);
+    // Context must be returned to the pool on every exit from the function,
+    // not only on the path through the deinit call.
+    auto loc = (deinit ? deinit->getLoc() : builder.getUnknownLoc());
+    if (deinit)
       deinit->erase();
-    } else {
-      builder.setInsertionPoint(body.front().getTerminator());
-      builder.create<numba::util::ReleaseContextOp>(builder.getUnknownLoc(),
-                                                    ctx);
-    }
+
+    func.walk([&](mlir::func::ReturnOp ret) {
+      builder.setInsertionPoint(ret);
+      builder.create<numba::util::ReleaseContextOp>(loc, ctx);
+    });
   }
 };
 
@@ -944,9 +942,7 @@ static void rerunStdPipeline(mlir::Operation *op) {
   assert(nullptr != op);
   auto marker =
       mlir::StringAttr::get(op->getContext(), plierToStdPipelineName());
-  auto mod = op->getParentOfType<mlir::ModuleOp>();
-  assert(nullptr != mod);
-  numba::addPipelineJumpMarker(mod, marker);
+  numba::addPipelineJumpMarker(op, marker);
 }
 
 static mlir::FailureOr<mlir::Attribute>
@@ -19,6 +19,8 @@
 #include <mlir/Conversion/MemRefToLLVM/MemRefToLLVM.h>
 #include <mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h>
 #include <mlir/Conversion/UBToLLVM/UBToLLVM.h>
+#include <mlir/Conversion/VectorToLLVM/ConvertVectorToLLVM.h>
+#include <mlir/Conversion/VectorToSCF/VectorToSCF.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
 #include <mlir/Dialect/Arith/Transforms/Passes.h>
 #include <mlir/Dialect/ControlFlow/IR/ControlFlowOps.h>
@@ -29,6 +31,9 @@
 #include <mlir/Dialect/MemRef/Transforms/Passes.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Dialect/UB/IR/UBOps.h>
+#include <mlir/Dialect/Vector/IR/VectorOps.h>
+#include <mlir/Dialect/Vector/Transforms/LoweringPatterns.h>
+#include <mlir/Dialect/Vector/Transforms/VectorRewritePatterns.h>
 #include <mlir/IR/Builders.h>
 #include <mlir/IR/IRMapping.h>
 #include <mlir/IR/PatternMatch.h>
@@ -50,6 +55,7 @@
 #include "numba/Conversion/UtilToLlvm.hpp"
 #include "numba/Dialect/numba_util/Dialect.hpp"
 #include "numba/Transforms/FuncUtils.hpp"
+#include "numba/Transforms/MemoryRewrites.hpp"
 #include "numba/Transforms/RewriteWrapper.hpp"
 #include "numba/Utils.hpp"
 
@@ -1068,9 +1074,12 @@ struct AllocOpLowering : public mlir::AllocLikeOpLLVMLowering {
         loc, rewriter.getIntegerType(32), alignment);
 
     auto mod = allocOp->getParentOfType<mlir::ModuleOp>();
-    auto allocPtr =
-        createAllocCall(loc, "NRT_MemInfo_alloc_safe_aligned", getVoidPtrType(),
-                        {sizeBytes, alignment}, mod, rewriter);
+    auto allocFuncName =
+        allocOp->hasAttr(numba::util::attributes::getPoolAllocName())
+            ? "nmrtPoolAlloc"
+            : "NRT_MemInfo_alloc_safe_aligned";
+    auto allocPtr = createAllocCall(loc, allocFuncName, getVoidPtrType(),
+                                    {sizeBytes, alignment}, mod, rewriter);
     auto dataPtr = getDataPtr(loc, rewriter, allocPtr);
 
     allocPtr = wrapAllocPtr(rewriter, loc, mod, allocPtr);
@@ -1143,7 +1152,9 @@ struct DeallocOpLowering
                   mlir::ConversionPatternRewriter &rewriter) const override {
     auto mod = op->getParentOfType<mlir::ModuleOp>();
     assert(mod);
-    auto freeFunc = getDecrefFunc(rewriter, mod);
+    auto freeFunc = op->hasAttr(numba::util::attributes::getPoolAllocName())
+                        ? getPoolFreeFunc(rewriter, mod)
+                        : getDecrefFunc(rewriter, mod);
 
     auto loc = op.getLoc();
     mlir::MemRefDescriptor memref(adaptor.getMemref());
@@ -1156,6 +1167,13 @@ struct DeallocOpLowering
   }
 
 private:
+  mlir::LLVM::LLVMFuncOp getPoolFreeFunc(mlir::OpBuilder &builder,
+                                         mlir::ModuleOp mod) const {
+    auto funcType =
+        mlir::LLVM::LLVMFunctionType::get(getVoidType(), getVoidPtrType());
+    return numba::getOrInserLLVMFunc(builder, mod, "nmrtPoolFree", funcType);
+  }
+
   mlir::LLVM::LLVMFuncOp getDecrefFunc(mlir::OpBuilder &builder,
                                        mlir::ModuleOp mod) const {
     llvm::StringRef funcName("NRT_decref");
@@ -1257,6 +1275,17 @@ static void copyAttrs(mlir::Operation *src, mlir::Operation *dst) {
       dst->setAttr(name, attr);
 }
 
+static std::string getOutlinedFuncName(mlir::ModuleOp mod,
+                                       llvm::StringRef oldName) {
+  for (int i = 0;; ++i) {
+    auto name =
+        (0 == i ? (llvm::Twine(oldName) + "_outlined").str()
+                : (llvm::Twine(oldName) + "_outlined_" + llvm::Twine(i)).str());
+    if (!mod.lookupSymbol<mlir::func::FuncOp>(name))
+      return name;
+  }
+}
+
 struct LowerParallel : public mlir::OpRewritePattern<numba::util::ParallelOp> {
   LowerParallel(mlir::MLIRContext *context)
       : OpRewritePattern(context), converter(context) {}
@@ -1401,19 +1430,7 @@ struct LowerParallel : public mlir::OpRewritePattern<numba::util::ParallelOp> {
       auto func = [&]() {
         auto parentFunc = op->getParentOfType<mlir::func::FuncOp>();
         assert(parentFunc);
-        auto funcName = [&]() {
-          auto oldName = parentFunc.getName();
-          for (int i = 0;; ++i) {
-            auto name =
-                (0 == i ? (llvm::Twine(oldName) + "_outlined").str()
-                        : (llvm::Twine(oldName) + "_outlined_" + llvm::Twine(i))
-                              .str());
-            if (!mod.lookupSymbol<mlir::func::FuncOp>(name)) {
-              return name;
-            }
-          }
-        }();
-
+        auto funcName = getOutlinedFuncName(mod, parentFunc.getName());
         auto func = numba::addFunction(rewriter, mod, funcName, funcType);
         copyAttrs(parentFunc, func);
         return func;
@@ -1463,7 +1480,18 @@ struct LowerParallel : public mlir::OpRewritePattern<numba::util::ParallelOp> {
       }
       op.getRegion().cloneInto(&func.getBody(), mapping);
       auto &origEntry = *std::next(func.getBody().begin());
-      rewriter.create<mlir::cf::BranchOp>(loc, &origEntry);
+      auto br = rewriter.create<mlir::cf::BranchOp>(loc, &origEntry);
+
+      // Static stack allocations are placed at the start of the body by
+      // PromoteToStack, move them to the entry block, so LLVM sees them as
+      // static allocas.
+      for (auto &bodyOp : llvm::make_early_inc_range(origEntry)) {
+        auto alloca = mlir::dyn_cast<mlir::memref::AllocaOp>(bodyOp);
+        if (!alloca || !alloca->getOperands().empty())
+          break;
+
+        alloca->moveBefore(br);
+      }
       for (auto &block : func.getBody()) {
         if (auto term =
                 mlir::dyn_cast<numba::util::YieldOp>(block.getTerminator())) {
@@ -1484,7 +1512,9 @@ struct LowerParallel : public mlir::OpRewritePattern<numba::util::ParallelOp> {
           inputRangePtr, // bounds
           indexType,     // num_loops
           funcType,      // func
-          voidPtrType    // context
+          voidPtrType,   // context
+          llvmI32Type,   // schedule
+          indexType,     // grain_size
       };
       auto parallelFuncType =
           mlir::FunctionType::get(op.getContext(), args, {});
@@ -1519,8 +1549,13 @@ struct LowerParallel : public mlir::OpRewritePattern<numba::util::ParallelOp> {
 
     auto numLoopsVar =
         rewriter.create<mlir::arith::ConstantIndexOp>(loc, numLoops);
-    const mlir::Value pfArgs[] = {inputRanges, numLoopsVar, funcAddr,
-                                  contextAbstract};
+    auto schedule = op.getSchedule().value_or(numba::util::ScheduleKind::Auto);
+    auto scheduleVar = rewriter.create<mlir::arith::ConstantIntOp>(
+        loc, static_cast<int64_t>(schedule), llvmI32Type);
+    auto grainSizeVar = rewriter.create<mlir::arith::ConstantIndexOp>(
+        loc, static_cast<int64_t>(op.getGrainSize().value_or(0)));
+    const mlir::Value pfArgs[] = {inputRanges,     numLoopsVar, funcAddr,
+                                  contextAbstract, scheduleVar, grainSizeVar};
     rewriter.replaceOpWithNewOp<mlir::func::CallOp>(op, parallelFor, pfArgs);
     return mlir::success();
   }
@@ -1529,6 +1564,353 @@ private:
   mlir::LLVMTypeConverter converter;
 };
 
+/// Outlines `parallel_scan` into 3 functions and calls `nmrtParallelScan`:
+/// `reduce(begin, end, carry, total, ctx)` computes the total of the block,
+/// `scan(begin, end, carry, total, ctx)` runs loop body over the block,
+/// starting from `carry` or `init` for the first block, and
+/// `combine(acc, val, ctx)` combines block totals.
+struct LowerParallelScan
+    : public mlir::OpRewritePattern<numba::util::ParallelScanOp> {
+  LowerParallelScan(mlir::MLIRContext *context)
+      : OpRewritePattern(context), converter(context) {}
+
+  mlir::LogicalResult
+  matchAndRewrite(numba::util::ParallelScanOp op,
+                  mlir::PatternRewriter &rewriter) const override {
+    auto init = op.getInit();
+    auto accType = init.getType();
+    auto llvmAccType = converter.convertType(accType);
+    if (!llvmAccType || !llvmAccType.isIntOrFloat())
+      return mlir::failure();
+
+    llvm::SmallVector<mlir::Value> contextVars;
+    llvm::SmallVector<mlir::Operation *> contextConstants;
+    llvm::DenseSet<mlir::Value> contextVarsSet;
+    auto addContextVar = [&](mlir::Value value) {
+      if (!contextVarsSet.insert(value).second)
+        return;
+
+      if (auto defOp = value.getDefiningOp()) {
+        if (defOp->hasTrait<mlir::OpTrait::ConstantLike>()) {
+          contextConstants.emplace_back(defOp);
+          return;
+        }
+      }
+      contextVars.emplace_back(value);
+    };
+
+    op->walk([&](mlir::Operation *inner) {
+      if (inner == op)
+        return;
+
+      for (auto arg : inner->getOperands())
+        if (!op->isAncestor(arg.getParentRegion()->getParentOp()))
+          addContextVar(arg);
+    });
+    addContextVar(op.getLowerBound());
+    addContextVar(op.getStep());
+    addContextVar(init);
+
+    auto ctx = op.getContext();
+    auto llvmIndexType = converter.getIndexType();
+    auto voidPtrType = getLLVMPointerType(mlir::IntegerType::get(ctx, 8));
+    llvm::SmallVector<mlir::Type> fields;
+    fields.reserve(contextVars.size() + 2);
+    for (auto var : contextVars) {
+      auto type = converter.convertType(var.getType());
+      if (!type)
+        return mlir::failure();
+
+      fields.emplace_back(type);
+    }
+
+    // Trip count and result pointer.
+    auto countField = static_cast<unsigned>(fields.size());
+    fields.emplace_back(llvmIndexType);
+    auto resultField = static_cast<unsigned>(fields.size());
+    fields.emplace_back(voidPtrType);
+
+    auto contextType = mlir::LLVM::LLVMStructType::getLiteral(ctx, fields);
+    auto contextPtrType = getLLVMPointerType(contextType);
+
+    auto loc = op.getLoc();
+    auto indexType = rewriter.getIndexType();
+    auto llvmI32Type = rewriter.getI32Type();
+    auto getFieldPtr = [&](mlir::Location loc, mlir::Value context,
+                           unsigned index) -> mlir::Value {
+      const mlir::Value indices[] = {
+          rewriter.create<mlir::LLVM::ConstantOp>(
+              loc, llvmI32Type, rewriter.getI32IntegerAttr(0)),
+          rewriter.create<mlir::LLVM::ConstantOp>(
+              loc, llvmI32Type,
+              rewriter.getI32IntegerAttr(static_cast<int32_t>(index)))};
+      return rewriter.create<mlir::LLVM::GEPOp>(
+          loc, getLLVMPointerType(fields[index]), contextType, context,
+          indices);
+    };
+    auto loadAcc = [&](mlir::OpBuilder &builder, mlir::Location loc,
+                       mlir::Value ptr) -> mlir::Value {
+      auto val = builder.create<mlir::LLVM::LoadOp>(loc, llvmAccType, ptr);
+      return doCast(builder, loc, val, accType);
+    };
+    auto storeAcc = [&](mlir::OpBuilder &builder, mlir::Location loc,
+                        mlir::Value val, mlir::Value ptr) {
+      builder.create<mlir::LLVM::StoreOp>(
+          loc, doCast(builder, loc, val, llvmAccType), ptr);
+    };
+
+    numba::AllocaInsertionPoint allocaInsertionPoint(op);
+    auto allocaOne = [&](mlir::Type type) -> mlir::Value {
+      return allocaInsertionPoint.insert(rewriter, [&]() {
+        auto one = rewriter.create<mlir::LLVM::ConstantOp>(
+            loc, llvmI32Type, rewriter.getI32IntegerAttr(1));
+        return rewriter.create<mlir::LLVM::AllocaOp>(
+            loc, getLLVMPointerType(type), type, one, 0);
+      });
+    };
+    auto context = allocaOne(contextType);
+    auto result = allocaOne(llvmAccType);
+
+    auto lowerBound = op.getLowerBound();
+    auto step = op.getStep();
+    auto one = rewriter.create<mlir::arith::ConstantIndexOp>(loc, 1);
+    mlir::Value count = rewriter.create<mlir::arith::SubIOp>(
+        loc, op.getUpperBound(), lowerBound);
+    count = rewriter.create<mlir::arith::AddIOp>(
+        loc, count, rewriter.create<mlir::arith::SubIOp>(loc, step, one));
+    count = rewriter.create<mlir::arith::DivSIOp>(loc, count, step);
+
+    for (auto &&[index, var] : llvm::enumerate(contextVars)) {
+      auto i = static_cast<unsigned>(index);
+      rewriter.create<mlir::LLVM::StoreOp>(
+          loc, doCast(rewriter, loc, var, fields[i]),
+          getFieldPtr(loc, context, i));
+    }
+    rewriter.create<mlir::LLVM::StoreOp>(
+        loc, doCast(rewriter, loc, count, llvmIndexType),
+        getFieldPtr(loc, context, countField));
+    rewriter.create<mlir::LLVM::StoreOp>(
+        loc, result, getFieldPtr(loc, context, resultField));
+
+    // Result stays `init` if loop doesn't have any iterations.
+    storeAcc(rewriter, loc, init, result);
+
+    auto loadContext = [&](mlir::Value contextArg, mlir::IRMapping &mapping) {
+      auto loc = rewriter.getUnknownLoc();
+      for (auto constOp : contextConstants)
+        rewriter.clone(*constOp, mapping);
+
+      auto contextPtr = rewriter.create<mlir::LLVM::BitcastOp>(
+          loc, contextPtrType, contextArg);
+      auto loadField = [&](unsigned index, mlir::Type type) -> mlir::Value {
+        auto val = rewriter.create<mlir::LLVM::LoadOp>(
+            loc, fields[index], getFieldPtr(loc, contextPtr, index));
+        return doCast(rewriter, loc, val, type);
+      };
+      for (auto &&[index, var] : llvm::enumerate(contextVars))
+        mapping.map(var,
+                    loadField(static_cast<unsigned>(index), var.getType()));
+
+      return std::make_pair(loadField(countField, indexType),
+                            loadField(resultField, voidPtrType));
+    };
+
+    auto cloneRegion = [](mlir::OpBuilder &builder, mlir::Region &region,
+                          mlir::ValueRange args,
+                          mlir::IRMapping mapping) -> mlir::Value {
+      auto &block = region.front();
+      mapping.map(block.getArguments(), args);
+      for (auto &bodyOp : block.without_terminator())
+        builder.clone(bodyOp, mapping);
+
+      auto term = mlir::cast<numba::util::YieldOp>(block.getTerminator());
+      return mapping.lookupOrDefault(term.getResults().front());
+    };
+
+    auto mod = op->getParentOfType<mlir::ModuleOp>();
+    auto parentFunc = op->getParentOfType<mlir::func::FuncOp>();
+    assert(parentFunc);
+    auto createFunc = [&](mlir::FunctionType funcType) {
+      auto funcName = getOutlinedFuncName(mod, parentFunc.getName());
+      auto func = numba::addFunction(rewriter, mod, funcName, funcType);
+      copyAttrs(parentFunc, func);
+      return func;
+    };
+
+    const mlir::Type blockArgs[] = {
+        indexType,   // begin
+        indexType,   // end
+        voidPtrType, // carry
+        voidPtrType, // total
+        voidPtrType, // context
+    };
+    auto blockFuncType = mlir::FunctionType::get(ctx, blockArgs, {});
+
+    // Loop over the block [begin, end), starting with `acc` value.
+    auto createBlockLoop = [&](mlir::Block *entry, mlir::IRMapping &mapping,
+                               mlir::Value begin, mlir::Value acc,
+                               bool reduce) -> mlir::Value {
+      auto loc = rewriter.getUnknownLoc();
+      auto lower = mapping.lookupOrDefault(lowerBound);
+      auto blockStep = mapping.lookupOrDefault(step);
+      auto bodyBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc,
+                             mlir::Value iter, mlir::ValueRange args) {
+        mlir::Value index =
+            builder.create<mlir::arith::MulIOp>(loc, iter, blockStep);
+        index = builder.create<mlir::arith::AddIOp>(loc, lower, index);
+        mlir::Value res;
+        if (reduce) {
+          auto elem = cloneRegion(builder, op.getElement(), index, mapping);
+          const mlir::Value combineArgs[] = {args.front(), elem};
+          res = cloneRegion(builder, op.getCombine(), combineArgs, mapping);
+        } else {
+          const mlir::Value bodyArgs[] = {index, args.front()};
+          res = cloneRegion(builder, op.getBody(), bodyArgs, mapping);
+        }
+        builder.create<mlir::scf::YieldOp>(loc, res);
+      };
+      auto blockOne = rewriter.create<mlir::arith::ConstantIndexOp>(loc, 1);
+      return rewriter
+          .create<mlir::scf::ForOp>(loc, begin, entry->getArgument(1), blockOne,
+                                    acc, bodyBuilder)
+          .getResult(0);
+    };
+
+    auto reduceFunc = [&]() {
+      auto func = createFunc(blockFuncType);
+      auto entry = func.addEntryBlock();
+      mlir::OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToStart(entry);
+      auto loc = rewriter.getUnknownLoc();
+      mlir::IRMapping mapping;
+      loadContext(entry->getArgument(4), mapping);
+
+      // Blocks are never empty, so start from the first element instead of
+      // the neutral value.
+      auto begin = entry->getArgument(0);
+      mlir::Value index = rewriter.create<mlir::arith::MulIOp>(
+          loc, begin, mapping.lookupOrDefault(step));
+      index = rewriter.create<mlir::arith::AddIOp>(
+          loc, mapping.lookupOrDefault(lowerBound), index);
+      auto first = cloneRegion(rewriter, op.getElement(), index, mapping);
+      auto blockOne = rewriter.create<mlir::arith::ConstantIndexOp>(loc, 1);
+      auto next = rewriter.create<mlir::arith::AddIOp>(loc, begin, blockOne);
+      auto total = createBlockLoop(entry, mapping, next, first, true);
+      storeAcc(rewriter, loc, total, entry->getArgument(3));
+      rewriter.create<mlir::func::ReturnOp>(loc);
+      return func;
+    }();
+
+    auto scanFunc = [&]() {
+      auto func = createFunc(blockFuncType);
+      auto entry = func.addEntryBlock();
+      mlir::OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToStart(entry);
+      auto loc = rewriter.getUnknownLoc();
+      mlir::IRMapping mapping;
+      auto [tripCount, resultPtr] =
+          loadContext(entry->getArgument(4), mapping);
+
+      auto carry = entry->getArgument(2);
+      auto total = entry->getArgument(3);
+      auto nullPtr = rewriter.create<mlir::LLVM::NullOp>(loc, voidPtrType);
+      auto hasCarry = rewriter.create<mlir::LLVM::ICmpOp>(
+          loc, mlir::LLVM::ICmpPredicate::ne, carry, nullPtr);
+      auto carryBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc) {
+        builder.create<mlir::scf::YieldOp>(loc, loadAcc(builder, loc, carry));
+      };
+      auto initBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc) {
+        builder.create<mlir::scf::YieldOp>(loc, mapping.lookupOrDefault(init));
+      };
+      mlir::Value acc = rewriter
+                            .create<mlir::scf::IfOp>(loc, hasCarry,
+                                                     carryBuilder, initBuilder)
+                            .getResult(0);
+      acc = createBlockLoop(entry, mapping, entry->getArgument(0), acc, false);
+
+      auto storeBuilder = [&](mlir::Value ptr) {
+        return [&, ptr](mlir::OpBuilder &builder, mlir::Location loc) {
+          storeAcc(builder, loc, acc, ptr);
+          builder.create<mlir::scf::YieldOp>(loc);
+        };
+      };
+      auto hasTotal = rewriter.create<mlir::LLVM::ICmpOp>(
+          loc, mlir::LLVM::ICmpPredicate::ne, total, nullPtr);
+      rewriter.create<mlir::scf::IfOp>(loc, hasTotal, storeBuilder(total));
+
+      auto isLast = rewriter.create<mlir::arith::CmpIOp>(
+          loc, mlir::arith::CmpIPredicate::eq, entry->getArgument(1),
+          tripCount);
+      rewriter.create<mlir::scf::IfOp>(loc, isLast, storeBuilder(resultPtr));
+      rewriter.create<mlir::func::ReturnOp>(loc);
+      return func;
+    }();
+
+    const mlir::Type combineArgs[] = {
+        voidPtrType, // acc
+        voidPtrType, // val
+        voidPtrType, // context
+    };
+    auto combineFuncType = mlir::FunctionType::get(ctx, combineArgs, {});
+    auto combineFunc = [&]() {
+      auto func = createFunc(combineFuncType);
+      auto entry = func.addEntryBlock();
+      mlir::OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointToStart(entry);
+      auto loc = rewriter.getUnknownLoc();
+      mlir::IRMapping mapping;
+      loadContext(entry->getArgument(2), mapping);
+      auto accPtr = entry->getArgument(0);
+      auto valPtr = entry->getArgument(1);
+      const mlir::Value args[] = {loadAcc(rewriter, loc, accPtr),
+                                  loadAcc(rewriter, loc, valPtr)};
+      auto res = cloneRegion(rewriter, op.getCombine(), args, mapping);
+      storeAcc(rewriter, loc, res, accPtr);
+      rewriter.create<mlir::func::ReturnOp>(loc);
+      return func;
+    }();
+
+    auto parallelScan = [&]() {
+      auto funcName = "nmrtParallelScan";
+      if (auto sym = mod.lookupSymbol<mlir::func::FuncOp>(funcName))
+        return sym;
+
+      const mlir::Type args[] = {
+          indexType,       // count
+          indexType,       // elem_size
+          blockFuncType,   // reduce
+          blockFuncType,   // scan
+          combineFuncType, // combine
+          voidPtrType,     // context
+      };
+      auto funcType = mlir::FunctionType::get(ctx, args, {});
+      return numba::addFunction(rewriter, mod, funcName, funcType);
+    }();
+
+    auto getFuncAddr = [&](mlir::func::FuncOp func) -> mlir::Value {
+      return rewriter.create<mlir::func::ConstantOp>(
+          loc, func.getFunctionType(), mlir::SymbolRefAttr::get(func));
+    };
+    auto elemSize = rewriter.create<mlir::arith::ConstantIndexOp>(
+        loc, static_cast<int64_t>(
+                 llvm::divideCeil(llvmAccType.getIntOrFloatBitWidth(), 8)));
+    auto contextAbstract =
+        rewriter.create<mlir::LLVM::BitcastOp>(loc, voidPtrType, context);
+    const mlir::Value args[] = {count,
+                                elemSize,
+                                getFuncAddr(reduceFunc),
+                                getFuncAddr(scanFunc),
+                                getFuncAddr(combineFunc),
+                                contextAbstract};
+    rewriter.create<mlir::func::CallOp>(loc, parallelScan, args);
+    rewriter.replaceOp(op, loadAcc(rewriter, loc, result));
+    return mlir::success();
+  }
+
+private:
+  mlir::LLVMTypeConverter converter;
+};
+
 struct RemoveParallelRegion
     : public mlir::OpRewritePattern<numba::util::EnvironmentRegionOp> {
   using OpRewritePattern::OpRewritePattern;
@@ -1563,7 +1945,38 @@ struct LowerParallelToCFGPass
   void runOnOperation() override final {
     auto &context = getContext();
     mlir::RewritePatternSet patterns(&context);
-    patterns.insert<LowerParallel>(&getContext());
+    patterns.insert<LowerParallel, LowerParallelScan>(&getContext());
+
+    if (mlir::failed(mlir::applyPatternsAndFoldGreedily(getOperation(),
+                                                        std::move(patterns))))
+      return signalPassFailure();
+  }
+};
+
+/// Lower high-level vector ops to the subset supported by vector to LLVM
+/// conversion.
+struct LowerVectorOpsPass
+    : public mlir::PassWrapper<LowerVectorOpsPass,
+                               mlir::OperationPass<mlir::func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(LowerVectorOpsPass)
+
+  void runOnOperation() override final {
+    auto &context = getContext();
+    mlir::RewritePatternSet patterns(&context);
+    mlir::vector::populateVectorToVectorCanonicalizationPatterns(patterns);
+    mlir::vector::populateVectorBroadcastLoweringPatterns(patterns);
+    mlir::vector::populateVectorContractLoweringPatterns(
+        patterns, mlir::vector::VectorTransformsOptions());
+    mlir::vector::populateVectorMaskOpLoweringPatterns(patterns);
+    mlir::vector::populateVectorShapeCastLoweringPatterns(patterns);
+    mlir::vector::populateVectorTransposeLoweringPatterns(
+        patterns, mlir::vector::VectorTransformsOptions());
+    mlir::vector::populateVectorMultiReductionLoweringPatterns(
+        patterns, mlir::vector::VectorMultiReductionLowering::InnerReduction);
+    mlir::vector::populateVectorTransferPermutationMapLoweringPatterns(
+        patterns);
+    mlir::vector::populateVectorTransferLoweringPatterns(patterns,
+                                                         /*maxTransferRank*/ 1);
 
     if (mlir::failed(mlir::applyPatternsAndFoldGreedily(getOperation(),
                                                         std::move(patterns))))
@@ -1571,9 +1984,12 @@ struct LowerParallelToCFGPass
   }
 };
 
+// Signature fixup inserts conversion helpers into the parent module, so this
+// pass must run on the module instead of individual functions to be safe under
+// multithreaded pass execution.
 struct PreLLVMLowering
     : public mlir::PassWrapper<PreLLVMLowering,
-                               mlir::OperationPass<mlir::func::FuncOp>> {
+                               mlir::OperationPass<mlir::ModuleOp>> {
   MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(PreLLVMLowering)
 
   virtual void
@@ -1587,22 +2003,26 @@ struct PreLLVMLowering
     LLVMTypeHelper type_helper(context);
 
     mlir::RewritePatternSet patterns(&context);
-    auto func = getOperation();
-
-    // TODO: workaround for deallocation pipeline not declaring "dealloc_helper"
-    // private.
-    if (func.getName() == "dealloc_helper")
-      func.setPrivate();
-
-    if (mlir::failed(fixFuncSig(type_helper, func)))
-      return signalPassFailure();
-
     patterns.insert<ReturnOpLowering>(&context,
                                       type_helper.get_type_converter());
+    mlir::FrozenRewritePatternSet frozenPatterns(std::move(patterns));
+
+    // Conversion helpers are added to the module during iteration, take a
+    // snapshot of the original functions first.
+    auto funcs = llvm::to_vector(getOperation().getOps<mlir::func::FuncOp>());
+    for (auto func : funcs) {
+      // TODO: workaround for deallocation pipeline not declaring
+      // "dealloc_helper" private.
+      if (func.getName() == "dealloc_helper")
+        func.setPrivate();
 
-    if (mlir::failed(mlir::applyPatternsAndFoldGreedily(getOperation(),
-                                                        std::move(patterns))))
-      return signalPassFailure();
+      if (mlir::failed(fixFuncSig(type_helper, func)))
+        return signalPassFailure();
+
+      if (mlir::failed(
+              mlir::applyPatternsAndFoldGreedily(func, frozenPatterns)))
+        return signalPassFailure();
+    }
   }
 };
 
@@ -1768,6 +2188,8 @@ struct LLVMLoweringPass
     arith::populateArithToLLVMConversionPatterns(typeConverter, patterns);
     populateComplexToLLVMConversionPatterns(typeConverter, patterns);
     ub::populateUBToLLVMConversionPatterns(typeConverter, patterns);
+    populateVectorToLLVMMatrixConversionPatterns(typeConverter, patterns);
+    populateVectorToLLVMConversionPatterns(typeConverter, patterns);
 
     patterns.insert<AllocOpLowering, DeallocOpLowering, LowerRetainOp,
                     LowerWrapAllocPointerOp, LowerGetAllocToken,
@@ -1787,12 +2209,16 @@ struct LLVMLoweringPass
 };
 
 static void populatePreLowerToLlvmPipeline(mlir::OpPassManager &pm) {
-  pm.addNestedPass<mlir::func::FuncOp>(std::make_unique<PreLLVMLowering>());
+  pm.addPass(std::make_unique<PreLLVMLowering>());
 }
 
 static void populateLowerToLlvmPipeline(mlir::OpPassManager &pm) {
+  pm.addPass(numba::createPromoteToStackPass());
+  pm.addNestedPass<mlir::func::FuncOp>(numba::createMarkPoolAllocsPass());
   pm.addPass(std::make_unique<RemoveParallelRegionPass>());
   pm.addPass(std::make_unique<LowerParallelToCFGPass>());
+  pm.addNestedPass<mlir::func::FuncOp>(mlir::createConvertVectorToSCFPass());
+  pm.addNestedPass<mlir::func::FuncOp>(std::make_unique<LowerVectorOpsPass>());
   pm.addPass(mlir::createConvertSCFToCFPass());
   pm.addPass(mlir::createCanonicalizerPass());
   pm.addPass(mlir::createConvertComplexToStandardPass());
@@ -20,14 +20,22 @@
 #include "numba/Compiler/PipelineRegistry.hpp"
 #include "numba/Dialect/numba_util/Dialect.hpp"
 #include "numba/Transforms/FuncUtils.hpp"
+#include "numba/Transforms/PromoteToParallel.hpp"
 #include "numba/Transforms/RewriteWrapper.hpp"
 
 namespace {
+// Per-thread reduction slots are padded to the cache line size to avoid false
+// sharing between workers.
+static constexpr int64_t kCacheLineSize = 64;
+
 static mlir::MemRefType getReduceType(mlir::Type type, int64_t count) {
-  if (type.isIntOrFloat())
-    return mlir::MemRefType::get(count, type);
+  if (!type.isIntOrFloat())
+    return {};
 
-  return {};
+  auto elemSize = std::max<int64_t>(
+      1, llvm::divideCeil(type.getIntOrFloatBitWidth(), 8));
+  auto slotSize = std::max<int64_t>(1, kCacheLineSize / elemSize);
+  return mlir::MemRefType::get({count, slotSize}, type);
 }
 
 static std::optional<mlir::TypedAttr>
@@ -38,6 +46,51 @@ getReduceInitVal(mlir::Type type, mlir::Block &reduceBlock) {
   return mlir::arith::getNeutralElement(&(*reduceBlock.begin()));
 }
 
+// Rough number of operations single parallel chunk should execute to amortize
+// scheduling overhead.
+static constexpr int64_t kTargetChunkCost = 4096;
+
+static int64_t estimateBodyCost(mlir::scf::ParallelOp op) {
+  int64_t cost = 0;
+  op.getBody()->walk([&](mlir::Operation *nested) {
+    if (!nested->hasTrait<mlir::OpTrait::ConstantLike>())
+      ++cost;
+  });
+  return std::max<int64_t>(cost, 1);
+}
+
+static bool hasIrregularTripCount(mlir::scf::ParallelOp op) {
+  // While loops inside the body usually mean data dependent amount of work per
+  // iteration (e.g. mandelbrot), which benefits from fine-grained dynamic
+  // scheduling.
+  return op.getBody()
+      ->walk([](mlir::scf::WhileOp) { return mlir::WalkResult::interrupt(); })
+      .wasInterrupted();
+}
+
+static std::pair<numba::util::ScheduleKind, int64_t>
+getSchedule(mlir::func::FuncOp func, mlir::scf::ParallelOp op) {
+  using Kind = numba::util::ScheduleKind;
+  int64_t grain = 0;
+  if (auto attr = func->getAttrOfType<mlir::IntegerAttr>(
+          numba::util::attributes::getParallelGrainSizeName()))
+    grain = std::max<int64_t>(attr.getInt(), 0);
+
+  if (auto attr = func->getAttrOfType<mlir::StringAttr>(
+          numba::util::attributes::getParallelScheduleName())) {
+    if (auto kind = numba::util::symbolizeScheduleKind(attr.getValue()))
+      return {*kind, grain};
+  }
+
+  if (hasIrregularTripCount(op))
+    return {Kind::Dynamic, grain > 0 ? grain : 1};
+
+  if (grain == 0)
+    grain = kTargetChunkCost / estimateBodyCost(op);
+
+  return {Kind::Auto, grain};
+}
+
 static bool isInsideParalleRegion(mlir::Operation *op) {
   // Must be direct parent
   auto region =
@@ -108,7 +161,8 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
       auto reduceType = getReduceType(type, maxConcurrency);
       assert(reduceType);
       auto reduce = allocaIP.insert(rewriter, [&]() {
-        return rewriter.create<mlir::memref::AllocaOp>(loc, reduceType);
+        return rewriter.create<mlir::memref::AllocaOp>(
+            loc, reduceType, rewriter.getI64IntegerAttr(kCacheLineSize));
       });
       reduceVars[i] = reduce;
     }
@@ -118,10 +172,12 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
                                      mlir::ValueRange args) {
       assert(args.empty());
       (void)args;
+      auto zero = builder.create<mlir::arith::ConstantIndexOp>(loc, 0);
       for (auto &&[i, reduce] : llvm::enumerate(reduceVars)) {
         auto initVal = initVals[i];
         auto init = builder.create<mlir::arith::ConstantOp>(loc, initVal);
-        builder.create<mlir::memref::StoreOp>(loc, init, reduce, index);
+        builder.create<mlir::memref::StoreOp>(loc, init, reduce,
+                                              mlir::ValueRange{index, zero});
       }
       builder.create<mlir::scf::YieldOp>(loc);
     };
@@ -144,9 +200,11 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
                            mlir::ValueRange upperBound,
                            mlir::Value threadIndex) {
       llvm::SmallVector<mlir::Value> initVals(op.getInitVals().size());
+      auto zero = builder.create<mlir::arith::ConstantIndexOp>(loc, 0);
+      mlir::Value slotIndices[] = {threadIndex, zero};
       for (auto &&[i, reduceVar] : llvm::enumerate(reduceVars)) {
         auto val =
-            builder.create<mlir::memref::LoadOp>(loc, reduceVar, threadIndex);
+            builder.create<mlir::memref::LoadOp>(loc, reduceVar, slotIndices);
         initVals[i] = val;
       }
       auto newOp =
@@ -157,12 +215,17 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
       newOp.getInitValsMutable().assign(initVals);
       for (auto &&[i, val] : llvm::enumerate(newOp->getResults())) {
         auto reduceVar = reduceVars[i];
-        builder.create<mlir::memref::StoreOp>(loc, val, reduceVar, threadIndex);
+        builder.create<mlir::memref::StoreOp>(loc, val, reduceVar,
+                                              slotIndices);
       }
     };
 
-    rewriter.create<numba::util::ParallelOp>(
+    auto [schedule, grain] = getSchedule(func, op);
+    auto parallelOp = rewriter.create<numba::util::ParallelOp>(
         loc, origLowerBound, origUpperBound, origStep, bodyBuilder);
+    parallelOp.setSchedule(schedule);
+    if (grain > 0)
+      parallelOp.setGrainSize(static_cast<uint64_t>(grain));
 
     auto reduceBodyBuilder = [&](mlir::OpBuilder &builder, mlir::Location loc,
                                  mlir::Value index, mlir::ValueRange args) {
@@ -180,8 +243,8 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
         auto reduceOp = mlir::cast<mlir::scf::ReduceOp>(iOp);
         auto &reduceOpBody = reduceOp.getReductionOperator().front();
         assert(reduceOpBody.getNumArguments() == 2);
-        auto prevVal =
-            builder.create<mlir::memref::LoadOp>(loc, reduceVar, index);
+        auto prevVal = builder.create<mlir::memref::LoadOp>(
+            loc, reduceVar, mlir::ValueRange{index, reduceLowerBound});
         mapping.map(reduceOpBody.getArgument(0), arg);
         mapping.map(reduceOpBody.getArgument(1), prevVal);
         for (auto &oldReduceOp : reduceOpBody.without_terminator())
@@ -206,6 +269,105 @@ struct ParallelToTbb : public mlir::OpRewritePattern<mlir::scf::ParallelOp> {
   }
 };
 
+static int64_t getMaxConcurrency(mlir::Operation *op) {
+  auto func = op->getParentOfType<mlir::func::FuncOp>();
+  if (!func)
+    return 0;
+
+  if (auto mc = func->getAttrOfType<mlir::IntegerAttr>(
+          numba::util::attributes::getMaxConcurrencyName()))
+    return mc.getInt();
+
+  return 0;
+}
+
+/// Collect ops from the loop body required to compute the `value`.
+static void getBodySlice(mlir::Block *body, mlir::Value value,
+                         llvm::SmallPtrSetImpl<mlir::Operation *> &slice) {
+  llvm::SmallVector<mlir::Value> worklist;
+  worklist.emplace_back(value);
+  while (!worklist.empty()) {
+    auto op = worklist.pop_back_val().getDefiningOp();
+    if (!op || op->getBlock() != body || !slice.insert(op).second)
+      continue;
+
+    op->walk([&](mlir::Operation *nested) {
+      llvm::append_range(worklist, nested->getOperands());
+    });
+  }
+}
+
+struct ParallelScanToTbb : public mlir::OpRewritePattern<mlir::scf::ForOp> {
+  using OpRewritePattern::OpRewritePattern;
+
+  mlir::LogicalResult
+  matchAndRewrite(mlir::scf::ForOp op,
+                  mlir::PatternRewriter &rewriter) const override {
+    if (!op->hasAttr(numba::util::attributes::getParallelScanName()))
+      return mlir::failure();
+
+    if (op->getParentOfType<mlir::scf::ParallelOp>() ||
+        op->getParentOfType<numba::util::ParallelOp>())
+      return mlir::failure();
+
+    if (getMaxConcurrency(op) <= 1)
+      return mlir::failure();
+
+    // Loop could have been changed since it was marked, recheck it.
+    auto combineOp = numba::getParallelScanCombineOp(op);
+    if (!combineOp)
+      return mlir::failure();
+
+    mlir::Block *body = op.getBody();
+    auto acc = op.getRegionIterArgs().front();
+    auto elem = combineOp->getOperand(combineOp->getOperand(0) == acc ? 1 : 0);
+
+    llvm::SmallPtrSet<mlir::Operation *, 8> elemSlice;
+    getBodySlice(body, elem, elemSlice);
+
+    auto loc = op.getLoc();
+    mlir::Type accType = acc.getType();
+    mlir::Type indexType = rewriter.getIndexType();
+    auto scanOp = rewriter.create<numba::util::ParallelScanOp>(
+        loc, accType, op.getLowerBound(), op.getUpperBound(), op.getStep(),
+        op.getInitArgs().front());
+
+    mlir::OpBuilder::InsertionGuard g(rewriter);
+    mlir::IRMapping mapping;
+    auto elemBlock =
+        rewriter.createBlock(&scanOp.getElement(), {}, indexType, loc);
+    mapping.map(op.getInductionVar(), elemBlock->getArgument(0));
+    for (auto &bodyOp : body->without_terminator())
+      if (elemSlice.contains(&bodyOp))
+        rewriter.clone(bodyOp, mapping);
+
+    rewriter.create<numba::util::YieldOp>(loc, mapping.lookupOrDefault(elem));
+
+    mlir::Type combineTypes[] = {accType, accType};
+    mlir::Location combineLocs[] = {loc, loc};
+    auto combineBlock = rewriter.createBlock(&scanOp.getCombine(), {},
+                                             combineTypes, combineLocs);
+    mapping.clear();
+    mapping.map(acc, combineBlock->getArgument(0));
+    mapping.map(elem, combineBlock->getArgument(1));
+    auto combined = rewriter.clone(*combineOp, mapping)->getResult(0);
+    rewriter.create<numba::util::YieldOp>(loc, combined);
+
+    mlir::Type bodyTypes[] = {indexType, accType};
+    mlir::Location bodyLocs[] = {loc, loc};
+    auto bodyBlock =
+        rewriter.createBlock(&scanOp.getBody(), {}, bodyTypes, bodyLocs);
+    rewriter.mergeBlocks(body, bodyBlock, bodyBlock->getArguments());
+
+    auto term = mlir::cast<mlir::scf::YieldOp>(bodyBlock->getTerminator());
+    rewriter.setInsertionPoint(term);
+    rewriter.replaceOpWithNewOp<numba::util::YieldOp>(term, term.getResults());
+
+    rewriter.replaceOp(op, scanOp.getResult());
+    return mlir::success();
+  }
+};
+
 static bool
 isAnyArgDefinedInsideRegions(llvm::MutableArrayRef<mlir::Region> regs,
                              mlir::Operation *op) {
@@ -374,7 +536,7 @@ struct ParallelToTbbPass
           numba::DependentDialectsList<numba::util::NumbaUtilDialect,
                                        mlir::arith::ArithDialect,
                                        mlir::scf::SCFDialect>,
-          ParallelToTbb> {};
+          ParallelToTbb, ParallelScanToTbb> {};
 
 struct HoistBufferAllocsPass
     : public numba::RewriteWrapperPass<
@@ -5,6 +5,7 @@
 #include "pipelines/PlierToLinalg.hpp"
 
 #include <mlir/Conversion/ReconcileUnrealizedCasts/ReconcileUnrealizedCasts.h>
+#include <mlir/Dialect/Affine/IR/AffineOps.h>
 #include <mlir/Dialect/Arith/IR/Arith.h>
 #include <mlir/Dialect/Arith/Transforms/Passes.h>
 #include <mlir/Dialect/Arith/Utils/Utils.h>
@@ -24,8 +25,11 @@
 #include <mlir/Dialect/MemRef/IR/MemRef.h>
 #include <mlir/Dialect/SCF/IR/SCF.h>
 #include <mlir/Dialect/SCF/Transforms/Passes.h>
+#include <mlir/Dialect/SCF/Transforms/Transforms.h>
 #include <mlir/Dialect/Tensor/IR/Tensor.h>
 #include <mlir/Dialect/Tensor/Transforms/Passes.h>
+#include <mlir/Dialect/Vector/IR/VectorOps.h>
+#include <mlir/Dialect/Vector/Transforms/VectorRewritePatterns.h>
 #include <mlir/Dialect/UB/IR/UBOps.h>
 #include <mlir/IR/Dialect.h>
 #include <mlir/IR/Dominance.h>
@@ -36,6 +40,8 @@
 #include <mlir/Transforms/LoopInvariantCodeMotionUtils.h>
 #include <mlir/Transforms/Passes.h>
 
+#include <llvm/Support/Host.h>
+
 #include "pipelines/PlierToScf.hpp"
 #include "pipelines/PlierToStd.hpp"
 #include "pipelines/PreLowSimplifications.hpp"
@@ -198,9 +204,7 @@ static void rerunScfPipeline(mlir::Operation *op) {
   assert(nullptr != op);
   auto marker =
       mlir::StringAttr::get(op->getContext(), plierToScfPipelineName());
-  auto mod = op->getParentOfType<mlir::ModuleOp>();
-  assert(nullptr != mod);
-  numba::addPipelineJumpMarker(mod, marker);
+  numba::addPipelineJumpMarker(op, marker);
 }
 
 static std::optional<mlir::Type> isUniTuple(mlir::TupleType type) {
@@ -3818,7 +3822,12 @@ void PostLinalgOptInnerPass::runOnOperation() {
           op);
     };
     (void)numba::prepareForFusion(op.getRegion(), check);
-    return numba::naivelyFuseParallelOps(op.getRegion());
+    bool changed =
+        mlir::succeeded(numba::fuseProducerConsumerParallelOps(op.getRegion()));
+    if (mlir::succeeded(numba::naivelyFuseParallelOps(op.getRegion())))
+      changed = true;
+
+    return mlir::success(changed);
   };
 
   if (mlir::failed(applyOptimizations(func, std::move(patterns),
@@ -3965,6 +3974,492 @@ struct MakeGenericReduceInnermostPass
     : public numba::RewriteWrapperPass<MakeGenericReduceInnermostPass, void,
                                        void, MakeGenericReduceInnermost> {};
 
+static constexpr int64_t kDefaultL1CacheSize = 32 * 1024;
+static constexpr int64_t kDefaultL2CacheSize = 1024 * 1024;
+static constexpr int64_t kMinTileSize = 8;
+static constexpr int64_t kMaxTileSize = 1024;
+static constexpr unsigned kMaxTiledDims = 3;
+
+static int64_t getCacheSize(mlir::func::FuncOp func, llvm::StringRef name,
+                            int64_t defaultSize) {
+  auto attr = func->getAttrOfType<mlir::IntegerAttr>(name);
+  if (!attr || attr.getInt() <= 0)
+    return defaultSize;
+
+  return attr.getInt();
+}
+
+static bool isInsideGpuRegion(mlir::Operation *op) {
+  auto region = op->getParentOfType<numba::util::EnvironmentRegionOp>();
+  while (region) {
+    if (mlir::isa<gpu_runtime::GPURegionDescAttr>(region.getEnvironment()))
+      return true;
+
+    region = region->getParentOfType<numba::util::EnvironmentRegionOp>();
+  }
+  return false;
+}
+
+static mlir::Value getRootMemref(mlir::Value memref) {
+  while (auto view = memref.getDefiningOp<mlir::ViewLikeOpInterface>())
+    memref = view.getViewSource();
+
+  return memref;
+}
+
+/// Check if generic access pattern can benefit from cache blocking:
+/// some operand is accessed with non-unit stride in the innermost loop
+/// (transposes, reductions over outer dimensions) or several inputs are views
+/// into the same buffer (stencils).
+static bool needCacheTiling(mlir::linalg::GenericOp op) {
+  auto innermost = op.getNumLoops() - 1;
+  llvm::SmallPtrSet<mlir::Value, 4> inputRoots;
+  bool sharedInputs = false;
+  for (auto input : op.getDpsInputOperands()) {
+    auto map = op.getMatchingIndexingMap(input);
+    auto results = map.getResults();
+    for (auto expr : results.drop_back())
+      if (expr.isFunctionOfDim(innermost))
+        return true;
+
+    if (mlir::isa<mlir::MemRefType>(input->get().getType()) &&
+        !inputRoots.insert(getRootMemref(input->get())).second)
+      sharedInputs = true;
+  }
+
+  for (auto output : op.getDpsInitOperands()) {
+    auto map = op.getMatchingIndexingMap(output);
+    for (auto expr : map.getResults().drop_back())
+      if (expr.isFunctionOfDim(innermost))
+        return true;
+  }
+  return sharedInputs;
+}
+
+/// Returns tile sizes (0 - untiled) for the largest power-of-2 square tile,
+/// whose data footprint fits into `cacheSize`, or empty vector if tiling is
+/// not profitable.
+static llvm::SmallVector<int64_t>
+computeTileSizes(mlir::linalg::GenericOp op, int64_t cacheSize) {
+  auto numLoops = op.getNumLoops();
+  auto ranges = op.getStaticLoopRanges();
+  auto firstTiled = numLoops > kMaxTiledDims ? numLoops - kMaxTiledDims : 0;
+
+  auto getTileSizes = [&](int64_t tile) {
+    llvm::SmallVector<int64_t> ret(numLoops);
+    for (auto i : llvm::seq(0u, numLoops)) {
+      if (i < firstTiled) {
+        ret[i] = 1;
+      } else if (!mlir::ShapedType::isDynamic(ranges[i]) &&
+                 ranges[i] <= tile) {
+        ret[i] = 0;
+      } else {
+        ret[i] = tile;
+      }
+    }
+    return ret;
+  };
+
+  auto getFootprint = [&](llvm::ArrayRef<int64_t> tiles) {
+    int64_t ret = 0;
+    for (auto &operand : op->getOpOperands()) {
+      auto elemType = mlir::getElementTypeOrSelf(operand.get().getType());
+      int64_t elemSize = 8;
+      if (elemType.isIntOrFloat())
+        elemSize = llvm::divideCeil(elemType.getIntOrFloatBitWidth(), 8);
+
+      int64_t size = elemSize;
+      auto map = op.getMatchingIndexingMap(&operand);
+      for (auto i : llvm::seq(0u, numLoops)) {
+        if (!map.isFunctionOfDim(i))
+          continue;
+
+        auto tile = tiles[i];
+        if (tile == 0)
+          tile = ranges[i];
+
+        size *= tile;
+      }
+      ret += size;
+    }
+    return ret;
+  };
+
+  // Leave half of the cache for everything else.
+  auto budget = cacheSize / 2;
+  for (int64_t tile = kMaxTileSize; tile >= kMinTileSize; tile /= 2) {
+    auto tiles = getTileSizes(tile);
+    if (llvm::all_of(tiles, [](int64_t t) { return t == 0; }))
+      continue;
+
+    if (getFootprint(tiles) <= budget)
+      return tiles;
+  }
+  return {};
+}
+
+/// Returns user provided tile sizes for the op, set either on the op itself or
+/// on the parent function, or empty vector if there are none or their count
+/// doesn't match the number of loops.
+static llvm::SmallVector<int64_t> getTileSizesHint(mlir::func::FuncOp func,
+                                                   mlir::linalg::GenericOp op) {
+  auto name = numba::util::attributes::getTileSizesName();
+  auto attr = op->getAttrOfType<mlir::DenseI64ArrayAttr>(name);
+  if (!attr)
+    attr = func->getAttrOfType<mlir::DenseI64ArrayAttr>(name);
+
+  if (!attr || attr.size() != static_cast<int64_t>(op.getNumLoops()))
+    return {};
+
+  return llvm::to_vector(attr.asArrayRef());
+}
+
+/// Tile linalg.generic ops with poor memory locality for cache reuse.
+///
+/// Outer tiles are sized for L2 and are generated as scf.parallel, so they can
+/// be later converted to numba_util.parallel, inner tiles are sized for L1 and
+/// generated as sequential loops. Tile sizes can be overridden via
+/// `numba.tile_sizes` attribute (`tile_sizes` jit option), in which case single
+/// level of parallel tiling is done.
+struct TileLinalgForCachePass
+    : public mlir::PassWrapper<TileLinalgForCachePass,
+                               mlir::OperationPass<mlir::func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(TileLinalgForCachePass)
+
+  virtual void
+  getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::affine::AffineDialect>();
+    registry.insert<mlir::scf::SCFDialect>();
+  }
+
+  void runOnOperation() override {
+    auto func = getOperation();
+    if (getOptLevel(func) == 0)
+      return;
+
+    auto l1Size =
+        getCacheSize(func, numba::util::attributes::getL1CacheSizeName(),
+                     kDefaultL1CacheSize);
+    auto l2Size =
+        getCacheSize(func, numba::util::attributes::getL2CacheSizeName(),
+                     kDefaultL2CacheSize);
+
+    llvm::SmallVector<mlir::linalg::GenericOp> ops;
+    func->walk([&](mlir::linalg::GenericOp op) {
+      if (op.hasBufferSemantics() && op.getNumLoops() > 1 &&
+          op.getNumParallelLoops() > 0 && !isInsideGpuRegion(op))
+        ops.emplace_back(op);
+    });
+
+    mlir::IRRewriter rewriter(&getContext());
+    auto tile = [&](mlir::linalg::GenericOp op, llvm::ArrayRef<int64_t> sizes,
+                    mlir::linalg::LinalgTilingLoopType loopType)
+        -> mlir::linalg::GenericOp {
+      mlir::linalg::LinalgTilingOptions options;
+      options.setTileSizes(sizes).setLoopType(loopType);
+      rewriter.setInsertionPoint(op);
+      auto res = mlir::linalg::tileLinalgOp(rewriter, op, options);
+      if (mlir::failed(res))
+        return nullptr;
+
+      rewriter.eraseOp(op);
+      return mlir::cast<mlir::linalg::GenericOp>(res->op.getOperation());
+    };
+
+    for (auto op : ops) {
+      if (aliasesOutput(op))
+        continue;
+
+      auto hint = getTileSizesHint(func, op);
+      if (!hint.empty()) {
+        tile(op, hint, mlir::linalg::LinalgTilingLoopType::ParallelLoops);
+        continue;
+      }
+
+      if (!needCacheTiling(op))
+        continue;
+
+      auto l1Tiles = computeTileSizes(op, l1Size);
+      if (l1Tiles.empty())
+        continue;
+
+      auto l2Tiles = computeTileSizes(op, l2Size);
+      if (l2Tiles.empty() || l2Tiles == l1Tiles) {
+        tile(op, l1Tiles, mlir::linalg::LinalgTilingLoopType::ParallelLoops);
+        continue;
+      }
+
+      auto inner =
+          tile(op, l2Tiles, mlir::linalg::LinalgTilingLoopType::ParallelLoops);
+      if (!inner)
+        continue;
+
+      // Unit outer tiles don't need to be tiled again.
+      for (auto &&[l1, l2] : llvm::zip(l1Tiles, l2Tiles))
+        if (l2 == 1)
+          l1 = 0;
+
+      tile(inner, l1Tiles, mlir::linalg::LinalgTilingLoopType::Loops);
+    }
+  }
+
+private:
+  /// Tiling changes iteration order, which is only safe if outputs don't
+  /// overlap with inputs.
+  static bool aliasesOutput(mlir::linalg::GenericOp op) {
+    llvm::SmallPtrSet<mlir::Value, 4> outputs;
+    for (auto output : op.getDpsInitOperands())
+      outputs.insert(getRootMemref(output->get()));
+
+    return llvm::any_of(op.getDpsInputOperands(), [&](mlir::OpOperand *input) {
+      return outputs.contains(getRootMemref(input->get()));
+    });
+  }
+};
+
+static int64_t getHostVectorWidth() {
+  static int64_t width = []() -> int64_t {
+    llvm::StringMap<bool> features;
+    if (!llvm::sys::getHostCPUFeatures(features))
+      return 128;
+
+    if (features.lookup("avx512f"))
+      return 512;
+
+    if (features.lookup("avx"))
+      return 256;
+
+    return 128;
+  }();
+  return width;
+}
+
+static bool hasUnitInnermostStride(mlir::MemRefType type) {
+  if (type.getRank() == 0)
+    return true;
+
+  llvm::SmallVector<int64_t> strides;
+  int64_t offset;
+  if (mlir::failed(mlir::getStridesAndOffset(type, strides, offset)))
+    return false;
+
+  return strides.back() == 1;
+}
+
+/// Returns vector length for the innermost loop of the generic or 0 if it
+/// cannot be vectorized.
+static int64_t getVectorLength(mlir::linalg::GenericOp op, int64_t vectorWidth,
+                               bool fastmath) {
+  if (!op.hasBufferSemantics() || op.hasIndexSemantics() ||
+      op.getNumParallelLoops() == 0)
+    return 0;
+
+  auto innermost = op.getNumLoops() - 1;
+
+  // Vectorized reduction accumulates into multiple lanes, which changes
+  // the order of float operations and is only allowed under fastmath.
+  if (!fastmath &&
+      op.getIteratorTypesArray()[innermost] ==
+          mlir::utils::IteratorType::reduction &&
+      llvm::any_of(op.getDpsInitOperands(), [](mlir::OpOperand *output) {
+        return mlir::isa<mlir::FloatType>(
+            mlir::getElementTypeOrSelf(output->get().getType()));
+      }))
+    return 0;
+
+  for (auto &bodyOp : op.getBody()->without_terminator()) {
+    auto dialect = bodyOp.getDialect();
+    if (!mlir::isa_and_nonnull<mlir::arith::ArithDialect,
+                               mlir::math::MathDialect>(dialect))
+      return 0;
+
+    for (auto type : bodyOp.getResultTypes())
+      if (!type.isIntOrFloat())
+        return 0;
+  }
+
+  unsigned maxBitwidth = 0;
+  for (auto &operand : op->getOpOperands()) {
+    auto memrefType = mlir::dyn_cast<mlir::MemRefType>(operand.get().getType());
+    if (!memrefType)
+      return 0;
+
+    // Bool memrefs are promoted later.
+    auto elemType = memrefType.getElementType();
+    if (!elemType.isIntOrFloat() || elemType.isInteger(1))
+      return 0;
+
+    maxBitwidth = std::max(maxBitwidth, elemType.getIntOrFloatBitWidth());
+
+    auto map = op.getMatchingIndexingMap(&operand);
+    if (!map.isProjectedPermutation())
+      return 0;
+
+    // Operand must be either contiguous or broadcasted along innermost loop.
+    if (!map.isFunctionOfDim(innermost))
+      continue;
+
+    auto last = map.getResults().back().dyn_cast<mlir::AffineDimExpr>();
+    if (!last || last.getPosition() != innermost ||
+        !hasUnitInnermostStride(memrefType))
+      return 0;
+  }
+
+  if (maxBitwidth == 0)
+    return 0;
+
+  auto len = vectorWidth / maxBitwidth;
+  if (len < 2)
+    return 0;
+
+  auto innerRange = op.getStaticLoopRanges()[innermost];
+  if (!mlir::ShapedType::isDynamic(innerRange) && innerRange < len)
+    return 0;
+
+  return len;
+}
+
+/// Tracks ops created through the rewriter, so cleanup patterns can be applied
+/// only to them instead of the entire function.
+struct CreatedOpsListener : public mlir::RewriterBase::Listener {
+  void notifyOperationInserted(mlir::Operation *op) override {
+    ops.insert(op);
+  }
+
+  void notifyOperationRemoved(mlir::Operation *op) override {
+    op->walk([&](mlir::Operation *nested) { ops.remove(nested); });
+  }
+
+  llvm::SetVector<mlir::Operation *> ops;
+};
+
+/// Vectorize innermost loop of linalg.generic ops to the host vector width.
+///
+/// Generic is tiled to unit tiles on the outer dims (as parallel loops) and to
+/// vector-sized tiles on the innermost one. Innermost loop is then peeled, so
+/// its main part has static shape and is vectorized via vector dialect without
+/// masking, remainder is left to the scalar lowering.
+struct VectorizeLinalgPass
+    : public mlir::PassWrapper<VectorizeLinalgPass,
+                               mlir::OperationPass<mlir::func::FuncOp>> {
+  MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(VectorizeLinalgPass)
+
+  virtual void
+  getDependentDialects(mlir::DialectRegistry &registry) const override {
+    registry.insert<mlir::affine::AffineDialect>();
+    registry.insert<mlir::scf::SCFDialect>();
+    registry.insert<mlir::vector::VectorDialect>();
+  }
+
+  void runOnOperation() override {
+    auto func = getOperation();
+    if (getOptLevel(func) < 2)
+      return;
+
+    int64_t vectorWidth = getHostVectorWidth();
+    if (auto attr = func->getAttrOfType<mlir::IntegerAttr>(
+            numba::util::attributes::getVectorWidthName()))
+      vectorWidth = attr.getInt();
+
+    if (vectorWidth <= 0)
+      return;
+
+    bool fastmath = func->hasAttr(numba::util::attributes::getFastmathName());
+    llvm::SmallVector<std::pair<mlir::linalg::GenericOp, int64_t>> ops;
+    func->walk([&](mlir::linalg::GenericOp op) {
+      if (isInsideGpuRegion(op))
+        return;
+
+      if (auto len = getVectorLength(op, vectorWidth, fastmath))
+        ops.emplace_back(op, len);
+    });
+
+    if (ops.empty())
+      return;
+
+    auto &context = getContext();
+    auto vectorizeAttrName = mlir::StringAttr::get(&context, "numba.vectorize");
+    auto unitAttr = mlir::UnitAttr::get(&context);
+    CreatedOpsListener listener;
+    mlir::IRRewriter rewriter(&context, &listener);
+    auto tile = [&](mlir::linalg::GenericOp op, llvm::ArrayRef<int64_t> sizes,
+                    mlir::linalg::LinalgTilingLoopType loopType)
+        -> mlir::FailureOr<mlir::linalg::TiledLinalgOp> {
+      mlir::linalg::LinalgTilingOptions options;
+      options.setTileSizes(sizes).setLoopType(loopType);
+      rewriter.setInsertionPoint(op);
+      auto res = mlir::linalg::tileLinalgOp(rewriter, op, options);
+      if (mlir::succeeded(res))
+        rewriter.eraseOp(op);
+
+      return res;
+    };
+
+    for (auto &&[op, len] : ops) {
+      auto numLoops = op.getNumLoops();
+      if (numLoops > 1) {
+        llvm::SmallVector<int64_t> outerTiles(numLoops, 1);
+        outerTiles.back() = 0;
+        auto res = tile(op, outerTiles,
+                        mlir::linalg::LinalgTilingLoopType::ParallelLoops);
+        if (mlir::failed(res))
+          continue;
+
+        op = mlir::cast<mlir::linalg::GenericOp>(res->op.getOperation());
+      }
+
+      llvm::SmallVector<int64_t> innerTiles(numLoops, 0);
+      innerTiles.back() = len;
+      auto res =
+          tile(op, innerTiles, mlir::linalg::LinalgTilingLoopType::Loops);
+      if (mlir::failed(res))
+        continue;
+
+      auto inner = res->op;
+      if (!res->loops.empty())
+        if (auto loop = mlir::dyn_cast<mlir::scf::ForOp>(res->loops.back())) {
+          mlir::scf::ForOp partial;
+          (void)mlir::scf::peelForLoopAndSimplifyBounds(rewriter, loop,
+                                                        partial);
+        }
+
+      inner->setAttr(vectorizeAttrName, unitAttr);
+    }
+
+    // Fold static tile sizes into the subview types. Only touch ops created by
+    // tiling and peeling, the rest of the function is left to the later
+    // canonicalization passes.
+    mlir::RewritePatternSet canonPatterns(&context);
+    numba::populateCanonicalizationPatterns(canonPatterns);
+    (void)mlir::applyOpPatternsAndFold(listener.ops.getArrayRef(),
+                                       std::move(canonPatterns));
+
+    // Greedy driver doesn't report back to our listener, so handles collected
+    // so far may be dangling.
+    listener.ops.clear();
+
+    llvm::SmallVector<mlir::linalg::GenericOp> toVectorize;
+    func->walk([&](mlir::linalg::GenericOp op) {
+      if (op->removeAttr(vectorizeAttrName) && !op.hasDynamicShape())
+        toVectorize.emplace_back(op);
+    });
+
+    for (auto op : toVectorize) {
+      rewriter.setInsertionPoint(op);
+      (void)mlir::linalg::vectorize(rewriter, op);
+    }
+
+    if (listener.ops.empty())
+      return;
+
+    mlir::RewritePatternSet patterns(&context);
+    mlir::vector::populateCastAwayVectorLeadingOneDimPatterns(patterns);
+    numba::populateCanonicalizationPatterns(patterns);
+    (void)mlir::applyOpPatternsAndFold(listener.ops.getArrayRef(),
+                                       std::move(patterns));
+  }
+};
+
 /// Later passes (e.g. buffer deallocation) may not know how to handle poison
 /// memrefs. Replace them with dummy zero-size allocations.
 struct ReplaceMemrefPoison : public mlir::OpRewritePattern<mlir::ub::PoisonOp> {
@@ -4212,6 +4707,9 @@ static void populatePlierToLinalgOptPipeline(mlir::OpPassManager &pm) {
   pm.addNestedPass<mlir::func::FuncOp>(
       std::make_unique<MakeGenericReduceInnermostPass>());
   pm.addNestedPass<mlir::func::FuncOp>(std::make_unique<LowerCopyOpsPass>());
+  pm.addNestedPass<mlir::func::FuncOp>(
+      std::make_unique<TileLinalgForCachePass>());
+  pm.addNestedPass<mlir::func::FuncOp>(std::make_unique<VectorizeLinalgPass>());
   pm.addNestedPass<mlir::func::FuncOp>(
       mlir::createConvertLinalgToParallelLoopsPass());
   pm.addNestedPass<mlir::func::FuncOp>(
@@ -4261,6 +4759,7 @@ static void populatePlierToLinalgOptPipeline(mlir::OpPassManager &pm) {
   pm.addNestedPass<mlir::func::FuncOp>(mlir::math::createMathUpliftToFMA());
   pm.addNestedPass<mlir::func::FuncOp>(mlir::createCanonicalizerPass());
   populateDeallocationPipeline(pm);
+  pm.addNestedPass<mlir::func::FuncOp>(numba::createBufferReusePass());
 
   pm.addPass(mlir::createSymbolDCEPass());
 }
@@ -746,9 +746,7 @@ static void rerunScfPipeline(mlir::Operation *op) {
   assert(nullptr != op);
   auto marker =
       mlir::StringAttr::get(op->getContext(), plierToScfPipelineName());
-  auto mod = op->getParentOfType<mlir::ModuleOp>();
-  assert(nullptr != mod);
-  numba::addPipelineJumpMarker(mod, marker);
+  numba::addPipelineJumpMarker(op, marker);
 }
 
 static mlir::LogicalResult
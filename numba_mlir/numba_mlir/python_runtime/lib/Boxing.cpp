@@ -5,6 +5,8 @@
 #include "PythonRt.hpp"
 
 #include <memory>
+#include <string>
+#include <unordered_map>
 
 #define NPY_NO_DEPRECATED_API NPY_1_7_API_VERSION
 
@@ -13,6 +15,15 @@
 
 #define SYCL_USM_ARRAY_INTERFACE "__sycl_usm_array_interface__"
 
+// Unboxing runs on every call of jitted function with USM array arguments, so
+// avoid per-call work where possible:
+//  * If dpctl C API was registered via `nmrtSetUsmArrayApi`, `usm_ndarray`
+//    fields are read directly, without constructing interface dict.
+//  * Otherwise interface dict is parsed using pre-interned keys and itemsize
+//    is taken from the typestr cache instead of creating numpy descriptor.
+//
+// All functions here are called with GIL held.
+
 namespace {
 struct arystruct_t {
   void *meminfo; /* see _nrt_python.c and nrt.h in numba/core/runtime */
@@ -27,6 +38,31 @@ struct arystruct_t {
 struct RefDeleter {
   template <typename T> void operator()(T *obj) const { Py_DECREF(obj); }
 };
+
+// Subset of dpctl `usm_ndarray` C API (`dpctl.tensor._usmarray.__pyx_capi__`).
+struct UsmArrayApi {
+  using GetDataT = char *(*)(PyObject *);
+  using GetNDimT = int (*)(PyObject *);
+  using GetShapeT = Py_ssize_t *(*)(PyObject *);
+  using GetStridesT = Py_ssize_t *(*)(PyObject *);
+  using GetElementSizeT = int (*)(PyObject *);
+
+  PyTypeObject *type = nullptr;
+  GetDataT getData = nullptr;
+  GetNDimT getNDim = nullptr;
+  GetShapeT getShape = nullptr;
+  GetStridesT getStrides = nullptr;
+  GetElementSizeT getElementSize = nullptr;
+};
+
+struct InterfaceKeys {
+  PyObject *iface;
+  PyObject *data;
+  PyObject *shape;
+  PyObject *strides;
+  PyObject *typestr;
+  PyObject *offset;
+};
 } // namespace
 
 template <typename T> static std::unique_ptr<T, RefDeleter> makeRef(T *ref) {
@@ -42,95 +78,218 @@ static bool initNumpy() {
   return init;
 }
 
-extern "C" NUMBA_MLIR_PYTHON_RUNTIME_EXPORT int
-nmrtUnboxSyclInterface(PyObject *obj, arystruct_t *arystruct) {
-  if (!initNumpy())
+static UsmArrayApi usmArrayApi;
+
+static const InterfaceKeys *getInterfaceKeys() {
+  // Interned strings are never released.
+  static InterfaceKeys keys = {
+      PyUnicode_InternFromString(SYCL_USM_ARRAY_INTERFACE),
+      PyUnicode_InternFromString("data"),
+      PyUnicode_InternFromString("shape"),
+      PyUnicode_InternFromString("strides"),
+      PyUnicode_InternFromString("typestr"),
+      PyUnicode_InternFromString("offset"),
+  };
+  if (!keys.iface || !keys.data || !keys.shape || !keys.strides ||
+      !keys.typestr || !keys.offset)
+    return nullptr;
+
+  return &keys;
+}
+
+static npy_intp getItemsize(PyObject *typestr) {
+  Py_ssize_t len = 0;
+  auto str = PyUnicode_AsUTF8AndSize(typestr, &len);
+  if (!str)
     return -1;
 
-  auto iface = makeRef(PyObject_GetAttrString(obj, SYCL_USM_ARRAY_INTERFACE));
-  if (!iface)
+  // Number of distinct typestrs is small, entries are never evicted.
+  static std::unordered_map<std::string, npy_intp> cache;
+  std::string key(str, static_cast<size_t>(len));
+  auto it = cache.find(key);
+  if (it != cache.end())
+    return it->second;
+
+  PyArray_Descr *descr = nullptr;
+  if (!PyArray_DescrConverter(typestr, &descr))
     return -1;
 
-  auto data = [&]() -> void * {
-    auto dataTuple = PyDict_GetItemString(iface.get(), "data");
-    if (!dataTuple)
-      return nullptr;
+  auto descrRef = makeRef(descr);
+  npy_intp itemsize = descr->elsize;
+  cache.emplace(std::move(key), itemsize);
+  return itemsize;
+}
 
-    auto item = PyTuple_GetItem(dataTuple, 0);
-    if (!PyLong_Check(item))
-      return nullptr;
+static bool getIntItem(PyObject *tuple, Py_ssize_t i, npy_intp &res) {
+  auto elem = PyTuple_GetItem(tuple, i);
+  if (!elem || !PyLong_Check(elem))
+    return false;
 
-    return PyLong_AsVoidPtr(item);
-  }();
+  res = PyLong_AsSsize_t(elem);
+  return !(res == -1 && PyErr_Occurred());
+}
+
+static void fillContiguousStrides(npy_intp ndim, const npy_intp *dims,
+                                  npy_intp itemsize, npy_intp *strides) {
+  npy_intp stride = itemsize;
+  for (npy_intp i = 0; i < ndim; i++) {
+    strides[ndim - i - 1] = stride;
+    stride *= dims[ndim - i - 1];
+  }
+}
+
+static void parentDtor(void * /*ptr*/, size_t /*size*/, void *info) {
+  // Meminfo can be released from the thread not holding GIL.
+  auto state = PyGILState_Ensure();
+  Py_DECREF(static_cast<PyObject *>(info));
+  PyGILState_Release(state);
+}
+
+// Meminfo keeps parent object alive, as data is owned by it.
+static int initMeminfo(PyObject *obj, arystruct_t *arystruct) {
+  auto size = static_cast<size_t>(arystruct->itemsize * arystruct->nitems);
+  auto meminfo = nmrtAllocMemInfo(arystruct->data, size, &parentDtor, obj);
+  if (!meminfo)
+    return -1;
+
+  Py_INCREF(obj);
+  arystruct->meminfo = meminfo;
+  arystruct->parent = obj;
+  return 0;
+}
+
+static int unboxUsmArray(PyObject *obj, arystruct_t *arystruct) {
+  auto &api = usmArrayApi;
+  auto ndim = static_cast<npy_intp>(api.getNDim(obj));
+  auto itemsize = static_cast<npy_intp>(api.getElementSize(obj));
+  auto shape = api.getShape(obj);
+  auto srcStrides = api.getStrides(obj);
+
+  auto *dims = &arystruct->shape_and_strides[0];
+  auto *strides = dims + ndim;
+
+  npy_intp nitems = 1;
+  for (npy_intp i = 0; i < ndim; i++) {
+    dims[i] = shape[i];
+    nitems *= shape[i];
+  }
+
+  // Null strides mean C-contiguous array, strides are in elements.
+  if (!srcStrides) {
+    fillContiguousStrides(ndim, dims, itemsize, strides);
+  } else {
+    for (npy_intp i = 0; i < ndim; i++)
+      strides[i] = srcStrides[i] * itemsize;
+  }
+
+  arystruct->data = api.getData(obj);
+  arystruct->itemsize = itemsize;
+  arystruct->nitems = nitems;
+  return initMeminfo(obj, arystruct);
+}
 
+static int unboxInterface(PyObject *obj, arystruct_t *arystruct) {
+  auto keys = getInterfaceKeys();
+  if (!keys)
+    return -1;
+
+  auto iface = makeRef(PyObject_GetAttr(obj, keys->iface));
+  if (!iface || !PyDict_Check(iface.get()))
+    return -1;
+
+  auto dataTuple = PyDict_GetItem(iface.get(), keys->data);
+  if (!dataTuple)
+    return -1;
+
+  auto dataItem = PyTuple_GetItem(dataTuple, 0);
+  if (!dataItem || !PyLong_Check(dataItem))
+    return -1;
+
+  auto data = static_cast<char *>(PyLong_AsVoidPtr(dataItem));
   if (!data)
     return -1;
 
-  auto shapeObj = PyDict_GetItemString(iface.get(), "shape");
+  auto shapeObj = PyDict_GetItem(iface.get(), keys->shape);
   if (!shapeObj)
     return -1;
 
-  auto stridesObj = PyDict_GetItemString(iface.get(), "strides");
-  if (!stridesObj)
+  auto typestr = PyDict_GetItem(iface.get(), keys->typestr);
+  if (!typestr)
+    return -1;
+
+  auto itemsize = getItemsize(typestr);
+  if (itemsize < 0)
     return -1;
 
   auto ndim = PyTuple_Size(shapeObj);
   if (ndim < 0)
     return -1;
 
-  arystruct->data = data;
-  arystruct->parent = obj;
   auto *dims = &arystruct->shape_and_strides[0];
   auto *strides = dims + ndim;
 
   npy_intp nitems = 1;
   for (decltype(ndim) i = 0; i < ndim; i++) {
-    auto elem = PyTuple_GetItem(shapeObj, i);
-    if (!elem || !PyLong_Check(elem))
+    if (!getIntItem(shapeObj, i, dims[i]))
       return -1;
 
-    auto val = PyLong_AsLong(elem);
-    nitems *= val;
-    dims[i] = val;
+    nitems *= dims[i];
   }
-  auto itemsize = [&]() -> npy_intp {
-    auto typestr = PyDict_GetItemString(iface.get(), "typestr");
-    if (!typestr)
-      return -1;
 
-    PyArray_Descr *descr = nullptr;
-    if (!PyArray_DescrConverter(typestr, &descr))
-      return -1;
+  // Strides and offset are optional and are in elements.
+  auto stridesObj = PyDict_GetItem(iface.get(), keys->strides);
+  if (!stridesObj || stridesObj == Py_None) {
+    fillContiguousStrides(ndim, dims, itemsize, strides);
+  } else {
+    for (decltype(ndim) i = 0; i < ndim; i++) {
+      if (!getIntItem(stridesObj, i, strides[i]))
+        return -1;
 
-    auto descrRef = makeRef(descr);
-    return descr->elsize;
-  }();
+      strides[i] *= itemsize;
+    }
+  }
 
-  if (itemsize < 0)
-    return -1;
+  auto offsetObj = PyDict_GetItem(iface.get(), keys->offset);
+  if (offsetObj && offsetObj != Py_None) {
+    auto offset = PyLong_AsSsize_t(offsetObj);
+    if (offset == -1 && PyErr_Occurred())
+      return -1;
 
+    data += offset * itemsize;
+  }
+
+  arystruct->data = data;
   arystruct->itemsize = itemsize;
   arystruct->nitems = nitems;
+  return initMeminfo(obj, arystruct);
+}
 
-  if (stridesObj == Py_None) {
-    npy_intp stride = itemsize;
-    for (decltype(ndim) i = 0; i < ndim; i++) {
-      strides[ndim - i - 1] = stride;
-      stride *= dims[ndim - i - 1];
-    }
-  } else {
-    for (decltype(ndim) i = 0; i < ndim; i++) {
-      auto elem = makeRef(PyTuple_GetItem(stridesObj, i));
-      if (!elem || !PyLong_Check(elem.get()))
-        return -1;
+extern "C" NUMBA_MLIR_PYTHON_RUNTIME_EXPORT void
+nmrtSetUsmArrayApi(PyObject *type, void *getData, void *getNDim,
+                   void *getShape, void *getStrides, void *getElementSize) {
+  if (!PyType_Check(type) || !getData || !getNDim || !getShape ||
+      !getStrides || !getElementSize)
+    return;
 
-      strides[i] = PyLong_AsLong(elem.get()) * itemsize;
-    }
-  }
+  // Type is never released, API functions pointers must stay valid.
+  Py_INCREF(type);
+  auto &api = usmArrayApi;
+  api.getData = reinterpret_cast<UsmArrayApi::GetDataT>(getData);
+  api.getNDim = reinterpret_cast<UsmArrayApi::GetNDimT>(getNDim);
+  api.getShape = reinterpret_cast<UsmArrayApi::GetShapeT>(getShape);
+  api.getStrides = reinterpret_cast<UsmArrayApi::GetStridesT>(getStrides);
+  api.getElementSize =
+      reinterpret_cast<UsmArrayApi::GetElementSizeT>(getElementSize);
+  api.type = reinterpret_cast<PyTypeObject *>(type);
+}
+
+extern "C" NUMBA_MLIR_PYTHON_RUNTIME_EXPORT int
+nmrtUnboxSyclInterface(PyObject *obj, arystruct_t *arystruct) {
+  if (!initNumpy())
+    return -1;
 
-  // TODO: dtor
-  arystruct->meminfo =
-      nmrtAllocMemInfo(data, itemsize * nitems, nullptr, nullptr);
+  if (usmArrayApi.type && Py_TYPE(obj) == usmArrayApi.type)
+    return unboxUsmArray(obj, arystruct);
 
-  return 0;
+  return unboxInterface(obj, arystruct);
 }
@@ -2,15 +2,183 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
 #include "numba-mlir-runtime_export.h"
 
 using AllocToken = void *;
 
+// Tokens are created and destroyed for every array allocation and every
+// retain, so instead of going to the heap each time they are carved from
+// slabs and recycled through per-thread free lists. Threads exchange tokens
+// with the global pool in batches, so the lock is only taken once per
+// `kBatchSize` operations.
+
+namespace {
+union TokenSlot {
+  AllocToken token;
+  TokenSlot *next;
+};
+
+constexpr size_t kBatchSize = 256;
+constexpr size_t kSlabSize = kBatchSize * 16;
+constexpr size_t kMaxCachedTokens = kBatchSize * 2;
+
+struct TokenList {
+  TokenSlot *head = nullptr;
+  size_t count = 0;
+
+  void push(TokenSlot *slot) {
+    slot->next = head;
+    head = slot;
+    ++count;
+  }
+
+  TokenSlot *pop() {
+    auto slot = head;
+    head = slot->next;
+    --count;
+    return slot;
+  }
+
+  TokenList split(size_t n) {
+    TokenList ret;
+    while (ret.count < n)
+      ret.push(pop());
+
+    return ret;
+  }
+};
+
+struct GlobalPool {
+  TokenList getBatch() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (batches.empty())
+      allocSlab();
+
+    auto ret = batches.back();
+    batches.pop_back();
+    return ret;
+  }
+
+  void putBatch(TokenList batch) {
+    if (batch.count == 0)
+      return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    batches.emplace_back(batch);
+  }
+
+  size_t getFreeCount() {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t ret = 0;
+    for (auto &batch : batches)
+      ret += batch.count;
+
+    return ret;
+  }
+
+private:
+  void allocSlab() {
+    // Slabs are never returned to the system, pool size is bounded by the
+    // peak number of live tokens.
+    auto slab = std::make_unique<TokenSlot[]>(kSlabSize);
+    for (size_t i = 0; i < kSlabSize; i += kBatchSize) {
+      TokenList batch;
+      for (size_t j = 0; j < kBatchSize; ++j)
+        batch.push(&slab[i + j]);
+
+      batches.emplace_back(batch);
+    }
+    slabs.emplace_back(std::move(slab));
+  }
+
+  std::mutex mutex;
+  std::vector<TokenList> batches;
+  std::vector<std::unique_ptr<TokenSlot[]>> slabs;
+};
+
+static GlobalPool &getGlobalPool() {
+  // Intentionally leaked, tokens can be released from thread-local
+  // destructors after static objects were destroyed.
+  static auto *pool = new GlobalPool;
+  return *pool;
+}
+
+struct ThreadCache {
+  ThreadCache() { alive = true; }
+
+  ~ThreadCache() {
+    alive = false;
+    getGlobalPool().putBatch(tokens);
+  }
+
+  TokenSlot *alloc() {
+    if (tokens.count == 0)
+      tokens = getGlobalPool().getBatch();
+
+    return tokens.pop();
+  }
+
+  void free(TokenSlot *slot) {
+    tokens.push(slot);
+    if (tokens.count > kMaxCachedTokens)
+      getGlobalPool().putBatch(tokens.split(kBatchSize));
+  }
+
+  size_t getCachedCount() const { return tokens.count; }
+
+  static thread_local bool alive;
+
+private:
+  TokenList tokens;
+};
+
+thread_local bool ThreadCache::alive = false;
+
+static ThreadCache *getThreadCache() {
+  static thread_local ThreadCache cache;
+  return ThreadCache::alive ? &cache : nullptr;
+}
+} // namespace
+
 extern "C" NUMBA_MLIR_RUNTIME_EXPORT AllocToken *nmrtCreateAllocToken() {
-  return new AllocToken;
+  TokenSlot *slot;
+  if (auto cache = getThreadCache()) {
+    slot = cache->alloc();
+  } else {
+    auto batch = getGlobalPool().getBatch();
+    slot = batch.pop();
+    getGlobalPool().putBatch(batch);
+  }
+  return &slot->token;
 }
 
 extern "C" NUMBA_MLIR_RUNTIME_EXPORT void
 nmrtDestroyAllocToken(AllocToken *token) {
-  delete token;
+  if (!token)
+    return;
+
+  auto slot = reinterpret_cast<TokenSlot *>(token);
+  if (auto cache = getThreadCache()) {
+    cache->free(slot);
+  } else {
+    TokenList batch;
+    batch.push(slot);
+    getGlobalPool().putBatch(batch);
+  }
+}
+
+/// Returns number of free tokens, retained by the calling thread cache.
+extern "C" NUMBA_MLIR_RUNTIME_EXPORT size_t nmrtAllocTokenGetCachedCount() {
+  auto cache = getThreadCache();
+  return cache ? cache->getCachedCount() : 0;
+}
+
+/// Returns number of free tokens in the global pool.
+extern "C" NUMBA_MLIR_RUNTIME_EXPORT size_t nmrtAllocTokenGetPoolCount() {
+  return getGlobalPool().getFreeCount();
 }
@@ -2,24 +2,206 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 #include "numba-mlir-runtime_export.h"
 
 using init_func_t = void (*)(void *);
 using release_func_t = void (*)(void *);
 
+// Each `take_context` site owns a pool of initialized contexts, stored in the
+// module-level handle. `nmrtTakeContext` returns context, exclusively owned by
+// the caller until `nmrtReleaseContext`, which returns it to the pool without
+// deinitialization, so concurrent callers get different contexts and
+// sequential callers reuse them. Contexts are only deinitialized by
+// `nmrtPurgeContext` on module unload.
+//
+// Released contexts are first cached in small per-thread table, so the same
+// thread calling the same function repeatedly doesn't touch the pool lock.
+
 namespace {
+struct ContextPool;
+
 struct Context {
-  release_func_t releaseFunc;
+  ContextPool *pool;
   std::aligned_storage_t<8> data;
 };
+
+struct ContextPool {
+  uint64_t id;
+  size_t contextSize;
+  init_func_t initFunc;
+  release_func_t releaseFunc;
+
+  std::mutex mutex;
+  std::vector<Context *> freeContexts;
+  std::vector<Context *> allContexts;
+
+  Context *take() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!freeContexts.empty()) {
+        auto ctx = freeContexts.back();
+        freeContexts.pop_back();
+        return ctx;
+      }
+    }
+
+    // Run init outside the lock, it can be arbitrary expensive.
+    auto inlineSize = sizeof(Context::data);
+    auto bytesToAlloc = contextSize <= inlineSize
+                            ? sizeof(Context)
+                            : sizeof(Context) + contextSize - inlineSize;
+    auto ctx = reinterpret_cast<Context *>(new char[bytesToAlloc]);
+    ctx->pool = this;
+    if (initFunc)
+      initFunc(&ctx->data);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    allContexts.emplace_back(ctx);
+    return ctx;
+  }
+
+  void release(Context *ctx) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeContexts.emplace_back(ctx);
+  }
+
+  ~ContextPool() {
+    for (auto ctx : allContexts) {
+      if (releaseFunc)
+        releaseFunc(&ctx->data);
+
+      delete[] reinterpret_cast<char *>(ctx);
+    }
+  }
+};
+
+// Registry of live pools, used to validate per-thread cache entries, which
+// can outlive their pools.
+struct PoolRegistry {
+  std::mutex mutex;
+  std::unordered_map<uint64_t, ContextPool *> pools;
+  uint64_t nextId = 1;
+
+  ContextPool *lookup(uint64_t id) {
+    auto it = pools.find(id);
+    return it == pools.end() ? nullptr : it->second;
+  }
+};
+
+static PoolRegistry &getRegistry() {
+  // Intentionally leaked, thread caches can be destroyed after statics.
+  static auto *registry = new PoolRegistry;
+  return *registry;
+}
+
+static void returnToPool(uint64_t id, Context *ctx) {
+  auto &registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  // Pool was purged, context was already destroyed.
+  if (auto pool = registry.lookup(id))
+    pool->release(ctx);
+}
+
+struct ThreadCache {
+  struct Entry {
+    uint64_t poolId = 0;
+    Context *ctx = nullptr;
+  };
+
+  static constexpr size_t kNumEntries = 16;
+
+  ThreadCache() { alive = true; }
+
+  ~ThreadCache() {
+    alive = false;
+    for (auto &entry : entries)
+      if (entry.ctx)
+        returnToPool(entry.poolId, entry.ctx);
+  }
+
+  Context *take(ContextPool *pool) {
+    auto &entry = getEntry(pool->id);
+    if (!entry.ctx || entry.poolId != pool->id)
+      return nullptr;
+
+    auto ctx = entry.ctx;
+    entry.ctx = nullptr;
+    return ctx;
+  }
+
+  void release(Context *ctx) {
+    auto id = ctx->pool->id;
+    auto &entry = getEntry(id);
+    if (entry.ctx) {
+      // Evict old entry, pool pointer in the evicted context may be dangling
+      // so use id from the entry.
+      auto oldId = entry.poolId;
+      auto oldCtx = entry.ctx;
+      entry = Entry{id, ctx};
+      returnToPool(oldId, oldCtx);
+      return;
+    }
+    entry = Entry{id, ctx};
+  }
+
+  static thread_local bool alive;
+
+private:
+  Entry &getEntry(uint64_t id) { return entries[id % kNumEntries]; }
+
+  std::array<Entry, kNumEntries> entries;
+};
+
+thread_local bool ThreadCache::alive = false;
+
+static ThreadCache *getThreadCache() {
+  static thread_local ThreadCache cache;
+  return ThreadCache::alive ? &cache : nullptr;
+}
+
+static std::atomic<ContextPool *> &getPoolHandle(void **ctxHandle) {
+  static_assert(sizeof(std::atomic<ContextPool *>) == sizeof(void *),
+                "Unexpected atomic size");
+  return *reinterpret_cast<std::atomic<ContextPool *> *>(ctxHandle);
+}
+
+static ContextPool *getOrCreatePool(void **ctxHandle, size_t contextSize,
+                                    init_func_t init, release_func_t release) {
+  auto &handle = getPoolHandle(ctxHandle);
+  if (auto pool = handle.load(std::memory_order_acquire))
+    return pool;
+
+  auto &registry = getRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  if (auto pool = handle.load(std::memory_order_acquire))
+    return pool;
+
+  auto pool = new ContextPool;
+  pool->id = registry.nextId++;
+  pool->contextSize = contextSize;
+  pool->initFunc = init;
+  pool->releaseFunc = release;
+  registry.pools.emplace(pool->id, pool);
+  handle.store(pool, std::memory_order_release);
+  return pool;
+}
 } // namespace
 
-static void *toData(void *ptr) {
-  return &(reinterpret_cast<Context *>(ptr)->data);
+static void *toData(Context *ctx) { return &ctx->data; }
+
+static Context *fromData(void *data) {
+  return reinterpret_cast<Context *>(static_cast<char *>(data) -
+                                     offsetof(Context, data));
 }
 
 extern "C" NUMBA_MLIR_RUNTIME_EXPORT void *
@@ -27,34 +209,43 @@ nmrtTakeContext(void **ctxHandle, size_t contextSize, init_func_t init,
                 release_func_t release) {
   assert(ctxHandle);
   assert(contextSize > 0);
-  if (!*ctxHandle) {
-    auto inlineSize = sizeof(Context::data);
-    auto bytesToAlloc = contextSize <= inlineSize
-                            ? sizeof(Context)
-                            : sizeof(Context) + contextSize - inlineSize;
-    auto &context = *reinterpret_cast<Context *>(new char[bytesToAlloc]);
-    if (init)
-      init(&context.data);
-    context.releaseFunc = release;
-    *ctxHandle = &context;
-  }
-  return toData(*ctxHandle);
+  auto pool = getOrCreatePool(ctxHandle, contextSize, init, release);
+  assert(pool->contextSize == contextSize);
+
+  Context *ctx = nullptr;
+  if (auto cache = getThreadCache())
+    ctx = cache->take(pool);
+
+  if (!ctx)
+    ctx = pool->take();
+
+  return toData(ctx);
 }
 
-extern "C" NUMBA_MLIR_RUNTIME_EXPORT void
-nmrtReleaseContext(void * /*context*/) {
-  // Nothing For now
+extern "C" NUMBA_MLIR_RUNTIME_EXPORT void nmrtReleaseContext(void *context) {
+  if (!context)
+    return;
+
+  auto ctx = fromData(context);
+  if (auto cache = getThreadCache()) {
+    cache->release(ctx);
+  } else {
+    ctx->pool->release(ctx);
+  }
 }
 
 extern "C" NUMBA_MLIR_RUNTIME_EXPORT void nmrtPurgeContext(void **ctxHandle) {
   assert(ctxHandle);
-  if (*ctxHandle) {
-    auto &context = *reinterpret_cast<Context *>(*ctxHandle);
-    auto release = context.releaseFunc;
-    if (release)
-      release(&context.data);
+  auto &handle = getPoolHandle(ctxHandle);
+  ContextPool *pool;
+  {
+    auto &registry = getRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    pool = handle.exchange(nullptr, std::memory_order_acq_rel);
+    if (!pool)
+      return;
 
-    delete[] reinterpret_cast<char *>(&context);
-    *ctxHandle = nullptr;
+    registry.pools.erase(pool->id);
   }
+  delete pool;
 }
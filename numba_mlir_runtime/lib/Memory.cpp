@@ -2,6 +2,8 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <algorithm>
+#include <cassert>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
@@ -14,6 +16,8 @@
 
 #include "numba-mlir-runtime_export.h"
 
+#include "ParallelUtils.hpp"
+
 template <typename T, int N> struct MemRefDescriptor {
   T *allocated;
   T *aligned;
@@ -29,6 +33,107 @@ _mlir_ciface_fillResource1DFloat(MemRefDescriptor<float, 1> *ptr, // NOLINT
   std::fill_n(ptr->allocated, ptr->sizes[0], value);
 }
 
+namespace {
+struct CopyDim {
+  int64_t size;
+  int64_t srcStride; // In bytes.
+  int64_t dstStride; // In bytes.
+};
+
+struct CopyDesc {
+  char *dst;
+  const char *src;
+  const CopyDim *dims;
+  int64_t numDims;
+  int64_t elemSize;
+};
+
+// Copies of this size and above are split between threads.
+static const constexpr int64_t kParallelCopyThreshold = 4 << 20;
+static const constexpr int64_t kParallelCopyChunk = 256 << 10;
+} // namespace
+
+template <typename T>
+static void copyStrided(char *dst, const char *src, int64_t count,
+                        int64_t dstStride, int64_t srcStride) {
+  for (int64_t i = 0; i < count; ++i) {
+    T val;
+    memcpy(&val, src + i * srcStride, sizeof(T));
+    memcpy(dst + i * dstStride, &val, sizeof(T));
+  }
+}
+
+static void copyInner(char *dst, const char *src, const CopyDim &dim,
+                      int64_t elemSize) {
+  if (dim.srcStride == elemSize && dim.dstStride == elemSize) {
+    memcpy(dst, src, static_cast<size_t>(dim.size * elemSize));
+    return;
+  }
+
+  auto count = dim.size;
+  auto dstStride = dim.dstStride;
+  auto srcStride = dim.srcStride;
+  switch (elemSize) {
+  case 1:
+    return copyStrided<uint8_t>(dst, src, count, dstStride, srcStride);
+  case 2:
+    return copyStrided<uint16_t>(dst, src, count, dstStride, srcStride);
+  case 4:
+    return copyStrided<uint32_t>(dst, src, count, dstStride, srcStride);
+  case 8:
+    return copyStrided<uint64_t>(dst, src, count, dstStride, srcStride);
+  }
+
+  for (int64_t i = 0; i < count; ++i)
+    memcpy(dst + i * dstStride, src + i * srcStride,
+           static_cast<size_t>(elemSize));
+}
+
+/// Copy `desc` with the outermost dimension restricted to [begin, end).
+static void copyRange(const CopyDesc &desc, int64_t begin, int64_t end) {
+  auto numDims = desc.numDims;
+  auto dims = desc.dims;
+  assert(numDims > 0);
+  auto dst = desc.dst + begin * dims[0].dstStride;
+  auto src = desc.src + begin * dims[0].srcStride;
+  if (numDims == 1) {
+    CopyDim dim = dims[0];
+    dim.size = end - begin;
+    copyInner(dst, src, dim, desc.elemSize);
+    return;
+  }
+
+  // Iterate over the outer dimensions and copy innermost one as a whole.
+  auto numOuter = numDims - 1;
+  auto indices = static_cast<int64_t *>(
+      alloca(sizeof(int64_t) * static_cast<size_t>(numOuter)));
+  for (int64_t i = 0; i < numOuter; ++i)
+    indices[i] = 0;
+
+  indices[0] = begin;
+  auto &inner = dims[numOuter];
+  int64_t readIndex = 0, writeIndex = 0;
+  for (;;) {
+    copyInner(dst + writeIndex, src + readIndex, inner, desc.elemSize);
+    // Advance index and read position.
+    for (int64_t axis = numOuter - 1; axis >= 0; --axis) {
+      auto newIndex = ++indices[axis];
+      readIndex += dims[axis].srcStride;
+      writeIndex += dims[axis].dstStride;
+      auto size = (axis == 0 ? end : dims[axis].size);
+      if (size != newIndex)
+        break;
+
+      if (axis == 0)
+        return;
+
+      indices[axis] = 0;
+      readIndex -= dims[axis].size * dims[axis].srcStride;
+      writeIndex -= dims[axis].size * dims[axis].dstStride;
+    }
+  }
+}
+
 extern "C" NUMBA_MLIR_RUNTIME_EXPORT void
 memrefCopy(int64_t elemSize, UnrankedMemRefType<char> *srcArg,
            UnrankedMemRefType<char> *dstArg) {
@@ -44,47 +149,50 @@ memrefCopy(int64_t elemSize, UnrankedMemRefType<char> *srcArg,
   char *srcPtr = src.data + src.offset * elemSize;
   char *dstPtr = dst.data + dst.offset * elemSize;
 
-  if (rank == 0) {
+  // Drop unit dims and collapse dims, contiguous in both source and
+  // destination, so contiguous copies turn into a single memcpy and partially
+  // contiguous ones into a bulk copy per innermost dimension.
+  auto dims = static_cast<CopyDim *>(alloca(
+      sizeof(CopyDim) * static_cast<size_t>(std::max<int64_t>(rank, 1))));
+  int64_t numDims = 0;
+  int64_t totalSize = 1;
+  for (int64_t i = 0; i < rank; ++i) {
+    auto size = src.sizes[i];
+    if (size == 1)
+      continue;
+
+    totalSize *= size;
+    CopyDim dim{size, src.strides[i] * elemSize, dst.strides[i] * elemSize};
+    if (numDims > 0) {
+      auto &prev = dims[numDims - 1];
+      if (prev.srcStride == dim.srcStride * size &&
+          prev.dstStride == dim.dstStride * size) {
+        prev = CopyDim{prev.size * size, dim.srcStride, dim.dstStride};
+        continue;
+      }
+    }
+    dims[numDims++] = dim;
+  }
+
+  if (numDims == 0) {
     memcpy(dstPtr, srcPtr, static_cast<size_t>(elemSize));
     return;
   }
 
-  int64_t *indices = static_cast<int64_t *>(
-      alloca(sizeof(int64_t) * static_cast<size_t>(rank)));
-  int64_t *srcStrides = static_cast<int64_t *>(
-      alloca(sizeof(int64_t) * static_cast<size_t>(rank)));
-  int64_t *dstStrides = static_cast<int64_t *>(
-      alloca(sizeof(int64_t) * static_cast<size_t>(rank)));
-
-  // Initialize index and scale strides.
-  for (int rankp = 0; rankp < rank; ++rankp) {
-    indices[rankp] = 0;
-    srcStrides[rankp] = src.strides[rankp] * elemSize;
-    dstStrides[rankp] = dst.strides[rankp] * elemSize;
+  CopyDesc desc{dstPtr, srcPtr, dims, numDims, elemSize};
+  auto totalBytes = totalSize * elemSize;
+  auto outerSize = dims[0].size;
+  if (totalBytes < kParallelCopyThreshold || outerSize < 2) {
+    copyRange(desc, 0, outerSize);
+    return;
   }
 
-  int64_t readIndex = 0, writeIndex = 0;
-  for (;;) {
-    // Copy over the element, byte by byte.
-    memcpy(dstPtr + writeIndex, srcPtr + readIndex,
-           static_cast<size_t>(elemSize));
-    // Advance index and read position.
-    for (int64_t axis = rank - 1; axis >= 0; --axis) {
-      // Advance at current axis.
-      auto newIndex = ++indices[axis];
-      readIndex += srcStrides[axis];
-      writeIndex += dstStrides[axis];
-      // If this is a valid index, we have our next index, so continue copying.
-      if (src.sizes[axis] != newIndex)
-        break;
-      // We reached the end of this axis. If this is axis 0, we are done.
-      if (axis == 0)
-        return;
-      // Else, reset to 0 and undo the advancement of the linear index that
-      // this axis had. Then continue with the axis one outer.
-      indices[axis] = 0;
-      readIndex -= src.sizes[axis] * srcStrides[axis];
-      writeIndex -= dst.sizes[axis] * dstStrides[axis];
-    }
-  }
+  auto bytesPerOuter = totalBytes / outerSize;
+  auto grain = std::max<int64_t>(1, kParallelCopyChunk / bytesPerOuter);
+  nmrtParallelRange(
+      outerSize, grain,
+      [](int64_t begin, int64_t end, void *ctx) {
+        copyRange(*static_cast<const CopyDesc *>(ctx), begin, end);
+      },
+      &desc);
 }
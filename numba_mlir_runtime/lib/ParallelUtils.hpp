@@ -0,0 +1,15 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#pragma once
+
+#include <cstdint>
+
+using ParallelRangeFptr = void (*)(int64_t begin, int64_t end, void *ctx);
+
+/// Split [0, count) into chunks of at least `grain` iterations and run `func`
+/// on them using runtime thread pool. Executes `func(0, count, ctx)` serially
+/// if parallel runtime is not available or not initialized.
+void nmrtParallelRange(int64_t count, int64_t grain, ParallelRangeFptr func,
+                       void *ctx);
@@ -0,0 +1,216 @@
+// SPDX-FileCopyrightText: 2023 Intel Corporation
+//
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#include "numba-mlir-runtime_export.h"
+
+// Allocator for temporary buffers which never escape compiled code.
+//
+// Each block starts with NRT-compatible meminfo header, so generated code can
+// access data pointer the same way as for regular NRT allocations, but blocks
+// are released via `nmrtPoolFree` instead of `NRT_decref` and are returned to
+// the per-thread cache instead of system allocator.
+
+namespace {
+// Must match numba NRT MemInfo layout.
+struct MemInfo {
+  size_t refcnt;
+  void *dtor;
+  void *dtorInfo;
+  void *data;
+  size_t size;
+  void *externalAllocator;
+};
+
+struct BlockHeader {
+  MemInfo meminfo;
+  uint32_t sizeClass;
+};
+
+constexpr size_t kBlockAlign = 64;
+constexpr size_t kMinBlockShift = 6;               // 64 bytes
+constexpr size_t kNumSizeClasses = 15;             // up to 1MB blocks
+constexpr size_t kMaxCachedBytes = 4 << 20;        // per size class
+constexpr size_t kMaxCachedBlocks = 64;            // per size class
+constexpr size_t kMaxThreadCachedBytes = 16 << 20; // all size classes
+constexpr uint32_t kUncached = static_cast<uint32_t>(-1);
+
+static_assert(sizeof(BlockHeader) <= kBlockAlign, "Header is too big");
+
+static size_t alignUp(size_t val, size_t align) {
+  return (val + align - 1) & ~(align - 1);
+}
+
+static void *alignedAlloc(size_t size, size_t align) {
+#ifdef _WIN32
+  return _aligned_malloc(size, align);
+#else
+  void *ret = nullptr;
+  if (posix_memalign(&ret, align, size) != 0)
+    return nullptr;
+  return ret;
+#endif
+}
+
+static void alignedFree(void *ptr) {
+#ifdef _WIN32
+  _aligned_free(ptr);
+#else
+  free(ptr);
+#endif
+}
+
+static size_t getBlockSize(uint32_t sizeClass) {
+  return size_t(1) << (sizeClass + kMinBlockShift);
+}
+
+static uint32_t getSizeClass(size_t blockSize) {
+  uint32_t sizeClass = 0;
+  while (sizeClass < kNumSizeClasses && getBlockSize(sizeClass) < blockSize)
+    ++sizeClass;
+
+  return sizeClass < kNumSizeClasses ? sizeClass : kUncached;
+}
+
+static size_t getMaxCachedBlocks(uint32_t sizeClass) {
+  auto count = kMaxCachedBytes / getBlockSize(sizeClass);
+  return count < kMaxCachedBlocks ? count : kMaxCachedBlocks;
+}
+
+struct ThreadCache {
+  // Free blocks are linked through meminfo data pointer.
+  struct FreeList {
+    BlockHeader *head = nullptr;
+    size_t count = 0;
+  };
+
+  ThreadCache() { alive = true; }
+
+  ~ThreadCache() {
+    alive = false;
+    for (auto &list : lists) {
+      auto block = list.head;
+      while (block) {
+        auto next = static_cast<BlockHeader *>(block->meminfo.data);
+        alignedFree(block);
+        block = next;
+      }
+    }
+  }
+
+  BlockHeader *pop(uint32_t sizeClass) {
+    auto &list = lists[sizeClass];
+    auto block = list.head;
+    if (!block)
+      return nullptr;
+
+    list.head = static_cast<BlockHeader *>(block->meminfo.data);
+    --list.count;
+    cachedBytes -= getBlockSize(sizeClass);
+    return block;
+  }
+
+  bool push(BlockHeader *block) {
+    auto sizeClass = block->sizeClass;
+    auto &list = lists[sizeClass];
+    auto blockSize = getBlockSize(sizeClass);
+    if (list.count >= getMaxCachedBlocks(sizeClass) ||
+        cachedBytes + blockSize > kMaxThreadCachedBytes)
+      return false;
+
+    block->meminfo.data = list.head;
+    list.head = block;
+    ++list.count;
+    cachedBytes += blockSize;
+    return true;
+  }
+
+  size_t getCachedBytes() const { return cachedBytes; }
+
+  // Blocks can be freed during thread exit after cache was destroyed.
+  static thread_local bool alive;
+
+private:
+  std::array<FreeList, kNumSizeClasses> lists;
+  size_t cachedBytes = 0;
+};
+
+thread_local bool ThreadCache::alive = false;
+
+static ThreadCache *getThreadCache() {
+  static thread_local ThreadCache cache;
+  return ThreadCache::alive ? &cache : nullptr;
+}
+} // namespace
+
+extern "C" NUMBA_MLIR_RUNTIME_EXPORT void *nmrtPoolAlloc(size_t size,
+                                                         uint32_t align) {
+  if (align == 0)
+    align = 1;
+
+  // Common case: block alignment is enough for data, data immediately follows
+  // header.
+  bool isPow2 = (align & (align - 1)) == 0;
+  auto sizeClass = (isPow2 && align <= kBlockAlign)
+                       ? getSizeClass(kBlockAlign + size)
+                       : kUncached;
+
+  BlockHeader *block = nullptr;
+  if (sizeClass != kUncached) {
+    if (auto cache = getThreadCache())
+      block = cache->pop(sizeClass);
+
+    if (!block)
+      block = static_cast<BlockHeader *>(
+          alignedAlloc(getBlockSize(sizeClass), kBlockAlign));
+  } else {
+    // Large or unusually aligned blocks go directly to system allocator,
+    // reserve enough space to align data for arbitrary alignment value.
+    auto blockSize = alignUp(sizeof(BlockHeader) + align + size, kBlockAlign);
+    block = static_cast<BlockHeader *>(alignedAlloc(blockSize, kBlockAlign));
+  }
+
+  if (!block)
+    return nullptr;
+
+  auto dataStart = reinterpret_cast<uintptr_t>(block) + sizeof(BlockHeader);
+  auto data = (dataStart + align - 1) / align * align;
+
+  block->sizeClass = sizeClass;
+  auto &meminfo = block->meminfo;
+  meminfo.refcnt = 1;
+  meminfo.dtor = nullptr;
+  meminfo.dtorInfo = nullptr;
+  meminfo.data = reinterpret_cast<void *>(data);
+  meminfo.size = size;
+  meminfo.externalAllocator = nullptr;
+  return &meminfo;
+}
+
+extern "C" NUMBA_MLIR_RUNTIME_EXPORT void nmrtPoolFree(void *meminfo) {
+  if (!meminfo)
+    return;
+
+  auto block = static_cast<BlockHeader *>(meminfo);
+  if (block->sizeClass != kUncached)
+    if (auto cache = getThreadCache())
+      if (cache->push(block))
+        return;
+
+  alignedFree(block);
+}
+
+/// Returns size of the blocks, retained by the calling thread cache.
+extern "C" NUMBA_MLIR_RUNTIME_EXPORT size_t nmrtPoolGetCachedSize() {
+  auto cache = getThreadCache();
+  return cache ? cache->getCachedBytes() : 0;
+}
@@ -2,12 +2,20 @@
 //
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include "ParallelUtils.hpp"
+
 #ifdef NUMBA_MLIR_ENABLE_TBB_SUPPORT
 
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 #define TBB_PREVIEW_WAITING_FOR_WORKERS 1
 #define TBB_PREVIEW_BLOCKED_RANGE_ND 1
@@ -15,6 +23,7 @@
 #include <tbb/blocked_rangeNd.h>
 #include <tbb/global_control.h>
 #include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
 #include <tbb/task_arena.h>
 
 #include "numba-mlir-runtime_export.h"
@@ -43,12 +52,48 @@ static void tbbTshRelease(tbb::task_scheduler_handle &tsh) {
 #endif
 }
 
+using index_t = std::make_signed_t<std::size_t>;
+
+struct InputRange {
+  index_t lower;
+  index_t upper;
+  index_t step;
+};
+
+struct Range {
+  index_t lower;
+  index_t upper;
+};
+
+using ParallelForFptr = void (*)(const Range *, size_t, void *);
+
+// Must be kept in sync with numba::util::ScheduleKind.
+enum class ScheduleKind : int32_t {
+  Auto = 0,
+  Static = 1,
+  Dynamic = 2,
+  Affinity = 3,
+};
+
+/// Affinity partitioner must outlive single loop invocation to be useful,
+/// keep one per loop body. Partitioner is not thread-safe, so concurrent
+/// invocations of the same loop fall back to the auto partitioner.
+struct AffinityState {
+  tbb::affinity_partitioner partitioner;
+  std::atomic<bool> busy{false};
+};
+
 struct TBBContext {
   TBBContext(int numThreads)
       : numThreads(numThreads), schedulerHandle(tbbTshAttach()),
         arena(numThreads) {}
 
   ~TBBContext() {
+    {
+      std::lock_guard<std::mutex> lock(arenasMutex);
+      for (auto &localArena : localArenas)
+        localArena->terminate();
+    }
     arena.terminate();
     if (!tbb::finalize(schedulerHandle, std::nothrow)) {
       if (DEBUG) {
@@ -59,9 +104,42 @@ struct TBBContext {
     }
   }
 
+  AffinityState &getAffinityState(ParallelForFptr func) {
+    std::lock_guard<std::mutex> lock(affinityMutex);
+    auto &state = affinityStates[func];
+    if (!state)
+      state = std::make_unique<AffinityState>();
+
+    return *state;
+  }
+
+  std::shared_ptr<tbb::task_arena> createArena(int size) {
+    auto newArena = std::make_shared<tbb::task_arena>(size);
+    std::lock_guard<std::mutex> lock(arenasMutex);
+    localArenas.emplace_back(newArena);
+    return newArena;
+  }
+
+  void releaseArena(const std::shared_ptr<tbb::task_arena> &localArena) {
+    std::lock_guard<std::mutex> lock(arenasMutex);
+    auto it = std::find(localArenas.begin(), localArenas.end(), localArena);
+    if (it != localArenas.end())
+      localArenas.erase(it);
+  }
+
   int numThreads;
   tbb::task_scheduler_handle schedulerHandle;
+
+  // Concurrency is limited by the arenas themselves, global_control is not
+  // used as it would also affect other TBB users in the process.
   tbb::task_arena arena;
+
+  std::mutex arenasMutex;
+  std::vector<std::shared_ptr<tbb::task_arena>> localArenas;
+
+  std::mutex affinityMutex;
+  std::unordered_map<ParallelForFptr, std::unique_ptr<AffinityState>>
+      affinityStates;
 };
 
 static std::unique_ptr<TBBContext> globalContext;
@@ -75,158 +153,349 @@ static TBBContext &getContext() {
   return *globalContext;
 }
 
-using index_t = std::make_signed_t<std::size_t>;
+/// Per calling thread arena, used if thread requested different number of
+/// threads than global default.
+struct LocalArena {
+  ~LocalArena() { reset(); }
 
-struct InputRange {
-  index_t lower;
-  index_t upper;
-  index_t step;
+  void reset() {
+    if (arena && globalContext)
+      globalContext->releaseArena(arena);
+
+    arena.reset();
+  }
+
+  int numThreads = 0;
+  std::shared_ptr<tbb::task_arena> arena;
 };
 
-struct Range {
-  index_t lower;
-  index_t upper;
+static thread_local LocalArena localArena;
+
+static int getNumThreads(TBBContext &context) {
+  auto num = localArena.numThreads;
+  return num > 0 ? num : context.numThreads;
+}
+
+static tbb::task_arena &getArena(TBBContext &context) {
+  auto num = localArena.numThreads;
+  if (num <= 0 || num == context.numThreads)
+    return context.arena;
+
+  if (!localArena.arena)
+    localArena.arena = context.createArena(num);
+
+  return *localArena.arena;
+}
+
+/// Set while the current thread executes parallel region inside one of our
+/// arenas. TBB thread index can't be used to detect nested regions, as it is
+/// also valid inside arenas created by other TBB users in the process.
+static thread_local bool insideArena = false;
+
+struct InsideArenaScope {
+  InsideArenaScope() : prev(insideArena) { insideArena = true; }
+  ~InsideArenaScope() { insideArena = prev; }
+
+private:
+  bool prev;
 };
 
-struct Dim {
-  Range val;
-  Dim *prev;
+/// Runs `func` inside the current thread arena, or directly if called from
+/// nested parallel region. `func` receives number of threads of the arena.
+template <typename F> static void runInArena(TBBContext &context, F &&func) {
+  if (insideArena) {
+    // Nested parallel region, run inside the current arena to stay within
+    // its concurrency limit.
+    func(static_cast<size_t>(tbb::this_task_arena::max_concurrency()));
+    return;
+  }
+
+  auto numThreads = static_cast<size_t>(getNumThreads(context));
+  getArena(context).execute([&] {
+    InsideArenaScope scope;
+    func(numThreads);
+  });
+}
+
+struct Schedule {
+  ScheduleKind kind;
+  index_t grain;
+  tbb::affinity_partitioner *affinity;
 };
 
-using ParallelForFptr = void (*)(const Range *, size_t, void *);
+template <typename RangeT, typename Body>
+static void dispatchParallelFor(const RangeT &range, const Body &body,
+                                const Schedule &schedule) {
+  switch (schedule.kind) {
+  case ScheduleKind::Static:
+    tbb::parallel_for(range, body, tbb::static_partitioner());
+    return;
+  case ScheduleKind::Dynamic:
+    tbb::parallel_for(range, body, tbb::simple_partitioner());
+    return;
+  case ScheduleKind::Affinity:
+    if (schedule.affinity) {
+      tbb::parallel_for(range, body, *schedule.affinity);
+      return;
+    }
+    break;
+  case ScheduleKind::Auto:
+    break;
+  }
+  tbb::parallel_for(range, body, tbb::auto_partitioner());
+}
+
+static index_t getCount(const InputRange &input) {
+  return (input.upper - input.lower + input.step - 1) / input.step;
+}
+
+static index_t getGrain(const Schedule &schedule, index_t count,
+                        size_t numThreads, index_t defaultGrain) {
+  // Simple partitioner splits range down to the grain size, use it as chunk
+  // size directly.
+  if (schedule.kind == ScheduleKind::Dynamic)
+    return std::max(index_t(1), schedule.grain);
+
+  index_t maxGrain = (schedule.grain > 0 ? schedule.grain : defaultGrain);
+  return std::max(index_t(1),
+                  std::min(count / index_t(numThreads) / 2, maxGrain));
+}
+
+/// Per-chunk storage for the ranges passed to the loop body.
+struct RangesStorage {
+  RangesStorage(size_t numLoops) {
+    if (numLoops > staticRanges.size())
+      dynRanges.reset(new Range[numLoops]);
+  }
 
-static void parallelForNested(const InputRange *inputRanges, size_t depth,
-                              size_t numThreads, size_t numLoops, Dim *prevDim,
-                              ParallelForFptr func, void *ctx);
+  Range *get() { return dynRanges ? dynRanges.get() : staticRanges.data(); }
 
-template <unsigned N, bool Term, size_t... Is>
-static void runParallelFor(const InputRange *inputRanges, size_t depth,
-                           size_t numThreads, size_t numLoops, Dim *prevDim,
-                           ParallelForFptr func, void *ctx) {
-  std::array<InputRange, N> tempRanges;
-  std::copy_n(inputRanges + depth, N, tempRanges.begin());
+private:
+  std::array<Range, 8> staticRanges;
+  std::unique_ptr<Range[]> dynRanges;
+};
 
+static void runFunc(Range *ranges, size_t numLoops, ParallelForFptr func,
+                    void *ctx) {
+  auto threadIndex =
+      static_cast<index_t>(tbb::this_task_arena::current_thread_index());
+  assert(threadIndex >= 0);
   if (DEBUG) {
     std::lock_guard<std::mutex> lock(getDebugMutex());
-    fprintf(stderr, "parallel_for_nested: depth=%d", static_cast<int>(depth));
-    for (unsigned i = 0; i < N; ++i) {
-      auto &input = tempRanges[i];
+    fprintf(stderr, "parallel_for func: thread_index=%d",
+            static_cast<int>(threadIndex));
+    for (size_t i = 0; i < numLoops; ++i) {
+      auto &input = ranges[i];
       auto lowerBound = input.lower;
       auto upperBound = input.upper;
-      auto step = input.step;
-      fprintf(stderr, " (lower_bound=%d, upper_bound=%d, step=%d)",
-              static_cast<int>(lowerBound), static_cast<int>(upperBound),
-              static_cast<int>(step));
+      fprintf(stderr, " (lower_bound=%d, upper_bound=%d)",
+              static_cast<int>(lowerBound), static_cast<int>(upperBound));
     }
     fprintf(stderr, "\n");
   }
+  InsideArenaScope scope;
+  func(ranges, threadIndex, ctx);
+}
+
+template <unsigned N, size_t... Is>
+static void runParallelFor(const InputRange *inputRanges, size_t numThreads,
+                           const Schedule &schedule, ParallelForFptr func,
+                           void *ctx) {
+  // Grain is a number of iterations of the whole loop nest, split it across
+  // dimensions starting from the innermost one, so chunk covers contiguous
+  // inner rows instead of grain^N iterations.
+  std::array<index_t, N> counts;
+  index_t total = 1;
+  for (unsigned i = 0; i < N; ++i) {
+    counts[i] = getCount(inputRanges[i]);
+    total *= counts[i];
+  }
+
+  std::array<index_t, N> grains;
+  auto grain = getGrain(schedule, total, numThreads, 64);
+  for (unsigned i = N; i-- > 0;) {
+    grains[i] = std::max(index_t(1), std::min(counts[i], grain));
+    grain = (grain + grains[i] - 1) / grains[i];
+  }
 
   auto getRange = [&](size_t i) {
-    auto &input = tempRanges[i];
-    auto lowerBound = input.lower;
-    auto upperBound = input.upper;
-    auto step = input.step;
-    index_t count = (upperBound - lowerBound + step - 1) / step;
-    index_t grain = std::max(
-        index_t(1), std::min(count / index_t(numThreads) / 2, index_t(64)));
-    return tbb::blocked_range<index_t>(0, count, grain);
+    return tbb::blocked_range<index_t>(0, counts[i], grains[i]);
   };
 
   tbb::blocked_rangeNd<index_t, N> range(getRange(Is)...);
 
-  auto runFunc = [&](Dim *current) {
-    auto threadIndex =
-        static_cast<index_t>(tbb::this_task_arena::current_thread_index());
-    assert(threadIndex >= 0);
-    std::array<Range, 8> staticRanges;
-    std::unique_ptr<Range[]> dynRanges;
-    auto *rangePtr = [&]() -> Range * {
-      if (numLoops <= staticRanges.size())
-        return staticRanges.data();
+  auto loopBody = [&](const tbb::blocked_rangeNd<index_t, N> &r) {
+    std::array<Range, N> ranges;
+    for (unsigned i = 0; i < N; ++i) {
+      auto &input = inputRanges[i];
+      auto rDim = r.dim(i);
+      ranges[i] = Range{input.lower + rDim.begin() * input.step,
+                        input.lower + rDim.end() * input.step};
+    }
+    runFunc(ranges.data(), N, func, ctx);
+  };
 
-      dynRanges.reset(new Range[numLoops]);
-      return dynRanges.get();
-    }();
+  dispatchParallelFor(range, loopBody, schedule);
+}
 
-    for (size_t i = 0; i < numLoops; ++i) {
-      assert(current);
-      rangePtr[numLoops - i - 1] = current->val;
-      current = current->prev;
-    }
+/// Deep loop nests are linearized into a single iteration space, which is
+/// split by single parallel_for. Each linear chunk is then decomposed into
+/// the minimal number of rectangular sub-ranges for the loop body.
+static void runCollapsedParallelFor(const InputRange *inputRanges,
+                                    size_t numLoops, size_t numThreads,
+                                    const Schedule &schedule,
+                                    ParallelForFptr func, void *ctx) {
+  // innerSizes[i] is number of iterations in dimensions i+1..numLoops-1.
+  std::array<index_t, 8> staticSizes;
+  std::unique_ptr<index_t[]> dynSizes;
+  if (numLoops > staticSizes.size())
+    dynSizes.reset(new index_t[numLoops]);
+
+  auto innerSizes = dynSizes ? dynSizes.get() : staticSizes.data();
+  index_t total = 1;
+  for (size_t i = numLoops; i-- > 0;) {
+    innerSizes[i] = total;
+    total *= getCount(inputRanges[i]);
+  }
 
-    if (DEBUG) {
-      std::lock_guard<std::mutex> lock(getDebugMutex());
-      fprintf(stderr, "parallel_for func: thread_index=%d",
-              static_cast<int>(threadIndex));
+  auto innermostCount = getCount(inputRanges[numLoops - 1]);
+  auto grain = getGrain(schedule, total, numThreads, 64 * innermostCount);
+
+  auto loopBody = [&](const tbb::blocked_range<index_t> &r) {
+    RangesStorage storage(numLoops);
+    auto ranges = storage.get();
+    auto pos = r.begin();
+    auto end = r.end();
+    while (pos < end) {
+      // Find the outermost dimension `dim` such that all inner dimensions
+      // start from zero and at least one full inner block fits into the
+      // remaining chunk.
+      auto rem = pos;
+      size_t dim = numLoops - 1;
       for (size_t i = 0; i < numLoops; ++i) {
-        auto &input = rangePtr[i];
-        auto lowerBound = input.lower;
-        auto upperBound = input.upper;
-        fprintf(stderr, " (lower_bound=%d, upper_bound=%d)",
-                static_cast<int>(lowerBound), static_cast<int>(upperBound));
+        rem = rem % innerSizes[i];
+        if (rem == 0 && innerSizes[i] <= end - pos) {
+          dim = i;
+          break;
+        }
       }
-      fprintf(stderr, "\n");
-    }
-    func(rangePtr, threadIndex, ctx);
-  };
 
-  auto loopBody = [&](const tbb::blocked_rangeNd<index_t, N> &r) {
-    std::array<Dim, N> dims;
-    auto prev = prevDim;
-    for (unsigned i = 0; i < N; ++i) {
-      auto &input = tempRanges[i];
-      auto lower_bound = input.lower;
-      auto step = input.step;
-      auto rDim = r.dim(i);
-      auto begin = lower_bound + rDim.begin() * step;
-      auto end = lower_bound + rDim.end() * step;
-      dims[i] = Dim{Range{begin, end}, prev};
-      prev = &dims[i];
-    }
-
-    if (Term) {
-      runFunc(prev);
-    } else {
-      auto next = depth + N;
-      parallelForNested(inputRanges, next, numThreads, numLoops, prev, func,
-                        ctx);
+      rem = pos;
+      for (size_t i = 0; i < numLoops; ++i) {
+        auto &input = inputRanges[i];
+        if (i > dim) {
+          ranges[i] = Range{input.lower, input.upper};
+          continue;
+        }
+
+        auto idx = rem / innerSizes[i];
+        rem = rem % innerSizes[i];
+        auto len = index_t(1);
+        if (i == dim)
+          len = std::min(getCount(input) - idx, (end - pos) / innerSizes[i]);
+
+        ranges[i] = Range{input.lower + idx * input.step,
+                          input.lower + (idx + len) * input.step};
+        if (i == dim)
+          pos += len * innerSizes[i];
+      }
+      runFunc(ranges, numLoops, func, ctx);
     }
   };
 
-  tbb::parallel_for(range, loopBody, tbb::auto_partitioner());
+  dispatchParallelFor(tbb::blocked_range<index_t>(0, total, grain), loopBody,
+                      schedule);
 }
 
-static void parallelForNested(const InputRange *inputRanges, size_t depth,
-                              size_t numThreads, size_t numLoops, Dim *prevDim,
-                              ParallelForFptr func, void *ctx) {
-  assert(numLoops > depth);
-  auto rem = numLoops - depth;
-  if (rem == 1) {
-    runParallelFor<1, true, 0>(inputRanges, depth, numThreads, numLoops,
-                               prevDim, func, ctx);
-  } else if (rem == 2) {
-    runParallelFor<2, true, 0, 1>(inputRanges, depth, numThreads, numLoops,
-                                  prevDim, func, ctx);
-  } else if (rem == 3) {
-    runParallelFor<3, true, 0, 1, 2>(inputRanges, depth, numThreads, numLoops,
-                                     prevDim, func, ctx);
+static void parallelFor(const InputRange *inputRanges, size_t numThreads,
+                        size_t numLoops, const Schedule &schedule,
+                        ParallelForFptr func, void *ctx) {
+  assert(numLoops > 0);
+  if (numLoops == 1) {
+    runParallelFor<1, 0>(inputRanges, numThreads, schedule, func, ctx);
+  } else if (numLoops == 2) {
+    runParallelFor<2, 0, 1>(inputRanges, numThreads, schedule, func, ctx);
+  } else if (numLoops == 3) {
+    runParallelFor<3, 0, 1, 2>(inputRanges, numThreads, schedule, func, ctx);
   } else {
-    runParallelFor<3, false, 0, 1, 2>(inputRanges, depth, numThreads, numLoops,
-                                      prevDim, func, ctx);
+    runCollapsedParallelFor(inputRanges, numLoops, numThreads, schedule, func,
+                            ctx);
   }
 }
+
+using ParallelScanFptr = void (*)(int64_t begin, int64_t end, const void *carry,
+                                  void *total, void *ctx);
+using ScanCombineFptr = void (*)(void *acc, const void *val, void *ctx);
+
+// Smaller blocks don't amortize the additional pass over the data.
+constexpr int64_t kMinScanBlock = 4096;
+
+/// Two-pass blocked scan. Range is split into one block per thread, first
+/// pass computes the total of each block (first block is scanned directly),
+/// then block carries are combined serially and the second pass scans the
+/// remaining blocks starting from their carries.
+static void parallelScan(int64_t count, int64_t elemSize, size_t numThreads,
+                         ParallelScanFptr reduceFunc, ParallelScanFptr scanFunc,
+                         ScanCombineFptr combineFunc, void *ctx) {
+  auto numBlocks = std::min(count / kMinScanBlock,
+                            static_cast<int64_t>(numThreads));
+  if (numBlocks <= 1) {
+    scanFunc(0, count, nullptr, nullptr, ctx);
+    return;
+  }
+
+  auto blockSize = (count + numBlocks - 1) / numBlocks;
+  numBlocks = (count + blockSize - 1) / blockSize;
+  auto size = static_cast<size_t>(elemSize);
+  std::unique_ptr<char[]> totals(new char[numBlocks * size]);
+  std::unique_ptr<char[]> carries(new char[numBlocks * size]);
+  auto getTotal = [&](int64_t block) { return totals.get() + block * size; };
+  auto getCarry = [&](int64_t block) { return carries.get() + block * size; };
+
+  auto runBlocks = [&](int64_t firstBlock, auto &&blockFunc) {
+    auto body = [&](const tbb::blocked_range<int64_t> &r) {
+      InsideArenaScope scope;
+      for (auto block = r.begin(); block < r.end(); ++block) {
+        auto begin = block * blockSize;
+        auto end = std::min(begin + blockSize, count);
+        blockFunc(block, begin, end);
+      }
+    };
+    tbb::parallel_for(tbb::blocked_range<int64_t>(firstBlock, numBlocks, 1),
+                      body, tbb::static_partitioner());
+  };
+
+  runBlocks(0, [&](int64_t block, int64_t begin, int64_t end) {
+    if (block == 0) {
+      scanFunc(begin, end, nullptr, getTotal(block), ctx);
+    } else {
+      reduceFunc(begin, end, nullptr, getTotal(block), ctx);
+    }
+  });
+
+  std::memcpy(getCarry(1), getTotal(0), size);
+  for (int64_t block = 2; block < numBlocks; ++block) {
+    std::memcpy(getCarry(block), getCarry(block - 1), size);
+    combineFunc(getCarry(block), getTotal(block - 1), ctx);
+  }
+
+  runBlocks(1, [&](int64_t block, int64_t begin, int64_t end) {
+    scanFunc(begin, end, getCarry(block), nullptr, ctx);
+  });
+}
 } // namespace
 
 extern "C" {
-NUMBA_MLIR_RUNTIME_EXPORT void nmrtParallelFor(const InputRange *inputRanges,
-                                               size_t numLoops,
-                                               ParallelForFptr func,
-                                               void *ctx) {
+NUMBA_MLIR_RUNTIME_EXPORT void
+nmrtParallelFor(const InputRange *inputRanges, size_t numLoops,
+                ParallelForFptr func, void *ctx, int32_t scheduleKind,
+                size_t grainSize) {
   auto &context = getContext();
-  auto numThreads = static_cast<size_t>(context.numThreads);
   if (DEBUG) {
     std::lock_guard<std::mutex> lock(getDebugMutex());
-    fprintf(stderr, "parallel_for num_loops=%d: ", static_cast<int>(numLoops));
+    fprintf(stderr, "parallel_for num_loops=%d schedule=%d grain=%d: ",
+            static_cast<int>(numLoops), static_cast<int>(scheduleKind),
+            static_cast<int>(grainSize));
     for (size_t i = 0; i < numLoops; ++i) {
       auto r = inputRanges[i];
       fprintf(stderr, "(%d, %d, %d) ", static_cast<int>(r.lower),
@@ -241,8 +510,51 @@ NUMBA_MLIR_RUNTIME_EXPORT void nmrtParallelFor(const InputRange *inputRanges,
       return;
   }
 
-  context.arena.execute([&] {
-    parallelForNested(inputRanges, 0, numThreads, numLoops, nullptr, func, ctx);
+  Schedule schedule{static_cast<ScheduleKind>(scheduleKind),
+                    static_cast<index_t>(grainSize), nullptr};
+
+  AffinityState *affinity = nullptr;
+  if (schedule.kind == ScheduleKind::Affinity) {
+    auto &state = context.getAffinityState(func);
+    if (!state.busy.exchange(true, std::memory_order_acquire)) {
+      affinity = &state;
+      schedule.affinity = &state.partitioner;
+    }
+  }
+
+  runInArena(context, [&](size_t numThreads) {
+    parallelFor(inputRanges, numThreads, numLoops, schedule, func, ctx);
+  });
+
+  if (affinity)
+    affinity->busy.store(false, std::memory_order_release);
+}
+
+/// Computes inclusive scan over [0, count) using runtime thread pool.
+///
+/// `reduceFunc(begin, end, nullptr, total, ctx)` must write the combined value
+/// of [begin, end) range elements into `total`.
+/// `scanFunc(begin, end, carry, total, ctx)` must scan [begin, end) range,
+/// combining each element with the `carry` first if it is not null, and write
+/// the last scanned value into `total` if it is not null.
+/// `combineFunc(acc, val, ctx)` must compute `acc = acc op val`.
+///
+/// Intermediate values are opaque `elemSize` bytes blobs.
+NUMBA_MLIR_RUNTIME_EXPORT void
+nmrtParallelScan(int64_t count, int64_t elemSize, ParallelScanFptr reduceFunc,
+                 ParallelScanFptr scanFunc, ScanCombineFptr combineFunc,
+                 void *ctx) {
+  if (DEBUG) {
+    std::lock_guard<std::mutex> lock(getDebugMutex());
+    fprintf(stderr, "parallel_scan count=%d elem_size=%d\n",
+            static_cast<int>(count), static_cast<int>(elemSize));
+  }
+  if (count <= 0)
+    return;
+
+  runInArena(getContext(), [&](size_t numThreads) {
+    parallelScan(count, elemSize, numThreads, reduceFunc, scanFunc,
+                 combineFunc, ctx);
   });
 }
 
@@ -250,10 +562,32 @@ NUMBA_MLIR_RUNTIME_EXPORT void nmrtParallelInit(int numThreads) {
   if (DEBUG)
     fprintf(stderr, "nmrt_parallel_init %d\n", numThreads);
 
-  if (!globalContext)
+  if (!globalContext) {
     globalContext = std::make_unique<TBBContext>(numThreads);
+  } else if (DEBUG && globalContext->numThreads != numThreads) {
+    // Compiled code relies on thread indices being less than initial threads
+    // count, keep the original context.
+    fprintf(stderr, "nmrt: tbb runtime is already initialized with %d\n",
+            globalContext->numThreads);
+  }
+}
 
-  assert(globalContext->numThreads == numThreads);
+NUMBA_MLIR_RUNTIME_EXPORT void nmrtParallelSetNumThreads(int numThreads) {
+  auto &context = getContext();
+  // Thread indices must be less than max_concurrency the code was compiled
+  // with, so threads count can only be reduced.
+  if (numThreads <= 0 || numThreads > context.numThreads)
+    numThreads = 0;
+
+  if (localArena.numThreads == numThreads)
+    return;
+
+  localArena.reset();
+  localArena.numThreads = numThreads;
+}
+
+NUMBA_MLIR_RUNTIME_EXPORT int nmrtParallelGetNumThreads() {
+  return getNumThreads(getContext());
 }
 
 NUMBA_MLIR_RUNTIME_EXPORT void nmrtParallelFinalize() {
@@ -263,4 +597,26 @@ NUMBA_MLIR_RUNTIME_EXPORT void nmrtParallelFinalize() {
   globalContext.reset();
 }
 }
+
+void nmrtParallelRange(int64_t count, int64_t grain, ParallelRangeFptr func,
+                       void *ctx) {
+  if (!globalContext || count <= grain) {
+    func(0, count, ctx);
+    return;
+  }
+
+  auto body = [&](const tbb::blocked_range<int64_t> &r) {
+    InsideArenaScope scope;
+    func(r.begin(), r.end(), ctx);
+  };
+  tbb::blocked_range<int64_t> range(0, count, std::max<int64_t>(grain, 1));
+  runInArena(*globalContext, [&](size_t /*numThreads*/) {
+    tbb::parallel_for(range, body, tbb::auto_partitioner());
+  });
+}
+#else // NUMBA_MLIR_ENABLE_TBB_SUPPORT
+void nmrtParallelRange(int64_t count, int64_t /*grain*/, ParallelRangeFptr func,
+                       void *ctx) {
+  func(0, count, ctx);
+}
 #endif // NUMBA_MLIR_ENABLE_TBB_SUPPORT